@@ -0,0 +1,161 @@
+#pragma once
+
+#include "form.hpp"
+#include "patch.hpp"
+
+#include <atomic>
+#include <memory_resource>
+#include <optional>
+
+namespace CanForm
+{
+class JsonWriter;
+
+struct ResourceCounters
+{
+    // Bytes allocated and not yet deallocated
+    size_t bytes;
+    // Most bytes allocated at once since the counters were reset
+    size_t peak;
+    size_t allocations;
+    size_t deallocations;
+};
+
+// Memory resource that counts what passes through it to its upstream resource. The counters are atomic, so it can be
+// the default resource while other threads allocate (as CountingScope makes it); it is as thread safe as its upstream.
+class CountingResource : public std::pmr::memory_resource
+{
+  private:
+    std::pmr::memory_resource *upstream;
+    std::atomic<size_t> bytes;
+    std::atomic<size_t> peak;
+    std::atomic<size_t> allocations;
+    std::atomic<size_t> deallocations;
+
+    void *do_allocate(size_t, size_t) override;
+    void do_deallocate(void *, size_t, size_t) override;
+    bool do_is_equal(const std::pmr::memory_resource &) const noexcept override;
+
+  public:
+    explicit CountingResource(std::pmr::memory_resource *upstream = std::pmr::get_default_resource()) noexcept;
+    CountingResource(const CountingResource &) = delete;
+
+    CountingResource &operator=(const CountingResource &) = delete;
+
+    // Each counter is read on its own, so the set may mix moments while other threads allocate
+    ResourceCounters getCounters() const noexcept
+    {
+        return ResourceCounters{getBytes(), getPeak(), allocations.load(std::memory_order_relaxed),
+                                deallocations.load(std::memory_order_relaxed)};
+    }
+    size_t getBytes() const noexcept
+    {
+        return bytes.load(std::memory_order_relaxed);
+    }
+    size_t getPeak() const noexcept
+    {
+        return peak.load(std::memory_order_relaxed);
+    }
+    std::pmr::memory_resource *getUpstream() const noexcept
+    {
+        return upstream;
+    }
+
+    // The peak starts again from the bytes allocated now and the allocation counts from zero
+    void reset() noexcept;
+
+    Allocator allocator() noexcept
+    {
+        return Allocator(this);
+    }
+};
+
+// Counts everything allocated with default allocators while it lives, so forms and containers built without an
+// explicit allocator are counted without changing their call sites. The previous default resource is the upstream and
+// is restored by the destructor. Memory allocated in the scope may be freed after it.
+class CountingScope
+{
+  private:
+    CountingResource resource;
+    std::pmr::memory_resource *previous;
+
+  public:
+    CountingScope() noexcept;
+    CountingScope(const CountingScope &) = delete;
+    ~CountingScope();
+
+    CountingScope &operator=(const CountingScope &) = delete;
+
+    CountingResource &getResource() noexcept
+    {
+        return resource;
+    }
+};
+
+// Bytes a form holds outside of its own Form object, by what they store. The sizes follow the layout of the
+// containers, so they are close estimates of what a resource hands out, not counts.
+struct MemoryUsage
+{
+    // Key slots of the field maps, and the keys of StringMap and of the maps in ComplexString with their text. The text
+    // of field names lives in the atom pool.
+    size_t keys = 0;
+    // Heap buffers of strings (short strings are stored inline and cost nothing)
+    size_t strings = 0;
+    // Entries and nodes of the field maps with their hash indices and shared handles, apart from keys and ranges
+    size_t mapNodes = 0;
+    // Nodes of StringSet and the options of StringSelection
+    size_t setNodes = 0;
+    // Ranges of the RangedValue fields
+    size_t ranges = 0;
+
+    constexpr size_t total() const noexcept
+    {
+        return keys + strings + mapNodes + setNodes + ranges;
+    }
+
+    MemoryUsage &operator+=(const MemoryUsage &u) noexcept
+    {
+        keys += u.keys;
+        strings += u.strings;
+        mapNodes += u.mapNodes;
+        setNodes += u.setNodes;
+        ranges += u.ranges;
+        return *this;
+    }
+};
+
+struct FormMemoryStats
+{
+    using allocator_type = Allocator;
+
+    struct Subtree
+    {
+        FormPath path;
+        // Everything below the form, including it
+        MemoryUsage usage;
+        size_t forms;
+    };
+
+    MemoryUsage total;
+    size_t forms = 0;
+    // Maps shared with forms that were already counted. They are counted once, below the first form that holds them.
+    size_t sharedMaps = 0;
+    // Every form up to the depth of the report in depth first order, starting with the root
+    std::pmr::vector<Subtree> subtrees;
+    // Counters of the memory resource of the form if it is a CountingResource
+    std::optional<ResourceCounters> resource;
+
+    explicit FormMemoryStats(const allocator_type &a = allocator_type()) : subtrees(a)
+    {
+    }
+};
+
+// Walks a form and adds up the memory below it by category, with one subtree for every form at most depth levels
+// below the root. Lazy alternatives that are not built and the options of providers cost nothing.
+extern FormMemoryStats report(const Form &, size_t depth = 1, const Allocator & = Allocator());
+
+// {"total": {"estimated": true, "keys": n, ..., "total": n}, "forms": n, "sharedMaps": n,
+//  "resource": {"bytes": n, "peak": n, ...}, "subtrees": [{"path": "a/b", "forms": n, "usage": {...}}, ...]}.
+// resource is left out without a CountingResource. The usage categories are estimates; resource counts allocations.
+extern void writeJson(const FormMemoryStats &, JsonWriter &);
+} // namespace CanForm
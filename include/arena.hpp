@@ -0,0 +1,73 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <memory_resource>
+#include <optional>
+
+namespace CanForm
+{
+// Bump allocator for building large forms. Memory is only returned when the arena is released or destroyed.
+// Enabling the pool lets freed nodes (e.g. from edits) be reused before the buffer grows again.
+class FormArena
+{
+  private:
+    std::pmr::monotonic_buffer_resource buffer;
+    std::optional<std::pmr::unsynchronized_pool_resource> pool;
+
+  public:
+    explicit FormArena(size_t initialSize = 0, bool usePool = false,
+                       std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+        : buffer(initialSize == 0 ? 1024 : initialSize, upstream), pool()
+    {
+        if (usePool)
+        {
+            pool.emplace(&buffer);
+        }
+    }
+    FormArena(const FormArena &) = delete;
+    FormArena(FormArena &&) = delete;
+
+    FormArena &operator=(const FormArena &) = delete;
+    FormArena &operator=(FormArena &&) = delete;
+
+    std::pmr::memory_resource *resource() noexcept
+    {
+        if (pool)
+        {
+            return &*pool;
+        }
+        return &buffer;
+    }
+
+    Allocator allocator() noexcept
+    {
+        return Allocator(resource());
+    }
+
+    operator Allocator() noexcept
+    {
+        return allocator();
+    }
+
+    // Constructs an object inside the arena. Its destructor is never run so the whole tree is torn down by
+    // release() in O(1).
+    template <typename T, typename... Args> T &create(Args &&...args)
+    {
+        std::pmr::polymorphic_allocator<T> a(resource());
+        T *t = a.allocate(1);
+        a.construct(t, std::forward<Args>(args)...);
+        return *t;
+    }
+
+    // Any object allocated from the arena that is still alive must not be used (or destroyed) after this.
+    void release() noexcept
+    {
+        if (pool)
+        {
+            pool->release();
+        }
+        buffer.release();
+    }
+};
+} // namespace CanForm
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace CanForm
+{
+constexpr uint32_t hashKey(std::string_view s) noexcept
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (char c : s)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+struct AtomEntry
+{
+    const char *data;
+    uint32_t size;
+    uint32_t hash;
+};
+
+struct AtomStats
+{
+    // Distinct strings in the pool
+    size_t atoms;
+    // Bytes used by the pool and by every Atom handle
+    size_t bytes;
+    // Number of strings that were interned
+    size_t requests;
+    // Bytes the same strings would have used as separate String objects
+    size_t requestedBytes;
+
+    constexpr size_t saved() const noexcept
+    {
+        return requestedBytes > bytes ? requestedBytes - bytes : 0;
+    }
+};
+
+// Interned, immutable string. Every Atom with the same contents points to the same entry in a global thread-safe
+// pool so comparing two atoms is a pointer compare and repeated keys share their storage. Entries live until the
+// program exits.
+class Atom
+{
+  private:
+    const AtomEntry *entry;
+
+    static const AtomEntry *intern(std::string_view);
+
+  public:
+    static constexpr AtomEntry Empty{"", 0, hashKey(std::string_view())};
+
+    constexpr Atom() noexcept : entry(&Empty)
+    {
+    }
+    Atom(std::string_view s) : entry(intern(s))
+    {
+    }
+    Atom(const char *s) : Atom(std::string_view(s))
+    {
+    }
+    template <typename S, std::enable_if_t<std::is_convertible_v<const S &, std::string_view> &&
+                                               !std::is_same_v<S, Atom> && !std::is_same_v<S, std::string_view>,
+                                           bool> = true>
+    Atom(const S &s) : Atom(std::string_view(s))
+    {
+    }
+    constexpr Atom(const Atom &) noexcept = default;
+    constexpr Atom &operator=(const Atom &) noexcept = default;
+
+    constexpr std::string_view view() const noexcept
+    {
+        return std::string_view(entry->data, entry->size);
+    }
+    constexpr operator std::string_view() const noexcept
+    {
+        return view();
+    }
+
+    // Always null terminated
+    constexpr const char *c_str() const noexcept
+    {
+        return entry->data;
+    }
+    constexpr const char *data() const noexcept
+    {
+        return entry->data;
+    }
+    constexpr size_t size() const noexcept
+    {
+        return entry->size;
+    }
+    constexpr bool empty() const noexcept
+    {
+        return entry->size == 0;
+    }
+    constexpr uint32_t hash() const noexcept
+    {
+        return entry->hash;
+    }
+    constexpr const AtomEntry *id() const noexcept
+    {
+        return entry;
+    }
+
+    constexpr bool operator==(const Atom &a) const noexcept
+    {
+        return entry == a.entry;
+    }
+    constexpr bool operator!=(const Atom &a) const noexcept
+    {
+        return entry != a.entry;
+    }
+    constexpr bool operator<(const Atom &a) const noexcept
+    {
+        return entry != a.entry && view() < a.view();
+    }
+
+    static AtomStats getStats();
+};
+
+// The atom parameters are templates as well so none of these overloads intern a string through an implicit
+// conversion.
+template <typename A, typename S>
+using IfAtomComparable = std::enable_if_t<std::is_same_v<A, Atom> && !std::is_same_v<S, Atom> &&
+                                              std::is_convertible_v<const S &, std::string_view>,
+                                          bool>;
+
+template <typename A, typename S, IfAtomComparable<A, S> = true>
+constexpr bool operator==(const A &a, const S &s) noexcept
+{
+    return a.view() == std::string_view(s);
+}
+template <typename S, typename A, IfAtomComparable<A, S> = true>
+constexpr bool operator==(const S &s, const A &a) noexcept
+{
+    return a.view() == std::string_view(s);
+}
+template <typename A, typename S, IfAtomComparable<A, S> = true>
+constexpr bool operator!=(const A &a, const S &s) noexcept
+{
+    return a.view() != std::string_view(s);
+}
+template <typename S, typename A, IfAtomComparable<A, S> = true>
+constexpr bool operator!=(const S &s, const A &a) noexcept
+{
+    return a.view() != std::string_view(s);
+}
+template <typename A, typename S, IfAtomComparable<A, S> = true>
+constexpr bool operator<(const A &a, const S &s) noexcept
+{
+    return a.view() < std::string_view(s);
+}
+template <typename S, typename A, IfAtomComparable<A, S> = true>
+constexpr bool operator<(const S &s, const A &a) noexcept
+{
+    return std::string_view(s) < a.view();
+}
+
+template <typename OS, typename A, std::enable_if_t<std::is_same_v<A, Atom>, bool> = true>
+inline auto operator<<(OS &os, const A &a) -> decltype(os << std::string_view())
+{
+    return os << a.view();
+}
+} // namespace CanForm
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "field.hpp"
+#include "form.hpp"
+
+#include <optional>
+
+namespace CanForm
+{
+template <typename V> struct NumberColumns;
+template <typename... Ts> struct NumberColumns<std::variant<Range<Ts>...>>
+{
+    using type = std::variant<std::pmr::vector<Ts>...>;
+};
+
+// Values of a RangedValue column in the number type of its prototype
+using NumberColumn = NumberColumns<RangedValue>::type;
+
+// Many records with the shape of one StructForm, stored one column per field. Fields of nested StructForms become
+// columns named by their keys joined with '/'. Fields can be bool, RangedValue, String or StringSelection.
+class FormBatch
+{
+  public:
+    using allocator_type = Allocator;
+
+    struct Column
+    {
+        using Values = std::variant<std::pmr::vector<uint8_t>, NumberColumn, std::pmr::vector<String>,
+                                    std::pmr::vector<int32_t>>;
+
+        String name;
+        FieldRef field;
+        // bool: 0 or 1 per record. RangedValue: the numbers. String: the strings. StringSelection: the indices.
+        Values values;
+        // Bounds and default of a RangedValue
+        RangedValue bounds;
+        // Options of a StringSelection
+        IndexedStringSet options;
+
+        // Alternative of the field in Form::Data
+        constexpr size_t getAlternative() const noexcept
+        {
+            return field.getAlternative();
+        }
+    };
+
+  private:
+    Form prototype;
+    std::pmr::vector<Column> columns;
+    size_t count;
+
+    FormBatch(Form &&, std::pmr::vector<Column> &&);
+
+  public:
+    FormBatch(const FormBatch &) = default;
+    FormBatch(FormBatch &&) noexcept = default;
+
+    FormBatch &operator=(const FormBatch &) = default;
+    FormBatch &operator=(FormBatch &&) noexcept = default;
+
+    // Returns nothing if the prototype is not a StructForm or has a field that cannot be a column
+    static std::optional<FormBatch> create(const Form &prototype, const allocator_type & = allocator_type());
+
+    // Number of records
+    constexpr size_t size() const noexcept
+    {
+        return count;
+    }
+    size_t columnCount() const noexcept
+    {
+        return columns.size();
+    }
+    const Column &column(size_t i) const noexcept
+    {
+        return columns[i];
+    }
+    const Form &getPrototype() const noexcept
+    {
+        return prototype;
+    }
+    std::optional<size_t> find(std::string_view name) const noexcept;
+
+    // New records get the values of the prototype
+    void resize(size_t);
+    void erase(size_t record);
+    // Returns false if the form does not have the prototype's shape. Nothing is added in that case.
+    bool append(const Form &);
+
+    // Builds the form of one record
+    Form get(size_t record, const allocator_type & = allocator_type()) const;
+    // Returns false if the form does not have the prototype's shape. The record is unchanged in that case.
+    bool set(size_t record, const Form &);
+
+    // Contiguous values of a column, or null if T is not the column's value type. The value types are uint8_t for
+    // bool, the number type for RangedValue, String and int32_t for StringSelection. Writes are not checked; use
+    // validate and clamp afterwards.
+    template <typename T> T *values(size_t i) noexcept
+    {
+        return const_cast<T *>(static_cast<const FormBatch *>(this)->values<T>(i));
+    }
+    template <typename T> const T *values(size_t i) const noexcept
+    {
+        const Column &c = columns[i];
+        if (auto v = std::get_if<std::pmr::vector<T>>(&c.values))
+        {
+            return v->data();
+        }
+        if (auto numbers = std::get_if<NumberColumn>(&c.values))
+        {
+            if (auto v = std::get_if<std::pmr::vector<T>>(numbers))
+            {
+                return v->data();
+            }
+        }
+        return nullptr;
+    }
+
+    // Sets a bool, number or selection index, clamped to the column's bounds. Returns the stored value as a double
+    // or nothing for String columns.
+    std::optional<double> setNumber(size_t column, size_t record, double);
+    std::optional<double> getNumber(size_t column, size_t record) const noexcept;
+    // Parses the text exactly in the number type of a RangedValue column and clamps it to the bounds, like
+    // Range::setFromChars. Returns false and keeps the value if the text is not a number or the column has no numbers.
+    bool setNumberFromChars(size_t column, size_t record, std::string_view);
+    // Writes the number of a RangedValue column without a terminator, like Range::toChars. Null if it does not fit or
+    // the column has no numbers.
+    char *numberToChars(size_t column, size_t record, char *first, char *last) const noexcept;
+    // Returns false if the column does not hold strings or the selection has no such option
+    bool setString(size_t column, size_t record, std::string_view);
+    // The string or selected option
+    std::optional<std::string_view> getString(size_t column, size_t record) const noexcept;
+
+    // Appends the records whose values are outside the bounds or options of the column. Returns how many were found.
+    size_t validate(size_t column, std::pmr::vector<size_t> &records) const;
+    // Moves values outside the bounds to the nearest bound and invalid selections to the first option. Returns the
+    // number of values changed.
+    size_t clamp(size_t column);
+    size_t clamp();
+
+    allocator_type get_allocator() const noexcept
+    {
+        return columns.get_allocator();
+    }
+};
+
+// Shows a batch as a table. Values are clamped to their bounds before ok() runs.
+template <typename F> class BatchExecute : public FormExecute
+{
+  private:
+    FormBatch batch;
+    F func;
+
+  public:
+    BatchExecute(F &&f, FormBatch &&b) : FormExecute(), batch(std::move(b)), func(std::move(f))
+    {
+    }
+    BatchExecute(const BatchExecute &) = delete;
+    BatchExecute(BatchExecute &&) noexcept = default;
+    virtual ~BatchExecute()
+    {
+    }
+
+    virtual FormBatch *getBatch() noexcept override
+    {
+        return &batch;
+    }
+
+    virtual void ok() override
+    {
+        batch.clamp();
+        if constexpr (std::is_invocable<F, FormBatch &>::value)
+        {
+            func(batch);
+        }
+        else
+        {
+            func();
+        }
+    }
+};
+
+// For FormExecute::execute(title, executeBatch(...))
+template <typename F> static inline BatchExecute<F> executeBatch(F &&f, FormBatch batch)
+{
+    BatchExecute<F> execute(std::move(f), std::move(batch));
+    return execute;
+}
+} // namespace CanForm
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "form.hpp"
+
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Describes the members of a struct once so the backends can show and edit them in place. Place it in the struct
+// after the members:
+//
+//     struct Person
+//     {
+//         std::string name;
+//         int age;
+//         BIND(Person, name, age)
+//     };
+//
+// Members can be bool, arithmetic types (shown as ranges over the whole type), Range<T> (shown with its bounds),
+// std::string, std::set<std::string> and other structs that use BIND. The member names are the labels.
+#define BIND(T, ...)                                                                                                   \
+    auto makeBinding() noexcept                                                                                        \
+    {                                                                                                                  \
+        return std::tie(__VA_ARGS__);                                                                                  \
+    }                                                                                                                  \
+    static constexpr std::string_view bindingNames() noexcept                                                          \
+    {                                                                                                                  \
+        return #__VA_ARGS__;                                                                                           \
+    }                                                                                                                  \
+    static constexpr std::string_view bindingType() noexcept                                                           \
+    {                                                                                                                  \
+        return #T;                                                                                                     \
+    }
+
+namespace CanForm
+{
+// Arithmetic member with the bounds it is edited with
+template <typename T> struct BoundRange
+{
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>);
+
+    T *value;
+    T min;
+    T max;
+
+    constexpr BoundRange(T &t, T mi, T ma) noexcept : value(&t), min(mi), max(ma)
+    {
+    }
+    explicit BoundRange(T &t) noexcept
+        : BoundRange(t, std::numeric_limits<T>::lowest(), std::numeric_limits<T>::max())
+    {
+    }
+    explicit BoundRange(Range<T> &range) noexcept
+        : BoundRange(*range.operator->(), range.getMinMax().first, range.getMinMax().second)
+    {
+    }
+
+    double setFromDouble(double d) noexcept
+    {
+        if (auto t = convertNumber(d, min, max))
+        {
+            *value = *t;
+        }
+        return static_cast<double>(*value);
+    }
+    // Same as Range<T>::setFromChars
+    bool setFromChars(std::string_view text) noexcept
+    {
+        if (auto t = parseChars(text))
+        {
+            *value = *t;
+            return true;
+        }
+        return false;
+    }
+    std::optional<T> parseChars(std::string_view text) const noexcept
+    {
+        return parseNumber(text, min, max);
+    }
+    char *toChars(char *first, char *last) const noexcept
+    {
+        return formatNumber(first, last, *value);
+    }
+    void step(int steps) noexcept
+    {
+        *value = stepNumber(*value, steps, min, max);
+    }
+};
+
+using BoundNumber = std::variant<BoundRange<int8_t>, BoundRange<int16_t>, BoundRange<int32_t>, BoundRange<int64_t>,
+                                 BoundRange<uint8_t>, BoundRange<uint16_t>, BoundRange<uint32_t>, BoundRange<uint64_t>,
+                                 BoundRange<float>, BoundRange<double>>;
+
+struct BoundField;
+
+// Fields of a bound struct in declaration order. Holds pointers to the members, not copies.
+struct BoundStruct
+{
+    std::string_view type;
+    std::vector<BoundField> fields;
+    size_t columns = 1;
+};
+
+struct BoundField
+{
+    using Value = std::variant<bool *, BoundNumber, std::string *, std::set<std::string> *, BoundStruct>;
+
+    std::string_view name;
+    Value value;
+};
+
+template <typename T, typename = void> struct IsBound : std::false_type
+{
+};
+template <typename T>
+struct IsBound<T, std::void_t<decltype(std::declval<T &>().makeBinding()), decltype(T::bindingNames())>>
+    : std::true_type
+{
+};
+
+template <typename S> BoundStruct bindStruct(S &);
+
+template <typename T> BoundField::Value bindValue(T &t)
+{
+    if constexpr (std::is_same_v<T, bool>)
+    {
+        return &t;
+    }
+    else if constexpr (std::is_arithmetic_v<T>)
+    {
+        return BoundNumber(BoundRange<T>(t));
+    }
+    else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::set<std::string>>)
+    {
+        return &t;
+    }
+    else if constexpr (IsBound<T>::value)
+    {
+        return bindStruct(t);
+    }
+    else
+    {
+        static_assert(IsBound<T>::value, "Member type cannot be bound");
+    }
+}
+
+template <typename T> BoundField::Value bindValue(Range<T> &range)
+{
+    return BoundNumber(BoundRange<T>(range));
+}
+
+// Splits the stringized member list of BIND
+extern std::vector<std::string_view> splitBindingNames(std::string_view);
+
+template <typename S> BoundStruct bindStruct(S &s)
+{
+    static_assert(IsBound<S>::value, "Use BIND in the struct");
+    static const std::vector<std::string_view> names = splitBindingNames(S::bindingNames());
+    BoundStruct bound;
+    bound.type = S::bindingType();
+    bound.fields.reserve(names.size());
+    std::apply(
+        [&bound](auto &...members) {
+            size_t i = 0;
+            (bound.fields.push_back(BoundField{names[i++], bindValue(members)}), ...);
+        },
+        s.makeBinding());
+    return bound;
+}
+
+// Shows the members of a bound struct. Edits are written to the struct as they are made; cancel does not undo them.
+template <typename S, typename F> class BoundExecute : public FormExecute
+{
+  private:
+    S *object;
+    BoundStruct binding;
+    F func;
+
+  public:
+    BoundExecute(S &s, F &&f) : FormExecute(), object(&s), binding(bindStruct(s)), func(std::move(f))
+    {
+    }
+    BoundExecute(const BoundExecute &) = delete;
+    BoundExecute(BoundExecute &&) noexcept = default;
+    virtual ~BoundExecute()
+    {
+    }
+
+    virtual BoundStruct *getBinding() noexcept override
+    {
+        return &binding;
+    }
+
+    virtual void ok() override
+    {
+        if constexpr (std::is_invocable<F, S &>::value)
+        {
+            func(*object);
+        }
+        else
+        {
+            func();
+        }
+    }
+};
+
+// For FormExecute::execute(title, executeBound(...)). s must outlive the dialog.
+template <typename S, typename F> static inline BoundExecute<S, F> executeBound(S &s, F &&f)
+{
+    BoundExecute<S, F> execute(s, std::move(f));
+    return execute;
+}
+} // namespace CanForm
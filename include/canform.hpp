@@ -1,11 +1,28 @@
 #pragma once
 
+#include "arena.hpp"
+#include "binding.hpp"
+#include "numeric.hpp"
 #include "range.hpp"
 #include "tie.hpp"
 #include "types.hpp"
 
+#include "accounting.hpp"
+#include "batch.hpp"
+#include "computed.hpp"
 #include "dialog.hpp"
+#include "field.hpp"
 #include "form.hpp"
+#include "hash.hpp"
+#include "journal.hpp"
+#include "json.hpp"
 #include "menu.hpp"
+#include "options.hpp"
+#include "patch.hpp"
+#include "schema.hpp"
+#include "snapshot.hpp"
+#include "tracker.hpp"
+#include "validation.hpp"
+#include "walker.hpp"
 
 #include "awaiter.hpp"
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "form.hpp"
+#include "patch.hpp"
+
+#include <functional>
+#include <initializer_list>
+#include <map>
+
+namespace CanForm
+{
+class FormTracker;
+
+// Fields whose values are functions of other fields. Each computed field reads some paths and writes one target
+// path. A change marks the fields that read it (or anything above or below it) as dirty; nothing is recomputed until
+// update(), which only runs dirty fields, in dependency order, and only passes a change on when the target actually
+// changed.
+//
+// Computations should write the target in place and keep its alternative so the trackers and widgets that hold
+// addresses inside it stay valid. To compute whether a field of an EnableForm is enabled, target the EnableForm.
+class ComputedFields
+{
+  public:
+    using allocator_type = Allocator;
+    // Forms at the input paths in the order they were given. Null if the form has no such field.
+    using Inputs = std::pmr::vector<const Form *>;
+    using Compute = std::function<void(const Inputs &, Form &target)>;
+    // Called with the path and the form of every target that changed
+    using Changed = std::function<void(const FormPath &, Form &)>;
+
+  private:
+    struct Field
+    {
+        FormPath target;
+        std::pmr::vector<FormPath> inputs;
+        Compute compute;
+        // Fields that read the target
+        std::pmr::vector<uint32_t> dependents;
+        bool dirty;
+    };
+
+    std::pmr::vector<Field> fields;
+    // Indices into fields, every field after the fields it reads. Sorted again on the next update after an add.
+    std::pmr::vector<uint32_t> order;
+    // Fields by the paths they read
+    std::pmr::map<FormPath, std::pmr::vector<uint32_t>> readers;
+    // Fields by their targets
+    std::pmr::map<FormPath, uint32_t> targets;
+    bool sorted;
+    bool updating;
+
+    bool reaches(uint32_t from, const std::pmr::vector<uint32_t> &to) const;
+    void sort();
+    void markReaders(const FormPath &);
+
+  public:
+    explicit ComputedFields(const allocator_type & = allocator_type());
+
+    // Returns false if the target is already computed or the field would depend on itself. Keys are separated by '/'.
+    bool add(std::string_view target, std::initializer_list<std::string_view> inputs, Compute);
+    bool add(const FormPath &target, const std::pmr::vector<FormPath> &inputs, Compute);
+
+    size_t size() const noexcept
+    {
+        return fields.size();
+    }
+    size_t dirtyCount() const noexcept;
+
+    // Marks the fields that read path as dirty
+    void invalidate(const FormPath &);
+    // Marks every field as dirty
+    void invalidate() noexcept;
+
+    // Recomputes the dirty fields. Changed targets are touched in the tracker if there is one. Returns the number of
+    // targets that changed.
+    size_t update(Form &, FormTracker * = nullptr, const Changed & = Changed());
+
+    // For the backends: invalidates the readers of an edited field and updates them. Does nothing while an update is
+    // running, so the touches of update() do not start another one.
+    size_t changed(const FormPath &, Form &, FormTracker * = nullptr, const Changed & = Changed());
+
+    // Helpers for computations on numbers. RangedValue and bool read as numbers; anything else is nothing.
+    static std::optional<double> number(const Form *) noexcept;
+    // Sets a RangedValue (clamped to its bounds) or a bool. Returns false for other alternatives.
+    static bool setNumber(Form &, double) noexcept;
+
+    allocator_type get_allocator() const noexcept
+    {
+        return fields.get_allocator();
+    }
+};
+} // namespace CanForm
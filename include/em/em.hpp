@@ -7,6 +7,8 @@
 
 namespace CanForm
 {
+class FormVisitor;
+
 constexpr const char *toString(MessageBoxType type) noexcept
 {
     switch (type)
@@ -76,12 +78,31 @@ extern "C"
 {
     void EMSCRIPTEN_KEEPALIVE updateBoolean(bool &, bool);
     void EMSCRIPTEN_KEEPALIVE updateString(CanForm::String &, char *);
-    double EMSCRIPTEN_KEEPALIVE updateRange(CanForm::IRange &, double);
-    void EMSCRIPTEN_KEEPALIVE updateVariantForm(CanForm::VariantForm &, char *);
+    void EMSCRIPTEN_KEEPALIVE updateStdString(std::string &, char *);
+    const char *EMSCRIPTEN_KEEPALIVE updateRangeText(CanForm::FormTracker *, CanForm::RangedValue &, const char *);
+    const char *EMSCRIPTEN_KEEPALIVE updateBoundRangeText(CanForm::FormTracker *, CanForm::BoundNumber &,
+                                                          const char *);
+    void EMSCRIPTEN_KEEPALIVE updateBatchFlag(CanForm::FormBatch &, int, int, bool);
+    const char *EMSCRIPTEN_KEEPALIVE updateBatchNumber(CanForm::FormBatch &, int, int, const char *);
+    bool EMSCRIPTEN_KEEPALIVE updateBatchString(CanForm::FormBatch &, int, int, char *);
+    void EMSCRIPTEN_KEEPALIVE showBatchPage(CanForm::FormBatch &, int, int);
+    void EMSCRIPTEN_KEEPALIVE showOptions(CanForm::StringSelection &, int, int);
+    int EMSCRIPTEN_KEEPALIVE findOption(CanForm::StringSelection &, char *);
+    bool EMSCRIPTEN_KEEPALIVE selectOption(CanForm::StringSelection &, int);
+    void EMSCRIPTEN_KEEPALIVE selectVariantForm(CanForm::FormVisitor &, CanForm::VariantForm &, int, char *);
+    void EMSCRIPTEN_KEEPALIVE undoEdit(CanForm::FormVisitor &);
+    void EMSCRIPTEN_KEEPALIVE redoEdit(CanForm::FormVisitor &);
     bool EMSCRIPTEN_KEEPALIVE updateHandler(CanForm::FileDialog::Handler &, char *);
     void EMSCRIPTEN_KEEPALIVE cancelHandler(CanForm::FileDialog::Handler &);
 
     void EMSCRIPTEN_KEEPALIVE addToStringSet(CanForm::StringSet &, char *);
     void EMSCRIPTEN_KEEPALIVE removeFromStringSet(CanForm::StringSet &, char *);
-    void EMSCRIPTEN_KEEPALIVE updateStringSetDiv(CanForm::StringSet &, int);
+    void EMSCRIPTEN_KEEPALIVE updateStringSetDiv(CanForm::StringSet &, int, CanForm::FormTracker *);
+
+    void EMSCRIPTEN_KEEPALIVE addToStdStringSet(std::set<std::string> &, char *);
+    void EMSCRIPTEN_KEEPALIVE removeFromStdStringSet(std::set<std::string> &, char *);
+    void EMSCRIPTEN_KEEPALIVE updateStdStringSetDiv(std::set<std::string> &, int, CanForm::FormTracker *);
+
+    void EMSCRIPTEN_KEEPALIVE trackChange(CanForm::FormTracker *, void *);
+    void EMSCRIPTEN_KEEPALIVE prepareChange(CanForm::FormTracker *, void *);
 }
\ No newline at end of file
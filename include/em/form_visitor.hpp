@@ -2,17 +2,64 @@
 
 #include <em/em.hpp>
 #include <form.hpp>
+#include <journal.hpp>
+#include <tracker.hpp>
+#include <validation.hpp>
+#include <walker.hpp>
+
+#include <unordered_map>
 
 namespace CanForm
 {
 class FormVisitor
 {
   private:
+    // A form inside a VariantForm or EnableForm whose div show() makes after the current walk
+    struct Pending
+    {
+        Form *form;
+        std::string_view name;
+        std::function<void(int)> place;
+    };
+
     std::shared_ptr<FormExecute> formExecute;
+    FormTracker *tracker;
     std::string_view name;
     int dialogId;
+    // Div and name of each form, so validation errors and computed values can be shown on them
+    std::unordered_map<const Form *, std::pair<int, std::string_view>> divs;
+    // Tracker listener that updates the computed fields
+    size_t listener;
+    // Set while show() runs
+    std::vector<Pending> *pending;
 
     int makeDiv();
+    int textArea(const char *value, void *address, const char *update);
+    // A text input that passes the exact digits to update, which returns the clamped value as text
+    int numberInput(const char *value, const char *min, const char *max, bool integer, void *address,
+                    const char *update);
+    int editableSet(void *address, const char *add, const char *update);
+    // A grid div for the fields of a form
+    int openGrid(size_t columns);
+    // Moves the div of a field into the div of its form
+    void attach(int parent, int child);
+    // Wraps a div in a button that expands it if there is a title. Returns the id of the outer div.
+    int expander(int id, const String &title);
+    template <typename Fields, typename F> int grid(size_t columns, Fields &, F &&visit);
+    // A StringSelection whose options come from a provider
+    int optionPicker(StringSelection &);
+
+    // Makes the div for a form and remembers it
+    int show(Form &);
+    // Walks a form and makes its div. Forms inside a VariantForm or EnableForm are left in pending.
+    int build(Form &, MutableFormWalker &);
+    // Makes the div of a form inside another one and gives its id to place, after the current walk if show() runs, so
+    // nested forms do not recurse
+    void showInside(Form &, std::string_view formName, std::function<void(int)> place);
+    // Marks the divs of the failing forms and clears the marks of the others
+    void highlight(const std::pmr::vector<ValidationError> &) const;
+    // Replaces the div of a form that was changed outside of its inputs
+    void refresh(Form &);
 
     void checkLater();
     static void checkForResponse(void *userData);
@@ -20,7 +67,8 @@ class FormVisitor
     friend struct FormExecute;
 
   public:
-    FormVisitor(const std::shared_ptr<FormExecute> &f) : formExecute(f), name(), dialogId(0)
+    FormVisitor(const std::shared_ptr<FormExecute> &f, FormTracker *t = nullptr)
+        : formExecute(f), tracker(t), name(), dialogId(0), divs(), listener(0), pending(nullptr)
     {
     }
 
@@ -30,7 +78,6 @@ class FormVisitor
     int operator()(String &);
     int operator()(ComplexString &);
 
-    template <typename T> int operator()(Range<T> &);
     int operator()(RangedValue &);
 
     int operator()(StringSet &);
@@ -38,49 +85,22 @@ class FormVisitor
     int operator()(StringMap &);
 
     int operator()(VariantForm &);
+    // Shows an alternative in the div of a VariantForm, building it if it is lazy
+    void select(VariantForm &, int id, const Atom &key);
+    // Undoes or redoes an edit with the journal of the form and replaces the div of the form it changed
+    void replay(bool redo);
     int operator()(StructForm &);
     int operator()(EnableForm &);
-};
 
-template <typename T> int FormVisitor::operator()(Range<T> &range)
-{
-    auto [min, max] = range.getMinMax();
-    const int id = makeDiv();
-    EM_ASM(
-        {
-            let id = $0;
-            let value = $1;
-            let min = $2;
-            let max = $3;
-            let r = $4;
-
-            let div = document.getElementById('div_' + id.toString());
-
-            let input = document.createElement('input');
-            input.type = 'number';
-            input.value = value;
-            input.min = min.toString();
-            input.max = max.toString();
-            input.onchange = function()
-            {
-                input.value =
-                    Module.ccall('updateRange', 'number', [ 'number', 'number' ], [ r, parseFloat(input.value) ]);
-            };
-            input.onkeypress = function()
-            {
-                this.onchange();
-            };
-            input.onpaste = function()
-            {
-                this.onchange();
-            };
-            input.oninput = function()
-            {
-                this.onchange();
-            };
-            div.append(input);
-        },
-        id, *range, (double)min, (double)max, &range);
-    return id;
-}
+    int operator()(BoundNumber &);
+    int operator()(std::string &);
+    int operator()(std::set<std::string> &);
+    int operator()(BoundStruct &);
+
+    // Options of a provider shown at a time
+    static constexpr int PickerRows = 10;
+    // Rows per page of a FormBatch table
+    static constexpr int BatchPageSize = 25;
+    int operator()(FormBatch &);
+};
 } // namespace CanForm
\ No newline at end of file
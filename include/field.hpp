@@ -0,0 +1,120 @@
+#pragma once
+
+#include "form.hpp"
+#include "patch.hpp"
+
+#include <optional>
+
+namespace CanForm
+{
+// A path to a field compiled against a schema form. Each step remembers the kind of form that holds the key and the
+// position of the key in the schema, so resolving it on a form of the same shape is a bounds check and an atom
+// compare per step. Forms that differ from the schema fall back to a lookup by key.
+class FieldRef
+{
+  public:
+    struct Step
+    {
+        Atom key;
+        // StructForm, VariantForm or EnableForm
+        uint8_t container;
+        // Position of key in the schema
+        uint32_t position;
+    };
+    using Steps = std::pmr::vector<Step>;
+
+  private:
+    Steps steps;
+    // Alternative of the field in the schema
+    size_t alternative;
+
+    FieldRef(Steps &&s, size_t a) : steps(std::move(s)), alternative(a)
+    {
+    }
+
+  public:
+    FieldRef(const FieldRef &) = default;
+    FieldRef(FieldRef &&) noexcept = default;
+
+    FieldRef &operator=(const FieldRef &) = default;
+    FieldRef &operator=(FieldRef &&) noexcept = default;
+
+    // Keys are separated by '/', such as "Variant Form/1st Variant/Age". Returns nothing if the schema has no such
+    // field.
+    static std::optional<FieldRef> compile(std::string_view path, const Form &schema, const Allocator & = Allocator());
+    // For keys that contain '/'
+    static std::optional<FieldRef> compile(const FormPath &, const Form &schema, const Allocator & = Allocator());
+
+    // Null if the form does not have the field. Resolving a mutable form unshares the maps on the path.
+    const Form *resolve(const Form &) const noexcept;
+    Form *resolve(Form &) const;
+
+    template <typename T> const T *get(const Form &form) const noexcept
+    {
+        const Form *field = resolve(form);
+        return field == nullptr ? nullptr : field->getIf<T>();
+    }
+    template <typename T> T *get(Form &form) const
+    {
+        Form *field = resolve(form);
+        return field == nullptr ? nullptr : field->getIf<T>();
+    }
+
+    template <typename T> const Range<T> *getRange(const Form &form) const noexcept
+    {
+        const RangedValue *value = get<RangedValue>(form);
+        return value == nullptr ? nullptr : std::get_if<Range<T>>(value);
+    }
+    template <typename T> Range<T> *getRange(Form &form) const
+    {
+        RangedValue *value = get<RangedValue>(form);
+        return value == nullptr ? nullptr : std::get_if<Range<T>>(value);
+    }
+
+    const Steps &getSteps() const noexcept
+    {
+        return steps;
+    }
+    constexpr size_t getAlternative() const noexcept
+    {
+        return alternative;
+    }
+    FormPath getPath(const Allocator & = Allocator()) const;
+};
+
+// Reads many fields in one walk of a form. Paths are merged into a trie so shared prefixes are visited once.
+class FieldGather
+{
+  private:
+    struct Node
+    {
+        FieldRef::Step step;
+        std::pmr::vector<uint32_t> children;
+        // Indices of the fields that end at this node
+        std::pmr::vector<uint32_t> fields;
+
+        Node(const FieldRef::Step &s, const Allocator &a) : step(s), children(a), fields(a)
+        {
+        }
+    };
+
+    std::pmr::vector<Node> nodes;
+    size_t count;
+
+    void gather(uint32_t node, const Form &, const Form **out) const noexcept;
+
+  public:
+    explicit FieldGather(const Allocator & = Allocator());
+
+    // Returns the index of the field in the gathered output
+    size_t add(const FieldRef &);
+
+    constexpr size_t size() const noexcept
+    {
+        return count;
+    }
+
+    // Resizes out to size(). Fields that the form does not have are null.
+    void gather(const Form &, std::pmr::vector<const Form *> &out) const;
+};
+} // namespace CanForm
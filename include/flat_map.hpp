@@ -0,0 +1,389 @@
+#pragma once
+
+#include "atom.hpp"
+#include "types.hpp"
+
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#ifndef CANFORM_ORDERED_MAPS
+#define CANFORM_ORDERED_MAPS 1
+#endif
+
+namespace CanForm
+{
+// Open addressing table that maps a key hash to a position in some contiguous container. The container owns the
+// keys so the table only stores positions and it never dangles when the container reallocates.
+class HashIndex
+{
+  public:
+    static constexpr uint32_t npos = static_cast<uint32_t>(-1);
+
+  private:
+    struct Slot
+    {
+        uint32_t position;
+        uint32_t hash;
+    };
+    std::pmr::vector<Slot> slots;
+    size_t count;
+
+    static constexpr Slot Empty{npos, 0};
+
+    size_t mask() const noexcept
+    {
+        return slots.size() - 1;
+    }
+
+    void place(uint32_t position, uint32_t hash)
+    {
+        for (size_t i = hash & mask();; i = (i + 1) & mask())
+        {
+            if (slots[i].position == npos)
+            {
+                slots[i] = Slot{position, hash};
+                return;
+            }
+        }
+    }
+
+  public:
+    explicit HashIndex(const Allocator &a = Allocator()) : slots(a), count(0)
+    {
+    }
+    HashIndex(const HashIndex &) = default;
+    HashIndex(HashIndex &&) noexcept = default;
+    HashIndex(const HashIndex &h, const Allocator &a) : slots(h.slots, a), count(h.count)
+    {
+    }
+    HashIndex(HashIndex &&h, const Allocator &a) : slots(std::move(h.slots), a), count(h.count)
+    {
+    }
+
+    HashIndex &operator=(const HashIndex &) = default;
+    HashIndex &operator=(HashIndex &&) noexcept = default;
+
+    // Returns the position for which matches(position) is true or npos
+    template <typename F> uint32_t find(uint32_t hash, F &&matches) const
+    {
+        if (slots.empty())
+        {
+            return npos;
+        }
+        for (size_t i = hash & mask();; i = (i + 1) & mask())
+        {
+            const Slot &slot = slots[i];
+            if (slot.position == npos)
+            {
+                return npos;
+            }
+            if (slot.hash == hash && matches(slot.position))
+            {
+                return slot.position;
+            }
+        }
+    }
+
+    void insert(uint32_t position, uint32_t hash)
+    {
+        if ((count + 1) * 2 > slots.size())
+        {
+            std::pmr::vector<Slot> old(std::max<size_t>(slots.size() * 2, 16), Empty, slots.get_allocator());
+            old.swap(slots);
+            for (const Slot &slot : old)
+            {
+                if (slot.position != npos)
+                {
+                    place(slot.position, slot.hash);
+                }
+            }
+        }
+        place(position, hash);
+        ++count;
+    }
+
+    void clear() noexcept
+    {
+        slots.clear();
+        count = 0;
+    }
+
+    // Bytes of the table
+    size_t bytes() const noexcept
+    {
+        return slots.capacity() * sizeof(Slot);
+    }
+
+    void reserve(size_t n)
+    {
+        if (n * 2 <= slots.size())
+        {
+            return;
+        }
+        size_t size = 16;
+        while (size < n * 2)
+        {
+            size *= 2;
+        }
+        std::pmr::vector<Slot> old(size, Empty, slots.get_allocator());
+        old.swap(slots);
+        for (const Slot &slot : old)
+        {
+            if (slot.position != npos)
+            {
+                place(slot.position, slot.hash);
+            }
+        }
+    }
+};
+
+// Map that keeps entries in insertion order in one contiguous buffer. Iteration is linear and lookups (including
+// heterogeneous std::string_view lookups) go through a HashIndex. Erasing is O(n). Keys must not be modified through
+// iterators.
+template <typename K, typename V> class OrderedMap
+{
+  public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+    using Entries = std::pmr::vector<value_type>;
+    using iterator = typename Entries::iterator;
+    using const_iterator = typename Entries::const_iterator;
+    using size_type = size_t;
+
+  private:
+    Entries entries;
+    HashIndex index;
+
+    template <typename Q> static uint32_t hashOf(const Q &key) noexcept
+    {
+        if constexpr (std::is_same_v<Q, Atom>)
+        {
+            return key.hash();
+        }
+        else
+        {
+            return hashKey(std::string_view(key));
+        }
+    }
+
+    // Keys of the same type as the map compare directly (a pointer compare for atoms)
+    template <typename Q> uint32_t locate(const Q &key, uint32_t hash) const
+    {
+        if constexpr (std::is_same_v<Q, K>)
+        {
+            return index.find(hash, [this, &key](uint32_t i) { return entries[i].first == key; });
+        }
+        else
+        {
+            const std::string_view view(key);
+            return index.find(hash, [this, view](uint32_t i) { return std::string_view(entries[i].first) == view; });
+        }
+    }
+
+    void reindex()
+    {
+        index.clear();
+        index.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            index.insert(static_cast<uint32_t>(i), hashOf(entries[i].first));
+        }
+    }
+
+  public:
+    OrderedMap() : entries(), index()
+    {
+    }
+    explicit OrderedMap(const allocator_type &a) : entries(a), index(a)
+    {
+    }
+    OrderedMap(std::initializer_list<value_type> list, const allocator_type &a = allocator_type())
+        : entries(a), index(a)
+    {
+        for (const auto &pair : list)
+        {
+            try_emplace(pair.first, pair.second);
+        }
+    }
+    OrderedMap(const OrderedMap &) = default;
+    OrderedMap(OrderedMap &&) noexcept = default;
+    OrderedMap(const OrderedMap &m, const allocator_type &a) : entries(m.entries, a), index(m.index, a)
+    {
+    }
+    OrderedMap(OrderedMap &&m, const allocator_type &a) : entries(std::move(m.entries), a), index(std::move(m.index), a)
+    {
+    }
+
+    OrderedMap &operator=(const OrderedMap &) = default;
+    OrderedMap &operator=(OrderedMap &&) noexcept = default;
+
+    allocator_type get_allocator() const noexcept
+    {
+        return entries.get_allocator();
+    }
+
+    iterator begin() noexcept
+    {
+        return entries.begin();
+    }
+    iterator end() noexcept
+    {
+        return entries.end();
+    }
+    const_iterator begin() const noexcept
+    {
+        return entries.begin();
+    }
+    const_iterator end() const noexcept
+    {
+        return entries.end();
+    }
+
+    size_t size() const noexcept
+    {
+        return entries.size();
+    }
+    bool empty() const noexcept
+    {
+        return entries.empty();
+    }
+    size_t capacity() const noexcept
+    {
+        return entries.capacity();
+    }
+    const HashIndex &getIndex() const noexcept
+    {
+        return index;
+    }
+
+    void reserve(size_t n)
+    {
+        entries.reserve(n);
+        index.reserve(n);
+    }
+
+    void clear() noexcept
+    {
+        entries.clear();
+        index.clear();
+    }
+
+    template <typename Q> iterator find(const Q &key)
+    {
+        const uint32_t i = locate(key, hashOf(key));
+        return i == HashIndex::npos ? end() : begin() + i;
+    }
+    template <typename Q> const_iterator find(const Q &key) const
+    {
+        const uint32_t i = locate(key, hashOf(key));
+        return i == HashIndex::npos ? end() : begin() + i;
+    }
+
+    template <typename Q> size_t count(const Q &key) const
+    {
+        return find(key) == end() ? 0 : 1;
+    }
+    template <typename Q> bool contains(const Q &key) const
+    {
+        return find(key) != end();
+    }
+
+    template <typename Key, typename... Args> std::pair<iterator, bool> try_emplace(Key &&key, Args &&...args)
+    {
+        const uint32_t hash = hashOf(key);
+        const uint32_t i = locate(key, hash);
+        if (i != HashIndex::npos)
+        {
+            return std::make_pair(begin() + i, false);
+        }
+        entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+        index.insert(static_cast<uint32_t>(entries.size() - 1), hash);
+        return std::make_pair(end() - 1, true);
+    }
+
+    template <typename Key, typename... Args> std::pair<iterator, bool> emplace(Key &&key, Args &&...args)
+    {
+        return try_emplace(std::forward<Key>(key), std::forward<Args>(args)...);
+    }
+
+    std::pair<iterator, bool> insert(const value_type &pair)
+    {
+        return try_emplace(pair.first, pair.second);
+    }
+    std::pair<iterator, bool> insert(value_type &&pair)
+    {
+        return try_emplace(std::move(pair.first), std::move(pair.second));
+    }
+
+    V &operator[](const K &key)
+    {
+        return try_emplace(key).first->second;
+    }
+    V &operator[](K &&key)
+    {
+        return try_emplace(std::move(key)).first->second;
+    }
+
+    // Throws std::out_of_range for a missing key like std::map::at
+    template <typename Q> V &at(const Q &key)
+    {
+        auto iter = find(key);
+        if (iter == end())
+        {
+            throw std::out_of_range("OrderedMap::at");
+        }
+        return iter->second;
+    }
+    template <typename Q> const V &at(const Q &key) const
+    {
+        auto iter = find(key);
+        if (iter == end())
+        {
+            throw std::out_of_range("OrderedMap::at");
+        }
+        return iter->second;
+    }
+
+    iterator erase(const_iterator iter)
+    {
+        auto result = entries.erase(iter);
+        reindex();
+        return result;
+    }
+
+    template <typename Q, std::enable_if_t<!std::is_convertible_v<const Q &, const_iterator>, bool> = true>
+    size_t erase(const Q &key)
+    {
+        auto iter = find(key);
+        if (iter == end())
+        {
+            return 0;
+        }
+        erase(iter);
+        return 1;
+    }
+};
+
+// Maps from field names to values. Field names are atoms so repeated schemas share their keys.
+#if CANFORM_ORDERED_MAPS
+template <typename V> using FormMap = OrderedMap<Atom, V>;
+#else
+template <typename V> using FormMap = std::pmr::map<Atom, V, std::less<>>;
+#endif
+
+// Flags keyed by user data. The keys stay Strings, not atoms, because they come from the values of a form (and from
+// untrusted input when reading JSON, patches or snapshots) and the atom pool is never freed.
+#if CANFORM_ORDERED_MAPS
+using StringMap = OrderedMap<String, bool>;
+#else
+using StringMap = std::pmr::map<String, bool, std::less<>>;
+#endif
+} // namespace CanForm
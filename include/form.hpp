@@ -1,8 +1,13 @@
 #pragma once
 
 #include "dialog.hpp"
+#include "flat_map.hpp"
+#include "indexed_set.hpp"
+#include "options.hpp"
+#include "shared.hpp"
 #include "types.hpp"
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string_view>
@@ -11,69 +16,122 @@ namespace CanForm
 {
 struct ComplexString
 {
+    using allocator_type = Allocator;
+
     std::pmr::map<String, StringSet> map;
     String string;
+
+    ComplexString() = default;
+    explicit ComplexString(const allocator_type &a) : map(a), string(a)
+    {
+    }
+    ComplexString(const ComplexString &) = default;
+    ComplexString(ComplexString &&) noexcept = default;
+    ComplexString(const ComplexString &c, const allocator_type &a) : map(c.map, a), string(c.string, a)
+    {
+    }
+    ComplexString(ComplexString &&c, const allocator_type &a)
+        : map(std::move(c.map), a), string(std::move(c.string), a)
+    {
+    }
+
+    ComplexString &operator=(const ComplexString &) = default;
+    ComplexString &operator=(ComplexString &&) noexcept = default;
 };
 
+// One of a set of options. Options come from set, or from provider if there is one; then only the chosen option is
+// stored, in key, and index is its position in the provider.
 struct StringSelection
 {
-    StringSet set;
+    using allocator_type = Allocator;
+
+    IndexedStringSet set;
     int index;
+    std::shared_ptr<const OptionProvider> provider;
+    String key;
 
-    StringSelection() : set(), index(0)
+    StringSelection() : set(), index(0), provider(), key()
+    {
+    }
+    explicit StringSelection(const allocator_type &a) : set(a), index(0), provider(), key(a)
     {
     }
     StringSelection(const StringSelection &) = default;
     StringSelection(StringSelection &&) noexcept = default;
+    StringSelection(const StringSelection &s, const allocator_type &a)
+        : set(s.set, a), index(s.index), provider(s.provider), key(s.key, a)
+    {
+    }
+    StringSelection(StringSelection &&s, const allocator_type &a)
+        : set(std::move(s.set), a), index(s.index), provider(std::move(s.provider)), key(std::move(s.key), a)
+    {
+    }
 
-    template <typename... Args> StringSelection(int i, Args &&...args) : set(std::forward<Args>(args)...), index(i)
+    template <typename... Args>
+    StringSelection(int i, Args &&...args) : set(std::forward<Args>(args)...), index(i), provider(), key()
+    {
+    }
+    // Selects key if it is an option, otherwise nothing
+    StringSelection(std::shared_ptr<const OptionProvider> p, std::string_view k = std::string_view())
+        : set(), index(-1), provider(std::move(p)), key()
     {
+        setSelection(k);
     }
 
     auto getIterator() const noexcept
     {
-        int i = index;
-        for (auto iter = set.begin(); iter != set.end(); ++iter, --i)
-        {
-            if (i == 0)
-            {
-                return iter;
-            }
-        }
-        return set.end();
+        return valid() && provider == nullptr ? set.begin() + index : set.end();
     }
 
     std::optional<String> getSelection() const
     {
-        auto iter = getIterator();
-        if (iter == set.end())
+        if (!valid())
         {
             return std::nullopt;
         }
-        return *iter;
+        return provider == nullptr ? set[index] : key;
     }
 
     bool setSelection(std::string_view newSelection)
     {
-        int i = 0;
-        for (auto &s : set)
+        const size_t i = provider == nullptr ? set.indexOf(newSelection) : provider->indexOf(newSelection);
+        if (i == IndexedStringSet::npos)
         {
-            if (s == newSelection)
-            {
-                index = i;
-                return true;
-            }
-            ++i;
+            return false;
+        }
+        return select(i);
+    }
+
+    // Selects the option at a position. Returns false if there is no such option.
+    bool select(size_t i)
+    {
+        if (i >= optionCount())
+        {
+            return false;
+        }
+        index = static_cast<int>(i);
+        if (provider != nullptr)
+        {
+            key = provider->at(i);
         }
-        return false;
+        return true;
+    }
+
+    size_t optionCount() const noexcept
+    {
+        return provider == nullptr ? set.size() : provider->size();
+    }
+    std::string_view option(size_t i) const
+    {
+        return provider == nullptr ? std::string_view(set[i]) : provider->at(i);
     }
 
     StringSelection &operator=(const StringSelection &) = default;
     StringSelection &operator=(StringSelection &&) noexcept = default;
 
-    constexpr bool valid() const noexcept
+    bool valid() const noexcept
     {
-        return 0 <= index && index < static_cast<int>(set.size());
+        return 0 <= index && static_cast<size_t>(index) < optionCount();
     }
 };
 
@@ -98,16 +156,32 @@ struct Form;
 
 struct StructForm
 {
-    using Map = std::pmr::map<String, Form>;
-    Map map;
+    using allocator_type = Allocator;
+    using Map = FormMap<Form>;
+    // Shared with copies until written
+    Shared<Map> map;
     size_t columns;
+    // Subtree hash or zero. Cleared by every non-const accessor; direct writes to the fields must call invalidate().
+    mutable uint64_t cachedHash = 0;
 
     StructForm() : map(), columns(1)
     {
     }
+    explicit StructForm(const allocator_type &a) : map(a), columns(1)
+    {
+    }
     StructForm(const StructForm &) = default;
     StructForm(StructForm &&) noexcept = default;
-    template <typename... Args> StructForm(size_t c, Args &&...args) : map(std::forward<Args>(args)...), columns(c)
+    StructForm(const StructForm &s, const allocator_type &a)
+        : map(s.map, a), columns(s.columns), cachedHash(s.cachedHash)
+    {
+    }
+    StructForm(StructForm &&s, const allocator_type &a)
+        : map(std::move(s.map), a), columns(s.columns), cachedHash(s.cachedHash)
+    {
+    }
+    template <typename... Args>
+    StructForm(size_t c, Args &&...args) : map(Map(std::forward<Args>(args)...)), columns(c)
     {
     }
 
@@ -117,60 +191,86 @@ struct StructForm
     template <typename T> StructForm &operator=(const Map &t)
     {
         map = t;
+        invalidate();
         return *this;
     }
     template <typename T> StructForm &operator=(Map &&t) noexcept
     {
         map = std::move(t);
+        invalidate();
         return *this;
     }
 
-    Form &operator[](const String &k)
+    void invalidate() const noexcept
     {
-        return map[k];
+        cachedHash = 0;
     }
-    Form &operator[](String &&k)
+
+    Form &operator[](const Atom &k)
     {
-        return map[std::move(k)];
+        invalidate();
+        return map.write()[k];
     }
 
     template <typename... Args> Form &operator[](Args &&...args)
     {
-        String string(std::forward<Args>(args)...);
-        return operator[](std::move(string));
+        const Atom atom(std::forward<Args>(args)...);
+        return operator[](atom);
     }
 
-    Map &operator*() noexcept
+    Map &operator*()
     {
-        return map;
+        invalidate();
+        return map.write();
     }
     const Map &operator*() const noexcept
     {
-        return map;
+        return map.read();
     }
 
-    Map *operator->() noexcept;
+    Map *operator->();
     const Map *operator->() const noexcept;
 
+    allocator_type get_allocator() const noexcept
+    {
+        return map.get_allocator();
+    }
+
     static StructForm create(StructForm &&structForm) noexcept;
     template <typename... Args> static StructForm create(StructForm &&, Args &&...args);
     template <typename K, typename V, typename... Args>
     static StructForm create(StructForm &&, K &&, V &&, Args &&...args);
     template <typename... Args> static StructForm create(Args &&...args);
+    template <typename... Args>
+    static StructForm create(std::allocator_arg_t, const allocator_type &, Args &&...args);
 };
 
 struct EnableForm
 {
+    using allocator_type = Allocator;
     using Value = std::pair<bool, Form>;
-    using Map = std::pmr::map<String, Value>;
-    Map map;
+    using Map = FormMap<Value>;
+    // Builds the nested forms of a copy with the map's memory resource
+    struct Clone
+    {
+        Map operator()(const Map &, const allocator_type &) const;
+    };
+    // Shared with copies until written
+    Shared<Map, Clone> map;
+    // Subtree hash or zero. Cleared by every non-const accessor; direct writes to map must call invalidate().
+    mutable uint64_t cachedHash = 0;
 
     EnableForm() : map()
     {
     }
+    explicit EnableForm(const allocator_type &a) : map(a)
+    {
+    }
     EnableForm(const EnableForm &) = default;
     EnableForm(EnableForm &&) noexcept = default;
-    template <typename... Args> EnableForm(std::in_place_t, Args &&...args) : map(std::forward<Args>(args)...)
+    EnableForm(const EnableForm &e, const allocator_type &a);
+    EnableForm(EnableForm &&e, const allocator_type &a);
+    template <typename... Args> EnableForm(std::in_place_t, Args &&...args) : map(Map(std::forward<Args>(args)...))
     {
     }
 
@@ -180,105 +280,350 @@ struct EnableForm
     template <typename T> EnableForm &operator=(const Map &t)
     {
         map = t;
+        invalidate();
         return *this;
     }
     template <typename T> EnableForm &operator=(Map &&t) noexcept
     {
         map = std::move(t);
+        invalidate();
         return *this;
     }
 
-    Value &operator[](const String &k)
-    {
-        return map[k];
-    }
-    Value &operator[](String &&k)
+    void invalidate() const noexcept
     {
-        return map[std::move(k)];
+        cachedHash = 0;
     }
 
+    Value &operator[](const Atom &k);
+
     template <typename... Args> Value &operator[](Args &&...args)
     {
-        String string(std::forward<Args>(args)...);
-        return operator[](std::move(string));
+        const Atom atom(std::forward<Args>(args)...);
+        return operator[](atom);
     }
 
-    Map &operator*() noexcept
+    Map &operator*()
     {
-        return map;
+        invalidate();
+        return map.write();
     }
     const Map &operator*() const noexcept
     {
-        return map;
+        return map.read();
     }
 
-    Map *operator->() noexcept;
+    Map *operator->();
     const Map *operator->() const noexcept;
+
+    allocator_type get_allocator() const noexcept
+    {
+        return map.get_allocator();
+    }
 };
 
 struct VariantForm
 {
-    using Map = std::pmr::map<String, Form>;
-    Map map;
+    using allocator_type = Allocator;
+    using Map = FormMap<Form>;
+    // Builds a lazy alternative
+    using Factory = std::function<Form()>;
+    using Factories = FormMap<Factory>;
+    // Shared with copies until written
+    Shared<Map> map;
     String selected;
+    // Factories of the lazy alternatives. A lazy alternative holds a monostate in map until it is built.
+    Shared<Factories> factories;
+    // Whether select() drops the lazy alternative that was selected before, back to a monostate
+    bool dropUnselected = false;
+    // Subtree hash or zero. Cleared by every non-const accessor; direct writes to the fields must call invalidate().
+    mutable uint64_t cachedHash = 0;
 
-    Form &operator[](const String &k)
+    VariantForm() = default;
+    explicit VariantForm(const allocator_type &a) : map(a), selected(a), factories(a)
     {
-        return map[k];
     }
-    Form &operator[](String &&k)
+    VariantForm(const VariantForm &) = default;
+    VariantForm(VariantForm &&) noexcept = default;
+    VariantForm(const VariantForm &v, const allocator_type &a)
+        : map(v.map, a), selected(v.selected, a), factories(v.factories, a), dropUnselected(v.dropUnselected),
+          cachedHash(v.cachedHash)
     {
-        return map[std::move(k)];
+    }
+    VariantForm(VariantForm &&v, const allocator_type &a)
+        : map(std::move(v.map), a), selected(std::move(v.selected), a), factories(std::move(v.factories), a),
+          dropUnselected(v.dropUnselected), cachedHash(v.cachedHash)
+    {
+    }
+
+    VariantForm &operator=(const VariantForm &) = default;
+    VariantForm &operator=(VariantForm &&) noexcept = default;
+
+    void invalidate() const noexcept
+    {
+        cachedHash = 0;
+    }
+
+    Form &operator[](const Atom &k)
+    {
+        invalidate();
+        return map.write()[k];
     }
 
     template <typename... Args> Form &operator[](Args &&...args)
     {
-        String string(std::forward<Args>(args)...);
-        return operator[](std::move(string));
+        const Atom atom(std::forward<Args>(args)...);
+        return operator[](atom);
     }
 
-    Map &operator*() noexcept
+    Map &operator*()
     {
-        return map;
+        invalidate();
+        return map.write();
     }
     const Map &operator*() const noexcept
     {
-        return map;
+        return map.read();
     }
 
-    Map *operator->() noexcept;
+    Map *operator->();
     const Map *operator->() const noexcept;
+
+    // Adds an alternative that is built the first time it is selected
+    void addLazy(const Atom &key, Factory);
+    bool isLazy(const Atom &key) const noexcept
+    {
+        return factories.read().find(key) != factories.read().end();
+    }
+    // False for a lazy alternative that is not built yet or was dropped
+    bool isBuilt(const Atom &key) const noexcept;
+    // Builds a lazy alternative if it is not built. Null if there is no such alternative.
+    Form *materialize(const Atom &key);
+    // Selects and builds an alternative. Null if there is no such alternative.
+    Form *select(const Atom &key);
+
+    allocator_type get_allocator() const noexcept
+    {
+        return map.get_allocator();
+    }
+};
+
+template <typename T, typename V> struct IsAlternative;
+template <typename T, typename... Ts>
+struct IsAlternative<T, std::variant<Ts...>> : std::disjunction<std::is_same<T, Ts>...>
+{
+};
+
+template <typename T, typename V> struct AlternativeIndex;
+template <typename T, typename... Ts> struct AlternativeIndex<T, std::variant<Ts...>>
+{
+    static constexpr size_t value = []() {
+        constexpr bool matches[] = {std::is_same_v<T, Ts>...};
+        for (size_t i = 0; i < sizeof...(Ts); ++i)
+        {
+            if (matches[i])
+            {
+                return i;
+            }
+        }
+        return sizeof...(Ts);
+    }();
 };
 
 struct Form
 {
+    using allocator_type = Allocator;
     using Data = std::variant<std::monostate, bool, RangedValue, String, ComplexString, StringSet, StringSelection,
                               StringMap, VariantForm, StructForm, EnableForm>;
     Data data;
 
-    Form() : data(false)
+  private:
+    std::pmr::memory_resource *resource;
+
+    template <typename T> void assign(T &&t)
+    {
+        using U = std::decay_t<T>;
+        if constexpr (IsAlternative<U, Data>::value)
+        {
+            emplace<U>(std::forward<T>(t));
+        }
+        else if constexpr (std::is_convertible_v<const U &, std::string_view>)
+        {
+            emplace<String>(std::forward<T>(t));
+        }
+        else
+        {
+            data = std::forward<T>(t);
+        }
+    }
+
+  public:
+    // Like std::get and std::get_if on the alternatives
+    template <typename T> T &get()
     {
+        return std::get<T>(data);
     }
-    Form(const Form &) = default;
-    Form(Form &&) noexcept = default;
-    template <typename... Args> Form(std::in_place_t, Args &&...args) : data(std::forward<Args>(args)...)
+    template <typename T> const T &get() const
+    {
+        return std::get<T>(data);
+    }
+    template <typename T> T *getIf()
     {
+        return std::get_if<T>(&data);
+    }
+    template <typename T> const T *getIf() const noexcept
+    {
+        return std::get_if<T>(&data);
+    }
+    template <typename T> bool holds() const noexcept
+    {
+        return std::holds_alternative<T>(data);
     }
 
-    Form &operator=(const Form &) = default;
-    Form &operator=(Form &&) noexcept = default;
+    // Like std::visit on the alternatives
+    template <typename F> decltype(auto) visit(F &&f)
+    {
+        return std::visit(std::forward<F>(f), data);
+    }
+    template <typename F> decltype(auto) visit(F &&f) const
+    {
+        return std::visit(std::forward<F>(f), data);
+    }
+
+    Form() : data(false), resource(std::pmr::get_default_resource())
+    {
+    }
+    explicit Form(const allocator_type &a) : data(false), resource(a.resource())
+    {
+    }
+    Form(const Form &f) : Form(f, allocator_type())
+    {
+    }
+    Form(Form &&) noexcept = default;
+    Form(const Form &f, const allocator_type &a) : data(std::monostate()), resource(a.resource())
+    {
+        f.visit([this](const auto &value) { assign(value); });
+    }
+    Form(Form &&f, const allocator_type &a) : data(std::monostate()), resource(a.resource())
+    {
+        if (resource == f.resource)
+        {
+            data = std::move(f.data);
+        }
+        else
+        {
+            f.visit([this](auto &value) { assign(std::move(value)); });
+        }
+    }
+    template <typename... Args>
+    Form(std::in_place_t, Args &&...args) : data(std::forward<Args>(args)...), resource(std::pmr::get_default_resource())
+    {
+    }
 
-    template <typename T> Form &operator=(const T &t)
+    // f may be a form below this one, which assigning to data destroys, so the value is taken out of it first
+    Form &operator=(const Form &f)
     {
-        data = t;
+        if (this != &f)
+        {
+            Form copy(f, get_allocator());
+            data = std::move(copy.data);
+        }
         return *this;
     }
-    template <typename T> Form &operator=(T &&t) noexcept
+    Form &operator=(Form &&f)
     {
-        data = std::move(t);
+        if (this == &f)
+        {
+            return *this;
+        }
+        Form moved(std::move(f), get_allocator());
+        data = std::move(moved.data);
         return *this;
     }
 
+    template <typename T, std::enable_if_t<!std::is_same_v<std::decay_t<T>, Form>, bool> = true>
+    Form &operator=(T &&t)
+    {
+        assign(std::forward<T>(t));
+        return *this;
+    }
+
+    // Constructs the alternative with this form's memory resource when it is allocator-aware.
+    template <typename T, typename... Args> T &emplace(Args &&...args)
+    {
+        if constexpr (std::uses_allocator_v<T, allocator_type>)
+        {
+            return data.template emplace<T>(std::forward<Args>(args)..., get_allocator());
+        }
+        else
+        {
+            return data.template emplace<T>(std::forward<Args>(args)...);
+        }
+    }
+
+    allocator_type get_allocator() const noexcept
+    {
+        return allocator_type(resource);
+    }
+
+    // Clears the cached hash of a StructForm, EnableForm or VariantForm
+    void invalidate() const noexcept
+    {
+        std::visit(
+            [](const auto &value) {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same_v<T, StructForm> || std::is_same_v<T, EnableForm> ||
+                              std::is_same_v<T, VariantForm>)
+                {
+                    value.invalidate();
+                }
+            },
+            data);
+    }
+
+    // Gives this form and every form below it its own copy of maps shared with other forms and pins them, so references
+    // taken into it stay private to it and stable, and later copies get their own maps. The backends call this (through
+    // FormTracker::track) before building widgets.
+    void unshare()
+    {
+        // An explicit stack, so deeply nested forms cannot overflow the call stack
+        std::pmr::vector<Form *> stack;
+        stack.push_back(this);
+        while (!stack.empty())
+        {
+            Form &form = *stack.back();
+            stack.pop_back();
+            form.visit([&stack](auto &value) {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same_v<T, StructForm> || std::is_same_v<T, VariantForm>)
+                {
+                    if (!value.map.read().empty())
+                    {
+                        for (auto &[_, child] : value.map.write())
+                        {
+                            stack.push_back(&child);
+                        }
+                    }
+                }
+                else if constexpr (std::is_same_v<T, EnableForm>)
+                {
+                    if (!value.map.read().empty())
+                    {
+                        for (auto &[_, pair] : value.map.write())
+                        {
+                            stack.push_back(&pair.second);
+                        }
+                    }
+                }
+            });
+        }
+    }
+
+    template <typename T> static constexpr size_t indexOf() noexcept
+    {
+        return AlternativeIndex<T, Data>::value;
+    }
+
     Data &operator*() noexcept
     {
         return data;
@@ -298,10 +643,36 @@ struct Form
     }
 };
 
+// std::visit for forms
+template <typename F> decltype(auto) visit(F &&f, Form &form)
+{
+    return form.visit(std::forward<F>(f));
+}
+template <typename F> decltype(auto) visit(F &&f, const Form &form)
+{
+    return form.visit(std::forward<F>(f));
+}
+
+class FormTracker;
+struct BoundStruct;
+class FormBatch;
+class ValidationEngine;
+struct ValidationError;
+class ComputedFields;
+class EditJournal;
+class FormTransaction;
+
 class FormExecute
 {
   protected:
     Form form;
+    // Created when the form is shown
+    std::shared_ptr<FormTracker> tracker;
+    std::shared_ptr<const ValidationEngine> validation;
+    std::shared_ptr<ComputedFields> computed;
+    // Declared after the tracker so it is detached before the tracker is destroyed
+    std::shared_ptr<EditJournal> journal;
+    std::shared_ptr<FormTransaction> transaction;
 
   public:
     FormExecute() = default;
@@ -327,6 +698,72 @@ class FormExecute
         return form;
     }
 
+    // Fields changed in the dialog. Null until the form was shown.
+    const FormTracker *getTracker() const noexcept
+    {
+        return tracker.get();
+    }
+
+    // Starts tracking changes to the form. Called by the backends before building the widgets.
+    FormTracker &track();
+
+    // Members of a struct that the backends show instead of the form (see binding.hpp)
+    virtual BoundStruct *getBinding() noexcept
+    {
+        return nullptr;
+    }
+    // Records that the backends show as a table instead of the form (see batch.hpp)
+    virtual FormBatch *getBatch() noexcept
+    {
+        return nullptr;
+    }
+
+    // Checks that must pass before ok() is called (see validation.hpp). The backends keep the dialog open and
+    // highlight the failing fields until they do.
+    void setValidation(std::shared_ptr<const ValidationEngine> v) noexcept
+    {
+        validation = std::move(v);
+    }
+    const ValidationEngine *getValidation() const noexcept
+    {
+        return validation.get();
+    }
+    // Empty if there is no validation or the form passes it
+    std::pmr::vector<ValidationError> validate() const;
+
+    // Fields computed from other fields (see computed.hpp). They are brought up to date when the form is tracked and
+    // the backends update the readers of every edit and refresh the widgets of the targets that changed.
+    void setComputed(std::shared_ptr<ComputedFields> c) noexcept
+    {
+        computed = std::move(c);
+    }
+    ComputedFields *getComputed() noexcept
+    {
+        return computed.get();
+    }
+
+    // Undo and redo of the edits in the dialog (see journal.hpp). The backends attach it to the tracker when the form
+    // is shown and add undo and redo buttons.
+    void setJournal(std::shared_ptr<EditJournal> j) noexcept
+    {
+        journal = std::move(j);
+    }
+    EditJournal *getJournal() noexcept
+    {
+        return journal.get();
+    }
+
+    // In transaction mode the edits made in the dialog are rolled back when it is canceled or closed, at a cost that
+    // depends on what was edited and not on the size of the form (see FormTransaction).
+    void setTransactional(bool);
+    bool isTransactional() const noexcept
+    {
+        return transaction != nullptr;
+    }
+    // Called by the backends before ok() and cancel()
+    void commit();
+    void rollback();
+
     static void execute(std::string_view, const std::shared_ptr<FormExecute> &, void *parent = nullptr);
 
     template <typename T, std::enable_if_t<std::is_base_of<FormExecute, T>::value, bool> = true>
@@ -413,39 +850,131 @@ template <typename... Args> inline StructForm StructForm::create(Args &&...args)
     return create(std::move(structForm), std::forward<Args>(args)...);
 }
 
+template <typename... Args>
+inline StructForm StructForm::create(std::allocator_arg_t, const allocator_type &a, Args &&...args)
+{
+    StructForm structForm(a);
+    return create(std::move(structForm), std::forward<Args>(args)...);
+}
+
 inline StructForm StructForm::create(StructForm &&structForm) noexcept
 {
     return std::move(structForm);
 }
 
-inline StructForm::Map *StructForm::operator->() noexcept
+inline StructForm::Map *StructForm::operator->()
 {
-    return &map;
+    invalidate();
+    return &map.write();
 }
 
 inline const StructForm::Map *StructForm::operator->() const noexcept
 {
-    return &map;
+    return &map.read();
+}
+
+inline EnableForm::Map EnableForm::Clone::operator()(const Map &from, const allocator_type &a) const
+{
+    Map map(a);
+    for (const auto &[key, value] : from)
+    {
+        map.try_emplace(key, value.first, Form(value.second, a));
+    }
+    return map;
+}
+
+inline EnableForm::EnableForm(const EnableForm &e, const allocator_type &a) : map(e.map, a), cachedHash(e.cachedHash)
+{
+}
+
+inline EnableForm::EnableForm(EnableForm &&e, const allocator_type &a)
+    : map(std::move(e.map), a), cachedHash(e.cachedHash)
+{
+}
+
+// Nested pairs are not constructed with the map's allocator in C++17 so the form is built here
+inline EnableForm::Value &EnableForm::operator[](const Atom &k)
+{
+    invalidate();
+    return map.write().try_emplace(k, false, Form(get_allocator())).first->second;
 }
 
-inline EnableForm::Map *EnableForm::operator->() noexcept
+inline EnableForm::Map *EnableForm::operator->()
 {
-    return &map;
+    invalidate();
+    return &map.write();
 }
 
 inline const EnableForm::Map *EnableForm::operator->() const noexcept
 {
-    return &map;
+    return &map.read();
 }
 
-inline VariantForm::Map *VariantForm::operator->() noexcept
+inline VariantForm::Map *VariantForm::operator->()
 {
-    return &map;
+    invalidate();
+    return &map.write();
 }
 
 inline const VariantForm::Map *VariantForm::operator->() const noexcept
 {
-    return &map;
+    return &map.read();
+}
+
+inline void VariantForm::addLazy(const Atom &key, Factory factory)
+{
+    invalidate();
+    map.write()[key] = Form(std::in_place, std::monostate());
+    factories.write()[key] = std::move(factory);
+}
+
+inline bool VariantForm::isBuilt(const Atom &key) const noexcept
+{
+    const Map &m = map.read();
+    auto iter = m.find(key);
+    return iter != m.end() && !(iter->second.holds<std::monostate>() && isLazy(key));
+}
+
+inline Form *VariantForm::materialize(const Atom &key)
+{
+    if (map.read().find(key) == map.read().end())
+    {
+        return nullptr;
+    }
+    // Written even if it is built so the returned form is not shared with copies
+    Form &form = map.write().find(key)->second;
+    if (form.holds<std::monostate>())
+    {
+        auto iter = factories.read().find(key);
+        if (iter != factories.read().end())
+        {
+            invalidate();
+            form = iter->second();
+        }
+    }
+    return &form;
+}
+
+inline Form *VariantForm::select(const Atom &key)
+{
+    Form *form = materialize(key);
+    if (form == nullptr)
+    {
+        return nullptr;
+    }
+    const Atom previous(selected);
+    if (dropUnselected && key != previous && isLazy(previous))
+    {
+        Map &m = map.write();
+        auto iter = m.find(previous);
+        if (iter != m.end())
+        {
+            iter->second = Form(std::in_place, std::monostate());
+        }
+    }
+    invalidate();
+    selected = key.view();
+    return form;
 }
 
 } // namespace CanForm
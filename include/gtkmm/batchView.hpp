@@ -0,0 +1,37 @@
+#pragma once
+
+#include <batch.hpp>
+#include <functional>
+#include <gtkmm.h>
+
+namespace CanForm
+{
+// Editable table of a FormBatch. Only one page of rows has widgets; changing the page loads other records into them.
+class BatchView : public Gtk::VBox
+{
+  private:
+    FormBatch &batch;
+    size_t first;
+    // Set while the widgets are loaded so their signals do not write back
+    bool loading;
+
+    Gtk::Grid grid;
+    Gtk::HBox navigation;
+    Gtk::Button previousButton, nextButton;
+    Gtk::Label pageLabel;
+
+    // Loads a record into each widget of the page
+    std::vector<std::function<void()>> loaders;
+
+    Gtk::Widget *makeCell(size_t column, size_t row);
+    void showPage(size_t first);
+
+  public:
+    static constexpr size_t PageSize = 25;
+
+    explicit BatchView(FormBatch &);
+    virtual ~BatchView()
+    {
+    }
+};
+} // namespace CanForm
@@ -2,19 +2,79 @@
 
 #include <gtkmm/gtkmm.hpp>
 #include <gtkmm/window.hpp>
+#include <journal.hpp>
+#include <tracker.hpp>
+#include <validation.hpp>
+#include <walker.hpp>
+
+#include <unordered_map>
 
 namespace CanForm
 {
+// Widget made for each form, so validation errors and computed values can be shown on them
+struct FormWidget
+{
+    // Holds the widget of the form so it can be replaced
+    Gtk::Box *holder;
+    std::string_view name;
+};
+using FormWidgets = std::unordered_map<const Form *, FormWidget>;
+
 class FormVisitor
 {
   private:
+    // A form inside a VariantForm or EnableForm whose widget show() makes after the current walk
+    struct Pending
+    {
+        Form *form;
+        std::string_view name;
+        std::function<void(Gtk::Widget *)> place;
+    };
+
     std::string_view name;
+    FormTracker *tracker;
+    std::shared_ptr<FormWidgets> widgets;
+    // Set while show() runs
+    std::vector<Pending> *pending;
 
     Gtk::Frame *makeFrame() const;
+    // Null if the form has no name
+    Gtk::Expander *makeExpander() const;
+    static Gtk::Grid *makeGrid();
+    // The widget inside the expander if there is one
+    static Gtk::Widget *expand(Gtk::Expander *, Gtk::Widget &);
+    // Puts the widget of a form in a holder and remembers it
+    Gtk::Widget *hold(Form &, std::string_view formName, Gtk::Widget *);
+    // Walks a form and makes its widget. Forms inside a VariantForm or EnableForm are left in pending.
+    Gtk::Widget *build(Form &, MutableFormWalker &);
+    // Makes the widget of a form inside another one and gives it to place, after the current walk if show() runs, so
+    // nested forms do not recurse
+    void showInside(Form &, std::string_view formName, std::function<void(Gtk::Widget *)> place);
+    // Forgets the forms whose widgets are inside the widget
+    static void forgetInside(FormWidgets &, Gtk::Widget &);
 
     template <typename B> void addSyncFile(Gtk::Box &box, B buffer) const;
 
+    template <typename S> Gtk::Widget *text(S &);
+    // An entry that keeps the exact digits of a number. R is a Range<T> pointer or a BoundRange<T>, which already
+    // points to its value. Edits of a Range are reported to the tracker.
+    template <typename R> static Gtk::Entry *numberEntry(R, FormTracker *);
+    // A StringSelection whose options come from a provider
+    Gtk::Widget *optionPicker(StringSelection &);
+    template <typename Set> Gtk::Widget *editableSet(Set &);
+
   public:
+    // Options of a provider shown at a time
+    static constexpr size_t PickerRows = 10;
+
+    explicit FormVisitor(FormTracker *t = nullptr, std::shared_ptr<FormWidgets> w = nullptr) noexcept
+        : name(), tracker(t), widgets(std::move(w)), pending(nullptr)
+    {
+    }
+
+    // Makes the widget for a form and remembers it
+    Gtk::Widget *show(Form &);
+
     Gtk::Widget *operator()(std::monostate &);
     Gtk::Widget *operator()(bool &);
 
@@ -32,27 +92,103 @@ class FormVisitor
     Gtk::Widget *operator()(StructForm &);
     Gtk::Widget *operator()(EnableForm &);
 
+    template <typename T> Gtk::Widget *operator()(BoundRange<T> &);
+    Gtk::Widget *operator()(BoundNumber &);
+    Gtk::Widget *operator()(std::string &);
+    Gtk::Widget *operator()(std::set<std::string> &);
+    Gtk::Widget *operator()(BoundStruct &);
+
     Gtk::TextView *makeTextView();
+
+    // Marks the widgets of the failing forms and clears the marks of the others
+    static void highlight(const FormWidgets &, const std::pmr::vector<ValidationError> &);
+    // Rebuilds the widget of a form that was changed outside of its widget
+    static void refresh(const std::shared_ptr<FormWidgets> &, FormTracker *, Form &);
 };
 
+template <typename R> Gtk::Entry *FormVisitor::numberEntry(R range, FormTracker *tracker)
+{
+    Gtk::Entry *entry = Gtk::make_managed<Gtk::Entry>();
+    entry->set_input_purpose(Gtk::INPUT_PURPOSE_NUMBER);
+
+    auto target = [range]() mutable -> auto & {
+        if constexpr (std::is_pointer_v<R>)
+        {
+            return *range;
+        }
+        else
+        {
+            return range;
+        }
+    };
+    // Shows the clamped value once an edit is done
+    auto show = [entry, target]() mutable {
+        char buffer[NumberChars];
+        char *end = target().toChars(buffer, buffer + sizeof(buffer));
+        const Glib::ustring text(buffer, end == nullptr ? buffer : end);
+        if (entry->get_text() != text)
+        {
+            entry->set_text(text);
+        }
+    };
+    show();
+
+    // Partial text such as "-" does not change the value and is not reported
+    entry->signal_changed().connect([entry, target, tracker]() mutable {
+        const Glib::ustring text = entry->get_text();
+        if (target().parseChars(text.raw()))
+        {
+            prepareForm(tracker, &target());
+            target().setFromChars(text.raw());
+            touchForm(tracker, &target());
+        }
+    });
+    entry->signal_activate().connect(show);
+    entry->signal_focus_out_event().connect([show](GdkEventFocus *) mutable {
+        show();
+        return false;
+    });
+    entry->signal_key_press_event().connect(
+        [target, show, tracker](GdkEventKey *event) mutable {
+            int steps = 0;
+            switch (event->keyval)
+            {
+            case GDK_KEY_Up:
+                steps = 1;
+                break;
+            case GDK_KEY_Down:
+                steps = -1;
+                break;
+            case GDK_KEY_Page_Up:
+                steps = 10;
+                break;
+            case GDK_KEY_Page_Down:
+                steps = -10;
+                break;
+            default:
+                return false;
+            }
+            prepareForm(tracker, &target());
+            target().step(steps);
+            touchForm(tracker, &target());
+            show();
+            return true;
+        },
+        false);
+    return entry;
+}
+
 template <typename T> Gtk::Widget *FormVisitor::operator()(Range<T> &value)
 {
     auto frame = makeFrame();
-    Gtk::SpinButton *button = Gtk::make_managed<Gtk::SpinButton>();
-
-    const auto [min, max] = value.getMinMax();
-    button->set_range(min, max);
-    if constexpr (std::is_floating_point_v<T>)
-    {
-        button->set_digits(6);
-    }
-    button->set_value(*value);
-
-    button->set_increments(1, 10);
-
-    button->signal_value_changed().connect([button, &value]() { value = static_cast<T>(button->get_value()); });
+    frame->add(*numberEntry(&value, tracker));
+    return frame;
+}
 
-    frame->add(*button);
+template <typename T> Gtk::Widget *FormVisitor::operator()(BoundRange<T> &range)
+{
+    auto frame = makeFrame();
+    frame->add(*numberEntry(range, nullptr));
     return frame;
 }
 
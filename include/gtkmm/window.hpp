@@ -36,8 +36,20 @@ static inline size_t makeButtons(Gtk::Window *window, Gtk::HBox *box, size_t cou
 {
     Gtk::Button *button = Gtk::make_managed<Gtk::Button>(icon);
     button->signal_clicked().connect([window, func = std::move(func)]() {
-        window->hide();
-        func();
+        // A function that returns false keeps the window open
+        if constexpr (std::is_same_v<std::invoke_result_t<F>, bool>)
+        {
+            if (!func())
+            {
+                return;
+            }
+            window->hide();
+        }
+        else
+        {
+            window->hide();
+            func();
+        }
         delete window;
     });
     box->pack_start(*button, Gtk::PACK_EXPAND_PADDING);
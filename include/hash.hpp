@@ -0,0 +1,21 @@
+#pragma once
+
+#include "form.hpp"
+
+namespace CanForm
+{
+using FormHash = uint64_t;
+
+// Structural hash of a form. Field order, keys, values, range bounds, selections and flags all take part. Walks the
+// whole form; cached hashes are neither read nor stored, so writes through references kept from earlier are seen.
+extern FormHash hashForm(const Form &);
+
+// The same hash, but StructForm, EnableForm and VariantForm keep the hash of their subtree until they are accessed for
+// writing or touched through a FormTracker, so hashing an unchanged form again only visits the root. A write through a
+// reference kept from before the hash leaves it stale, so this is only correct when every such write is touched; use
+// FormTracker::hash().
+extern FormHash hashCached(const Form &);
+
+// Walks both forms. Maps shared by copies are compared by address; cached hashes are not used.
+extern bool equal(const Form &, const Form &);
+} // namespace CanForm
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "flat_map.hpp"
+#include "types.hpp"
+
+#include <initializer_list>
+#include <string_view>
+
+namespace CanForm
+{
+// Set of strings kept in insertion order with O(1) access by position and a hashed reverse index from value to
+// position. Erasing is O(n) since the positions after the erased value shift down.
+class IndexedStringSet
+{
+  public:
+    using value_type = String;
+    using allocator_type = Allocator;
+    using Values = std::pmr::vector<String>;
+    using iterator = Values::const_iterator;
+    using const_iterator = Values::const_iterator;
+    using size_type = size_t;
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+  private:
+    Values values;
+    HashIndex index;
+
+    uint32_t locate(std::string_view s, uint32_t hash) const
+    {
+        return index.find(hash, [this, s](uint32_t i) { return std::string_view(values[i]) == s; });
+    }
+
+    void reindex()
+    {
+        index.clear();
+        index.reserve(values.size());
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            index.insert(static_cast<uint32_t>(i), hashKey(values[i]));
+        }
+    }
+
+  public:
+    IndexedStringSet() : values(), index()
+    {
+    }
+    explicit IndexedStringSet(const allocator_type &a) : values(a), index(a)
+    {
+    }
+    template <typename Iter>
+    IndexedStringSet(Iter first, Iter last, const allocator_type &a = allocator_type()) : values(a), index(a)
+    {
+        for (; first != last; ++first)
+        {
+            emplace(*first);
+        }
+    }
+    IndexedStringSet(std::initializer_list<std::string_view> list, const allocator_type &a = allocator_type())
+        : IndexedStringSet(list.begin(), list.end(), a)
+    {
+    }
+    explicit IndexedStringSet(const StringSet &set) : IndexedStringSet(set.begin(), set.end(), set.get_allocator())
+    {
+    }
+    IndexedStringSet(const StringSet &set, const allocator_type &a) : IndexedStringSet(set.begin(), set.end(), a)
+    {
+    }
+    IndexedStringSet(const IndexedStringSet &) = default;
+    IndexedStringSet(IndexedStringSet &&) noexcept = default;
+    IndexedStringSet(const IndexedStringSet &s, const allocator_type &a) : values(s.values, a), index(s.index, a)
+    {
+    }
+    IndexedStringSet(IndexedStringSet &&s, const allocator_type &a)
+        : values(std::move(s.values), a), index(std::move(s.index), a)
+    {
+    }
+
+    IndexedStringSet &operator=(const IndexedStringSet &) = default;
+    IndexedStringSet &operator=(IndexedStringSet &&) noexcept = default;
+
+    allocator_type get_allocator() const noexcept
+    {
+        return values.get_allocator();
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return values.begin();
+    }
+    const_iterator end() const noexcept
+    {
+        return values.end();
+    }
+
+    size_t size() const noexcept
+    {
+        return values.size();
+    }
+    bool empty() const noexcept
+    {
+        return values.empty();
+    }
+    size_t capacity() const noexcept
+    {
+        return values.capacity();
+    }
+    const HashIndex &getIndex() const noexcept
+    {
+        return index;
+    }
+
+    const String &operator[](size_t i) const noexcept
+    {
+        return values[i];
+    }
+
+    size_t indexOf(std::string_view s) const
+    {
+        const uint32_t i = locate(s, hashKey(s));
+        return i == HashIndex::npos ? npos : i;
+    }
+
+    const_iterator find(std::string_view s) const
+    {
+        const size_t i = indexOf(s);
+        return i == npos ? end() : begin() + i;
+    }
+
+    size_t count(std::string_view s) const
+    {
+        return indexOf(s) == npos ? 0 : 1;
+    }
+    bool contains(std::string_view s) const
+    {
+        return indexOf(s) != npos;
+    }
+
+    template <typename... Args> std::pair<const_iterator, bool> emplace(Args &&...args)
+    {
+        String s(std::forward<Args>(args)..., values.get_allocator());
+        return insert(std::move(s));
+    }
+
+    std::pair<const_iterator, bool> insert(String &&s)
+    {
+        const uint32_t hash = hashKey(s);
+        const uint32_t i = locate(s, hash);
+        if (i != HashIndex::npos)
+        {
+            return std::make_pair(begin() + i, false);
+        }
+        values.emplace_back(std::move(s));
+        index.insert(static_cast<uint32_t>(values.size() - 1), hash);
+        return std::make_pair(end() - 1, true);
+    }
+    std::pair<const_iterator, bool> insert(const String &s)
+    {
+        return emplace(s);
+    }
+
+    const_iterator erase(const_iterator iter)
+    {
+        auto result = values.erase(iter);
+        reindex();
+        return result;
+    }
+
+    size_t erase(std::string_view s)
+    {
+        const size_t i = indexOf(s);
+        if (i == npos)
+        {
+            return 0;
+        }
+        erase(begin() + i);
+        return 1;
+    }
+
+    void reserve(size_t n)
+    {
+        values.reserve(n);
+        index.reserve(n);
+    }
+
+    void clear() noexcept
+    {
+        values.clear();
+        index.clear();
+    }
+};
+} // namespace CanForm
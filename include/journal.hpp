@@ -0,0 +1,163 @@
+#pragma once
+
+#include "form.hpp"
+#include "patch.hpp"
+
+#include <set>
+
+namespace CanForm
+{
+class FormTracker;
+
+// Undo and redo for the edits made in the widgets of the backends. The journal listens to a tracker: the backends
+// call FormTracker::prepare() before an edit and touch() after it, and the journal keeps the edit as a pair of patch
+// operations, one that undoes it and one that redoes it. Only the edited value is copied, never the whole form.
+//
+// Edits are kept in a ring of fixed capacity that drops the oldest edit when it is full. Consecutive edits of the same
+// String or ComplexString are merged into one until seal() is called, so typing a word is undone at once. Changes
+// that were not prepared, such as the targets of computed fields, are not recorded.
+class EditJournal
+{
+  public:
+    using allocator_type = Allocator;
+
+  private:
+    struct Edit
+    {
+        PatchOperation undo;
+        PatchOperation redo;
+        bool text;
+    };
+
+    // Value of the prepared form before the edit
+    struct Pending
+    {
+        const Form *form;
+        // Leaves are copied
+        Form value;
+        // Only the selected alternative of a VariantForm
+        Atom selected;
+        // Only the flags of an EnableForm
+        std::pmr::vector<std::pair<Atom, bool>> flags;
+    };
+
+    std::pmr::vector<Edit> ring;
+    size_t capacity;
+    // Position of the oldest edit in the ring
+    size_t first;
+    size_t count;
+    // Edits that are applied. The ones after them can be redone.
+    size_t applied;
+    Pending pending;
+    FormTracker *tracker;
+    size_t preparer;
+    size_t listener;
+    bool replaying;
+    bool sealed;
+
+    Edit &at(size_t i) noexcept
+    {
+        return ring[(first + i) % capacity];
+    }
+
+    void prepare(const FormPath &, const Form &);
+    void record(const FormPath &, const Form &);
+    void push(Edit &&);
+    Form *replay(const PatchOperation &);
+
+  public:
+    explicit EditJournal(size_t capacity = 256, const allocator_type & = allocator_type());
+    EditJournal(const EditJournal &) = delete;
+    ~EditJournal();
+
+    EditJournal &operator=(const EditJournal &) = delete;
+
+    // Records the edits of the form tracked by the tracker until detach()
+    void attach(FormTracker &);
+    void detach();
+
+    bool canUndo() const noexcept
+    {
+        return applied > 0;
+    }
+    bool canRedo() const noexcept
+    {
+        return applied < count;
+    }
+
+    // Undoes the last applied edit in the form of the tracker and touches it. Returns the form that changed so the
+    // backends can refresh its widget, or null if the journal is not attached, there is nothing to undo or the edit
+    // no longer matches the form.
+    Form *undo();
+    Form *redo();
+
+    // The next edit is not merged with the last one
+    void seal() noexcept
+    {
+        sealed = true;
+    }
+    void clear() noexcept;
+
+    size_t size() const noexcept
+    {
+        return count;
+    }
+    size_t getCapacity() const noexcept
+    {
+        return capacity;
+    }
+
+    allocator_type get_allocator() const noexcept
+    {
+        return ring.get_allocator();
+    }
+};
+
+// Rolls a form back to the state it had when the transaction began, e.g. when its dialog is canceled. Like
+// EditJournal it listens to the prepare() calls of a tracker, but it keeps only the value from before the first edit
+// of every form, so a rollback costs as much as the edited values and not the whole form.
+class FormTransaction
+{
+  public:
+    using allocator_type = Allocator;
+
+  private:
+    // Operations that restore the edited forms in the order they were first edited
+    std::pmr::vector<PatchOperation> operations;
+    std::pmr::set<FormPath> edited;
+    FormTracker *tracker;
+    size_t preparer;
+
+    void prepare(const FormPath &, const Form &);
+
+  public:
+    explicit FormTransaction(const allocator_type & = allocator_type());
+    FormTransaction(const FormTransaction &) = delete;
+    ~FormTransaction();
+
+    FormTransaction &operator=(const FormTransaction &) = delete;
+
+    // Starts recording the edits of the form tracked by the tracker. Edits from before are forgotten.
+    void begin(FormTracker &);
+    // Keeps the edits and stops recording
+    void commit() noexcept;
+    // Restores every edited form, touching it in the tracker, and stops recording. Returns the number of values that
+    // were restored.
+    size_t rollback();
+
+    bool active() const noexcept
+    {
+        return tracker != nullptr;
+    }
+    // Values kept for a rollback
+    size_t size() const noexcept
+    {
+        return operations.size();
+    }
+
+    allocator_type get_allocator() const noexcept
+    {
+        return operations.get_allocator();
+    }
+};
+} // namespace CanForm
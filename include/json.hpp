@@ -0,0 +1,192 @@
+#pragma once
+
+#include "form.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+namespace CanForm
+{
+// Buffered, streaming JSON writer. Output goes to a file descriptor or a String in chunks of at most BufferSize
+// bytes so memory use does not grow with the size of the document. Commas are inserted automatically.
+class JsonWriter
+{
+  public:
+    static constexpr size_t BufferSize = 1 << 16;
+
+  private:
+    int fd;
+    String *string;
+    size_t used;
+    bool failed;
+    // One byte per open object or array. Set once the first value of the container was written.
+    std::pmr::vector<char> first;
+    bool afterKey;
+    char buffer[BufferSize];
+
+    void put(std::string_view);
+    void put(char c)
+    {
+        if (used == BufferSize)
+        {
+            flush();
+        }
+        buffer[used++] = c;
+    }
+    void separate();
+    void quoted(std::string_view);
+
+  public:
+    explicit JsonWriter(int fd);
+    explicit JsonWriter(String &);
+    JsonWriter(const JsonWriter &) = delete;
+    ~JsonWriter();
+
+    JsonWriter &operator=(const JsonWriter &) = delete;
+
+    // False once writing to the file descriptor failed
+    constexpr bool ok() const noexcept
+    {
+        return !failed;
+    }
+    bool flush();
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    void key(std::string_view);
+
+    void null();
+    void value(bool);
+    void value(std::string_view);
+    void value(const char *s)
+    {
+        value(std::string_view(s));
+    }
+
+    // Shortest text that reads back to the same value. Infinity and NaN are written as strings.
+    template <typename T, std::enable_if_t<std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, bool> = true>
+    void value(T t)
+    {
+        char text[64];
+        const auto result = std::to_chars(text, text + sizeof(text), t);
+        const std::string_view s(text, result.ptr - text);
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            if (!std::isfinite(t))
+            {
+                value(s);
+                return;
+            }
+        }
+        separate();
+        put(s);
+    }
+};
+
+// Pull parser for JSON. Input is read from a file descriptor in chunks of BufferSize bytes or from a string view.
+// Only the text of the current token is kept.
+class JsonReader
+{
+  public:
+    static constexpr size_t BufferSize = 1 << 16;
+
+    enum class Token
+    {
+        BeginObject,
+        EndObject,
+        BeginArray,
+        EndArray,
+        Key,
+        String,
+        Number,
+        True,
+        False,
+        Null,
+        End,
+        Error
+    };
+
+  private:
+    struct Level
+    {
+        char state;
+        bool object;
+    };
+
+    int fd;
+    const char *data;
+    size_t size;
+    size_t position;
+    size_t line;
+    CanForm::String token;
+    // The first level is the document itself
+    std::pmr::vector<Level> levels;
+    const char *error;
+    char buffer[BufferSize];
+
+    bool fill();
+    int peek();
+    int get();
+    bool skipSpace();
+    bool literal(std::string_view);
+    bool readString();
+    bool readNumber();
+
+  public:
+    explicit JsonReader(int fd);
+    explicit JsonReader(std::string_view);
+    JsonReader(const JsonReader &) = delete;
+
+    JsonReader &operator=(const JsonReader &) = delete;
+
+    Token next();
+
+    // Unescaped text of the last Key or String token or the text of the last Number token
+    std::string_view text() const noexcept
+    {
+        return token;
+    }
+
+    // Stops parsing. Used by callers to report values that are valid JSON but not what they expected.
+    Token fail(const char *);
+
+    // Set after next() returned Token::Error
+    const char *getError() const noexcept
+    {
+        return error;
+    }
+    size_t getLine() const noexcept
+    {
+        return line;
+    }
+
+    // Skips the rest of a value whose first token was just read
+    bool skip(Token);
+
+    template <typename T> std::optional<T> number() const noexcept
+    {
+        const std::string_view s = token;
+        T t;
+        const auto result = std::from_chars(s.data(), s.data() + s.size(), t);
+        if (result.ec != std::errc() || result.ptr != s.data() + s.size())
+        {
+            return std::nullopt;
+        }
+        return t;
+    }
+};
+
+// JSON for a Form. Every alternative except null, bool and String is an object whose first key names the
+// alternative, for example {"range": "int32", "value": 5, "min": 0, "max": 10} or
+// {"struct": 2, "fields": {...}}. Ranges keep their exact type and bounds.
+extern void writeJson(const Form &, JsonWriter &);
+extern std::optional<Form> readJson(JsonReader &, const Allocator & = Allocator());
+
+extern bool saveJson(const Form &, const char *path);
+extern std::optional<Form> loadJson(const char *path, const Allocator & = Allocator());
+} // namespace CanForm
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+namespace CanForm
+{
+// Longest text formatNumber writes for any arithmetic type
+constexpr size_t NumberChars = 32;
+
+// Parses all of the text, apart from surrounding spaces and a leading '+', as a T clamped to min and max. Integers
+// are parsed exactly, and integers beyond the limits of T clamp as well. Null if the text is not a number.
+template <typename T> std::optional<T> parseNumber(std::string_view text, T min, T max) noexcept
+{
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>);
+    while (!text.empty() && text.front() == ' ')
+    {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && text.back() == ' ')
+    {
+        text.remove_suffix(1);
+    }
+    if (text.size() > 1 && text.front() == '+' && text[1] != '-')
+    {
+        text.remove_prefix(1);
+    }
+    if (text.empty())
+    {
+        return std::nullopt;
+    }
+    const char *first = text.data();
+    const char *last = first + text.size();
+    const bool negative = text.front() == '-';
+
+    T t{};
+    if constexpr (std::is_integral_v<T>)
+    {
+        auto [ptr, ec] = std::from_chars(first, last, t);
+        if (ec == std::errc::result_out_of_range && ptr == last)
+        {
+            return negative ? min : max;
+        }
+        if constexpr (std::is_unsigned_v<T>)
+        {
+            // from_chars takes no sign for unsigned types; any negative number is below the range
+            if (ec == std::errc::invalid_argument && negative && text.size() > 1)
+            {
+                T magnitude{};
+                auto [end, error] = std::from_chars(first + 1, last, magnitude);
+                if (end == last && error != std::errc::invalid_argument)
+                {
+                    return min;
+                }
+            }
+        }
+        if (ec != std::errc() || ptr != last)
+        {
+            return std::nullopt;
+        }
+    }
+    else
+    {
+#if defined(__cpp_lib_to_chars)
+        auto [ptr, ec] = std::from_chars(first, last, t);
+        if (ptr != last || (ec != std::errc() && ec != std::errc::result_out_of_range))
+        {
+            return std::nullopt;
+        }
+        if (ec == std::errc::result_out_of_range)
+#endif
+        {
+            // strtod needs a terminated string and returns a huge or zero value out of range
+            char buffer[NumberChars * 2];
+            if (text.size() >= sizeof(buffer))
+            {
+                return std::nullopt;
+            }
+            std::copy(first, last, buffer);
+            buffer[text.size()] = '\0';
+            char *end = nullptr;
+            const long double d = std::strtold(buffer, &end);
+            if (end != buffer + text.size())
+            {
+                return std::nullopt;
+            }
+            t = d > std::numeric_limits<T>::max()       ? std::numeric_limits<T>::infinity()
+                : d < std::numeric_limits<T>::lowest() ? -std::numeric_limits<T>::infinity()
+                                                         : static_cast<T>(d);
+        }
+        if (std::isnan(t))
+        {
+            return std::nullopt;
+        }
+    }
+    return std::clamp(t, min, max);
+}
+
+// Writes t without a terminator and returns the end, or null if it does not fit. Integers are exact and floating
+// point values read back as the same value.
+template <typename T> char *formatNumber(char *first, char *last, T t) noexcept
+{
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>);
+#if !defined(__cpp_lib_to_chars)
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        const int n = std::snprintf(first, last - first, "%.*g", std::numeric_limits<T>::max_digits10,
+                                    static_cast<double>(t));
+        return n < 0 || n >= last - first ? nullptr : first + n;
+    }
+    else
+#endif
+    {
+        auto [ptr, ec] = std::to_chars(first, last, t);
+        return ec == std::errc() ? ptr : nullptr;
+    }
+}
+
+// Converts u to T clamped to min and max. Integers convert exactly, floating point values round to the nearest integer
+// for integral T, and values beyond the limits of T clamp instead of overflowing. Null for NaN.
+template <typename T, typename U> std::optional<T> convertNumber(U u, T min, T max) noexcept
+{
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>);
+    static_assert(std::is_arithmetic_v<U>);
+    if constexpr (std::is_floating_point_v<U>)
+    {
+        if (std::isnan(u))
+        {
+            return std::nullopt;
+        }
+    }
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        return std::clamp(static_cast<T>(std::clamp(static_cast<long double>(u), static_cast<long double>(min),
+                                                    static_cast<long double>(max))),
+                          min, max);
+    }
+    else if constexpr (std::is_floating_point_v<U>)
+    {
+        // The limits of T are powers of two or one less, so the comparisons are exact or round outwards
+        const long double rounded = std::round(static_cast<long double>(u));
+        if (rounded <= static_cast<long double>(min))
+        {
+            return min;
+        }
+        if (rounded >= static_cast<long double>(max))
+        {
+            return max;
+        }
+        return static_cast<T>(rounded);
+    }
+    else
+    {
+        // Compared in intmax_t below zero and in uintmax_t above it, where both types fit
+        if constexpr (std::is_signed_v<U>)
+        {
+            if (u < 0)
+            {
+                if constexpr (std::is_unsigned_v<T>)
+                {
+                    return min;
+                }
+                else
+                {
+                    const intmax_t v = u;
+                    return static_cast<T>(std::clamp(v, static_cast<intmax_t>(min), static_cast<intmax_t>(max)));
+                }
+            }
+        }
+        const uintmax_t v = static_cast<uintmax_t>(u);
+        if constexpr (std::is_signed_v<T>)
+        {
+            if (max < 0)
+            {
+                return max;
+            }
+        }
+        if (min > 0 && v < static_cast<uintmax_t>(min))
+        {
+            return min;
+        }
+        return v > static_cast<uintmax_t>(max) ? max : static_cast<T>(v);
+    }
+}
+
+// Moves t by steps of one without overflowing, then clamps it to min and max
+template <typename T> T stepNumber(T t, int steps, T min, T max) noexcept
+{
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>);
+    if constexpr (std::is_integral_v<T>)
+    {
+        // Distances to the limits of T and the moves themselves are exact in the unsigned type
+        using U = std::make_unsigned_t<T>;
+        const uintmax_t distance = steps < 0 ? 0u - static_cast<uintmax_t>(steps) : static_cast<uintmax_t>(steps);
+        const U from = static_cast<U>(t);
+        T moved = t;
+        if (steps > 0)
+        {
+            const uintmax_t room = static_cast<U>(static_cast<U>(std::numeric_limits<T>::max()) - from);
+            moved = distance > room ? std::numeric_limits<T>::max() : static_cast<T>(static_cast<U>(from + distance));
+        }
+        else if (steps < 0)
+        {
+            const uintmax_t room = static_cast<U>(from - static_cast<U>(std::numeric_limits<T>::lowest()));
+            moved =
+                distance > room ? std::numeric_limits<T>::lowest() : static_cast<T>(static_cast<U>(from - distance));
+        }
+        return std::clamp(moved, min, max);
+    }
+    else
+    {
+        return std::clamp(static_cast<T>(t + steps), min, max);
+    }
+}
+} // namespace CanForm
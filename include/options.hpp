@@ -0,0 +1,89 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <optional>
+#include <string_view>
+
+namespace CanForm
+{
+// Options of a StringSelection that are too many to keep in the form. Backends only fetch the options they show, so
+// a provider can hold them in any compact form or read them on demand. Positions must not change while a provider is
+// in use.
+class OptionProvider
+{
+  public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    virtual ~OptionProvider() = default;
+
+    virtual size_t size() const noexcept = 0;
+    // The view stays valid as long as the provider
+    virtual std::string_view at(size_t) const = 0;
+    // npos if the value is not an option
+    virtual size_t indexOf(std::string_view) const = 0;
+    // First position at or after from whose option starts with prefix, npos if there is none. Scans by default.
+    virtual size_t find(std::string_view prefix, size_t from = 0) const;
+
+    // Appends up to count options from first
+    void fetch(size_t first, size_t count, std::pmr::vector<std::string_view> &) const;
+};
+
+// Sorted options without duplicates, stored in one buffer. Lookups and prefix searches are binary searches, so all
+// options that start with a prefix are next to each other.
+class OptionList final : public OptionProvider
+{
+  public:
+    using allocator_type = Allocator;
+
+  private:
+    struct Entry
+    {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    String buffer;
+    std::pmr::vector<Entry> entries;
+
+    std::string_view view(const Entry &e) const noexcept
+    {
+        return std::string_view(buffer.data() + e.offset, e.size);
+    }
+    size_t lowerBound(std::string_view) const noexcept;
+    void index();
+
+  public:
+    // One option per line. Empty lines are skipped.
+    explicit OptionList(String &&lines, const allocator_type & = allocator_type());
+    template <typename Iter>
+    OptionList(Iter first, Iter last, const allocator_type &a = allocator_type()) : buffer(a), entries(a)
+    {
+        for (; first != last; ++first)
+        {
+            buffer.append(std::string_view(*first));
+            buffer.push_back('\n');
+        }
+        index();
+    }
+
+    // Null if the file cannot be read or is larger than 4 GiB
+    static std::optional<OptionList> load(const char *path, const allocator_type & = allocator_type());
+
+    size_t size() const noexcept override
+    {
+        return entries.size();
+    }
+    std::string_view at(size_t i) const override
+    {
+        return view(entries[i]);
+    }
+    size_t indexOf(std::string_view) const override;
+    size_t find(std::string_view prefix, size_t from = 0) const override;
+
+    allocator_type get_allocator() const noexcept
+    {
+        return buffer.get_allocator();
+    }
+};
+} // namespace CanForm
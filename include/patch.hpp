@@ -0,0 +1,135 @@
+#pragma once
+
+#include "form.hpp"
+#include "snapshot.hpp"
+
+#include <optional>
+
+namespace CanForm
+{
+// Keys from the root form to a field. Each key selects a field of a StructForm, an alternative of a VariantForm or an
+// entry of an EnableForm.
+using FormPath = std::pmr::vector<Atom>;
+
+// Keys separated by '/'. An empty string is the root.
+extern FormPath toPath(std::string_view, const Allocator & = Allocator());
+// Keys joined with '/'
+extern String toString(const FormPath &);
+
+// Null if the form has no field at path
+extern Form *resolve(Form &, const FormPath &);
+extern const Form *resolve(const Form &, const FormPath &);
+
+struct PatchOperation
+{
+    enum class Kind : uint8_t
+    {
+        // Replace the form at path with value
+        Replace,
+        // Add value (and for an EnableForm, flag) under the last key of path
+        Insert,
+        // Remove the last key of path from its StructForm, VariantForm or EnableForm
+        Remove,
+        // Set the selected index of the StringSelection at path
+        Select,
+        // Set the selected alternative of the VariantForm at path
+        Switch,
+        // Set the enabled flag of the last key of path in its EnableForm
+        Enable,
+        // Set (or add) the key in text of the StringMap at path. StringMap keys are user data, so they are not
+        // interned as path atoms.
+        Flag,
+        // Set the columns of the StructForm at path
+        Columns,
+        // Remove the key in text from the StringMap at path
+        Unflag
+    };
+
+    using allocator_type = Allocator;
+
+    Kind kind;
+    FormPath path;
+    Form value;
+    String text;
+    int64_t number;
+    bool flag;
+
+    PatchOperation(Kind k, const FormPath &p, const allocator_type &a = allocator_type())
+        : kind(k), path(p, a), value(a), text(a), number(0), flag(false)
+    {
+    }
+    PatchOperation(const PatchOperation &) = default;
+    PatchOperation(PatchOperation &&) noexcept = default;
+    PatchOperation(const PatchOperation &o, const allocator_type &a)
+        : kind(o.kind), path(o.path, a), value(o.value, a), text(o.text, a), number(o.number), flag(o.flag)
+    {
+    }
+    PatchOperation(PatchOperation &&o, const allocator_type &a)
+        : kind(o.kind), path(std::move(o.path), a), value(std::move(o.value), a), text(std::move(o.text), a),
+          number(o.number), flag(o.flag)
+    {
+    }
+
+    PatchOperation &operator=(const PatchOperation &) = default;
+    PatchOperation &operator=(PatchOperation &&) = default;
+};
+
+// Ordered list of changes that turns one form into another. Keys that are inserted go to the end of their container
+// so applying a patch keeps every value but not necessarily the insertion order of the target.
+struct FormPatch
+{
+    using allocator_type = Allocator;
+    using Operations = std::pmr::vector<PatchOperation>;
+
+    Operations operations;
+
+    FormPatch() = default;
+    explicit FormPatch(const allocator_type &a) : operations(a)
+    {
+    }
+    FormPatch(const FormPatch &) = default;
+    FormPatch(FormPatch &&) noexcept = default;
+    FormPatch(const FormPatch &p, const allocator_type &a) : operations(p.operations, a)
+    {
+    }
+    FormPatch(FormPatch &&p, const allocator_type &a) : operations(std::move(p.operations), a)
+    {
+    }
+
+    FormPatch &operator=(const FormPatch &) = default;
+    FormPatch &operator=(FormPatch &&) = default;
+
+    allocator_type get_allocator() const noexcept
+    {
+        return operations.get_allocator();
+    }
+
+    size_t size() const noexcept
+    {
+        return operations.size();
+    }
+    bool empty() const noexcept
+    {
+        return operations.empty();
+    }
+
+    Operations::const_iterator begin() const noexcept
+    {
+        return operations.begin();
+    }
+    Operations::const_iterator end() const noexcept
+    {
+        return operations.end();
+    }
+};
+
+extern FormPatch diff(const Form &from, const Form &to, const Allocator & = Allocator());
+
+// Returns false if an operation does not match the form. Operations before it stay applied.
+extern bool apply(Form &, const FormPatch &);
+extern bool apply(Form &, const PatchOperation &);
+
+// Compact binary encoding. Form values are stored as snapshots.
+extern Snapshot::Bytes encodePatch(const FormPatch &, const Allocator & = Allocator());
+extern std::optional<FormPatch> decodePatch(const char *data, size_t size, const Allocator & = Allocator());
+} // namespace CanForm
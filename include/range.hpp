@@ -1,17 +1,16 @@
 #pragma once
 
+#include "numeric.hpp"
+
 #include <algorithm>
 #include <limits>
 #include <optional>
 
 namespace CanForm
 {
-struct IRange
-{
-    virtual double setFromDouble(double) = 0;
-};
-
-template <typename T> class Range : public IRange
+// Value with its bounds. There are no virtual functions so Range<T> is exactly three T; callers that do not know T
+// dispatch on RangedValue instead.
+template <typename T> class Range
 {
     static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>);
 
@@ -53,19 +52,53 @@ template <typename T> class Range : public IRange
         return *this;
     }
 
+    // Converts and clamps u with convertNumber; NaN keeps the value
     template <typename U, std::enable_if_t<std::is_arithmetic_v<U> && !std::is_same_v<U, bool>, bool> = true>
     Range &operator=(U u) noexcept
     {
-        value = std::clamp(static_cast<T>(u), min, max);
+        if (auto t = convertNumber(u, min, max))
+        {
+            value = *t;
+        }
         return *this;
     }
 
-    virtual double setFromDouble(double d) override
+    double setFromDouble(double d) noexcept
     {
-        *this = d;
+        if (auto t = convertNumber(d, min, max))
+        {
+            value = *t;
+        }
         return value;
     }
 
+    // Parses the text exactly as a T and clamps it to the bounds. Returns false and keeps the value if the text is not a
+    // number.
+    bool setFromChars(std::string_view text) noexcept
+    {
+        if (auto t = parseChars(text))
+        {
+            value = *t;
+            return true;
+        }
+        return false;
+    }
+    // Same as setFromChars without changing the value
+    std::optional<T> parseChars(std::string_view text) const noexcept
+    {
+        return parseNumber(text, min, max);
+    }
+    // Writes the value without a terminator and returns the end, or null if it does not fit
+    char *toChars(char *first, char *last) const noexcept
+    {
+        return formatNumber(first, last, value);
+    }
+    // Moves the value by steps of one within the bounds
+    void step(int steps) noexcept
+    {
+        value = stepNumber(value, steps, min, max);
+    }
+
     constexpr T getValue() const noexcept
     {
         return value;
@@ -119,4 +152,6 @@ template <typename T> class Range : public IRange
         }
     }
 };
+
+static_assert(sizeof(Range<int8_t>) == 3 && sizeof(Range<double>) == 3 * sizeof(double));
 } // namespace CanForm
\ No newline at end of file
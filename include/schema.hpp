@@ -0,0 +1,235 @@
+#pragma once
+
+#include "form.hpp"
+
+#include <cstring>
+#include <optional>
+
+namespace CanForm
+{
+// Values of one record laid out by a FormSchema. Fixed size values are packed without padding in one buffer. Strings
+// and editable sets are kept in tables whose positions come from the schema.
+class FormValues
+{
+  public:
+    using allocator_type = Allocator;
+
+  private:
+    std::pmr::vector<std::byte> buffer;
+    std::pmr::vector<String> strings;
+    std::pmr::vector<StringSet> sets;
+
+    friend class FormSchema;
+
+  public:
+    FormValues() = default;
+    explicit FormValues(const allocator_type &a) : buffer(a), strings(a), sets(a)
+    {
+    }
+    FormValues(const FormValues &) = default;
+    FormValues(FormValues &&) noexcept = default;
+    FormValues(const FormValues &v, const allocator_type &a)
+        : buffer(v.buffer, a), strings(v.strings, a), sets(v.sets, a)
+    {
+    }
+    FormValues(FormValues &&v, const allocator_type &a)
+        : buffer(std::move(v.buffer), a), strings(std::move(v.strings), a), sets(std::move(v.sets), a)
+    {
+    }
+
+    FormValues &operator=(const FormValues &) = default;
+    FormValues &operator=(FormValues &&) = default;
+
+    // offset is FormSchema::Node::offset
+    template <typename T> T read(size_t offset) const noexcept
+    {
+        T t;
+        std::memcpy(&t, buffer.data() + offset, sizeof(T));
+        return t;
+    }
+    template <typename T> void write(size_t offset, const T &t) noexcept
+    {
+        std::memcpy(buffer.data() + offset, &t, sizeof(T));
+    }
+
+    // index is FormSchema::Node::value
+    String &string(size_t index) noexcept
+    {
+        return strings[index];
+    }
+    const String &string(size_t index) const noexcept
+    {
+        return strings[index];
+    }
+    StringSet &set(size_t index) noexcept
+    {
+        return sets[index];
+    }
+    const StringSet &set(size_t index) const noexcept
+    {
+        return sets[index];
+    }
+
+    allocator_type get_allocator() const noexcept
+    {
+        return buffer.get_allocator();
+    }
+};
+
+// Structure of a form compiled from a prototype: keys, types, range bounds, options and columns. Records with that
+// structure are stored as FormValues.
+class FormSchema
+{
+  public:
+    using allocator_type = Allocator;
+
+    struct Node
+    {
+        Atom key;
+        uint32_t alternative;
+        // Position of the value in FormValues' buffer. The value is:
+        // bool: 1 byte
+        // RangedValue: the number
+        // StringSelection: int32_t index
+        // StringMap and EnableForm: 1 byte flag per key
+        // VariantForm: uint32_t position of the selected child or npos
+        uint32_t offset;
+        // Children of containers and keys of StringMaps: position in the children or keys table
+        uint32_t first;
+        uint32_t count;
+        // String and ComplexString: position in the string table. StringSet: position in the set table.
+        // RangedValue: position of the bounds. StringSelection: position of the options. StructForm: columns.
+        uint32_t value;
+        // ComplexString: position of the options
+        uint32_t extra;
+    };
+
+    static constexpr uint32_t npos = static_cast<uint32_t>(-1);
+
+  private:
+    std::pmr::vector<Node> nodes;
+    std::pmr::vector<uint32_t> children;
+    std::pmr::vector<Atom> keys;
+    // Value, minimum and maximum of the prototype
+    std::pmr::vector<RangedValue> ranges;
+    std::pmr::vector<IndexedStringSet> options;
+    std::pmr::vector<std::pmr::map<String, StringSet>> complexOptions;
+    uint32_t bufferSize;
+    uint32_t stringCount;
+    uint32_t setCount;
+
+    uint32_t add(const Form &, const Atom &key);
+    bool store(uint32_t node, const Form &, FormValues &) const;
+    void load(uint32_t node, const FormValues &, Form &) const;
+
+  public:
+    explicit FormSchema(const Form &prototype, const allocator_type & = allocator_type());
+
+    const Node &operator[](size_t node) const noexcept
+    {
+        return nodes[node];
+    }
+    size_t size() const noexcept
+    {
+        return nodes.size();
+    }
+
+    // Child of a container node by key
+    std::optional<uint32_t> child(uint32_t node, const Atom &key) const noexcept;
+    // Node at a path of keys separated by '/'. The root is node 0.
+    std::optional<uint32_t> find(std::string_view path) const;
+
+    // Bytes of the fixed size values in each record
+    constexpr size_t recordSize() const noexcept
+    {
+        return bufferSize;
+    }
+
+    // Returns nothing if the form does not have this structure
+    std::optional<FormValues> values(const Form &, const allocator_type & = allocator_type()) const;
+    // Returns false if the form does not have this structure. values is left unspecified in that case.
+    bool store(const Form &, FormValues &) const;
+
+    Form materialize(const FormValues &, const allocator_type & = allocator_type()) const;
+};
+
+// Shows a form built from a schema and values. The edited values are stored back before ok() runs.
+class SchemaExecute : public FormExecute
+{
+  protected:
+    std::shared_ptr<const FormSchema> schema;
+    FormValues values;
+
+    virtual void accepted() = 0;
+
+  public:
+    SchemaExecute(std::shared_ptr<const FormSchema> s, FormValues &&v)
+        : FormExecute(std::in_place, s->materialize(v)), schema(std::move(s)), values(std::move(v))
+    {
+    }
+    SchemaExecute(const SchemaExecute &) = delete;
+    SchemaExecute(SchemaExecute &&) noexcept = default;
+    virtual ~SchemaExecute()
+    {
+    }
+
+    virtual void ok() override
+    {
+        if (schema->store(form, values))
+        {
+            accepted();
+        }
+    }
+
+    const FormSchema &getSchema() const noexcept
+    {
+        return *schema;
+    }
+    const FormValues &getValues() const noexcept
+    {
+        return values;
+    }
+};
+
+template <typename F> class SchemaExecuteLambda : public SchemaExecute
+{
+  private:
+    F func;
+
+  protected:
+    virtual void accepted() override
+    {
+        if constexpr (std::is_invocable<F, const FormSchema &, FormValues &>::value)
+        {
+            func(*schema, values);
+        }
+        else if constexpr (std::is_invocable<F, FormValues &>::value)
+        {
+            func(values);
+        }
+        else
+        {
+            func();
+        }
+    }
+
+  public:
+    SchemaExecuteLambda(F &&f, std::shared_ptr<const FormSchema> s, FormValues &&v)
+        : SchemaExecute(std::move(s), std::move(v)), func(std::move(f))
+    {
+    }
+    SchemaExecuteLambda(const SchemaExecuteLambda &) = delete;
+    SchemaExecuteLambda(SchemaExecuteLambda &&) noexcept = default;
+    virtual ~SchemaExecuteLambda()
+    {
+    }
+};
+
+// For FormExecute::execute(title, executeValues(...))
+template <typename F>
+static inline SchemaExecuteLambda<F> executeValues(F &&f, std::shared_ptr<const FormSchema> schema, FormValues values)
+{
+    SchemaExecuteLambda<F> lambda(std::move(f), std::move(schema), std::move(values));
+    return lambda;
+}
+} // namespace CanForm
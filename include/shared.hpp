@@ -0,0 +1,171 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <memory>
+
+namespace CanForm
+{
+// Copy-on-write handle for the maps of the container forms. Copies made with the same memory resource share the value
+// until one of them asks for mutable access, which copies one level and leaves the nested handles shared.
+//
+// Mutable access pins the value: references taken through it may still be written, so copies of a pinned handle get
+// their own value instead of sharing it. A copy taken while a dialog edits a form (a snapshot, an undo step or an
+// autosave) therefore never sees later edits. FormTracker::track() pins every map of the tracked form.
+//
+// Clone, when given, builds the copy for values that uses-allocator construction cannot copy into a memory resource.
+template <typename T, typename Clone = void> class Shared
+{
+  public:
+    using allocator_type = Allocator;
+
+  private:
+    // Null until the value is first written. Empty values are never allocated.
+    std::shared_ptr<T> ptr;
+    std::pmr::memory_resource *resource;
+    // Set once mutable access was handed out
+    bool pinned;
+
+    static const T &empty()
+    {
+        static const T t;
+        return t;
+    }
+
+    std::shared_ptr<T> copy(const T &t) const
+    {
+        if constexpr (std::is_void_v<Clone>)
+        {
+            return std::allocate_shared<T>(get_allocator(), t);
+        }
+        else
+        {
+            return std::allocate_shared<T>(get_allocator(), Clone()(t, get_allocator()));
+        }
+    }
+
+  public:
+    Shared() : ptr(), resource(std::pmr::get_default_resource()), pinned(false)
+    {
+    }
+    explicit Shared(const allocator_type &a) : ptr(), resource(a.resource()), pinned(false)
+    {
+    }
+    Shared(const Shared &s) : Shared(s, allocator_type())
+    {
+    }
+    Shared(Shared &&s) noexcept : ptr(std::move(s.ptr)), resource(s.resource), pinned(s.pinned)
+    {
+        s.pinned = false;
+    }
+    Shared(const Shared &s, const allocator_type &a) : ptr(), resource(a.resource()), pinned(false)
+    {
+        *this = s;
+    }
+    Shared(Shared &&s, const allocator_type &a) : ptr(), resource(a.resource()), pinned(false)
+    {
+        *this = std::move(s);
+    }
+    Shared(const T &t, const allocator_type &a = allocator_type()) : ptr(), resource(a.resource()), pinned(false)
+    {
+        ptr = copy(t);
+    }
+    Shared(T &&t) : ptr(), resource(t.get_allocator().resource()), pinned(false)
+    {
+        ptr = std::allocate_shared<T>(get_allocator(), std::move(t));
+    }
+
+    Shared &operator=(const Shared &s)
+    {
+        if (this == &s)
+        {
+            return *this;
+        }
+        if (s.ptr == nullptr)
+        {
+            ptr.reset();
+        }
+        else if (resource == s.resource && !s.pinned)
+        {
+            ptr = s.ptr;
+        }
+        else
+        {
+            ptr = copy(*s.ptr);
+        }
+        pinned = false;
+        return *this;
+    }
+    Shared &operator=(Shared &&s)
+    {
+        if (this == &s)
+        {
+            return *this;
+        }
+        // References into a moved value stay valid, so it stays pinned
+        if (resource == s.resource || s.ptr == nullptr)
+        {
+            ptr = std::move(s.ptr);
+            pinned = s.pinned;
+        }
+        else
+        {
+            ptr = copy(*s.ptr);
+            s.ptr.reset();
+            pinned = false;
+        }
+        s.pinned = false;
+        return *this;
+    }
+    Shared &operator=(const T &t)
+    {
+        write() = t;
+        return *this;
+    }
+    Shared &operator=(T &&t)
+    {
+        write() = std::move(t);
+        return *this;
+    }
+
+    const T &read() const noexcept
+    {
+        return ptr == nullptr ? empty() : *ptr;
+    }
+
+    // Copies the value first if another handle shares it, and pins it
+    T &write()
+    {
+        if (ptr == nullptr)
+        {
+            ptr = std::allocate_shared<T>(get_allocator());
+        }
+        else if (ptr.use_count() > 1)
+        {
+            ptr = copy(*ptr);
+        }
+        pinned = true;
+        return *ptr;
+    }
+
+    // Whether the value has been allocated
+    bool allocated() const noexcept
+    {
+        return ptr != nullptr;
+    }
+    // Whether copies get their own value
+    bool isPinned() const noexcept
+    {
+        return pinned;
+    }
+    bool shared() const noexcept
+    {
+        return ptr != nullptr && ptr.use_count() > 1;
+    }
+
+    allocator_type get_allocator() const noexcept
+    {
+        return allocator_type(resource);
+    }
+};
+} // namespace CanForm
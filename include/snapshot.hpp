@@ -0,0 +1,189 @@
+#pragma once
+
+#include "form.hpp"
+
+#include <cstring>
+#include <optional>
+#include <string_view>
+
+namespace CanForm
+{
+// Binary snapshot of a Form.
+//
+// Every value is stored native endian and 8 byte aligned so a snapshot can be read in place from a mapped file.
+// The file starts with a Snapshot::Header followed by nodes. Every node starts with a Snapshot::Node whose type is the
+// index of the alternative in Form::Data. Containers are followed by `count` Snapshot::Entry records and a table of
+// entry positions sorted by key so lookups are a binary search. Ranges are followed by their value, minimum and
+// maximum, each in an 8 byte slot.
+namespace Snapshot
+{
+constexpr uint32_t Magic = 0x4d464e43; // "CNFM"
+constexpr uint32_t Version = 1;
+constexpr uint32_t ByteOrder = 0x01020304;
+
+struct Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t reserved;
+    uint64_t root;
+    uint64_t size;
+};
+
+struct Node
+{
+    uint32_t type;
+    // bool value, RangedValue index, selected index or 0
+    uint32_t value;
+    uint64_t count;
+    // String/ComplexString text, selected variant or struct columns
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct Entry
+{
+    uint64_t key;
+    uint32_t keySize;
+    // StringMap flag or EnableForm flag
+    uint32_t flag;
+    // Child node (zero for strings in a set or selection)
+    uint64_t value;
+};
+
+using Bytes = std::pmr::vector<char>;
+} // namespace Snapshot
+
+extern Snapshot::Bytes encodeSnapshot(const Form &, const Allocator & = Allocator());
+extern bool saveSnapshot(const Form &, const char *path);
+
+// Read-only view of one node in a snapshot. Nothing is copied until materialize() is called.
+class FormView
+{
+  private:
+    const char *base;
+    size_t length;
+    uint64_t offset;
+
+    const Snapshot::Node &node() const noexcept
+    {
+        return *reinterpret_cast<const Snapshot::Node *>(base + offset);
+    }
+    const Snapshot::Entry *entries() const noexcept
+    {
+        return reinterpret_cast<const Snapshot::Entry *>(base + offset + sizeof(Snapshot::Node));
+    }
+    const uint32_t *order() const noexcept
+    {
+        return reinterpret_cast<const uint32_t *>(entries() + node().count);
+    }
+    std::string_view text(uint64_t o, uint64_t n) const noexcept
+    {
+        if (o + n > length)
+        {
+            return std::string_view();
+        }
+        return std::string_view(base + o, n);
+    }
+
+    bool isContainer() const noexcept;
+
+  public:
+    constexpr FormView() noexcept : base(nullptr), length(0), offset(0)
+    {
+    }
+    // Invalid if the node or its entry table does not fit in the data
+    FormView(const char *, size_t, uint64_t) noexcept;
+
+    // Checks the header of a snapshot and returns a view of its root
+    static std::optional<FormView> root(const char *data, size_t size) noexcept;
+
+    constexpr bool valid() const noexcept
+    {
+        return base != nullptr;
+    }
+
+    // Same value as Form::Data::index()
+    size_t index() const noexcept
+    {
+        return node().type;
+    }
+    template <typename T> bool holds() const noexcept
+    {
+        return index() == Form::indexOf<T>();
+    }
+
+    bool getBool() const noexcept
+    {
+        return node().value != 0;
+    }
+    // Text of a String, ComplexString or the selected alternative of a VariantForm
+    std::string_view getString() const noexcept
+    {
+        return text(node().offset, node().size);
+    }
+    std::optional<RangedValue> getRange() const noexcept;
+    int getSelectionIndex() const noexcept
+    {
+        return static_cast<int>(node().value);
+    }
+    size_t getColumns() const noexcept
+    {
+        return node().offset;
+    }
+
+    // Number of entries in a container or option list
+    size_t size() const noexcept
+    {
+        return isContainer() ? node().count : 0;
+    }
+    std::string_view key(size_t i) const noexcept
+    {
+        const auto &entry = entries()[i];
+        return text(entry.key, entry.keySize);
+    }
+    bool flag(size_t i) const noexcept
+    {
+        return entries()[i].flag != 0;
+    }
+    FormView child(size_t i) const noexcept
+    {
+        return FormView(base, length, entries()[i].value);
+    }
+
+    // Binary search on the sorted key table. Returns size() if not found.
+    size_t position(std::string_view) const noexcept;
+    std::optional<FormView> find(std::string_view) const noexcept;
+
+    Form materialize(const Allocator & = Allocator()) const;
+};
+
+// Memory mapped snapshot file
+class SnapshotFile
+{
+  private:
+    char *data;
+    size_t size;
+    bool mapped;
+
+    SnapshotFile() noexcept : data(nullptr), size(0), mapped(false)
+    {
+    }
+
+  public:
+    SnapshotFile(const SnapshotFile &) = delete;
+    SnapshotFile(SnapshotFile &&) noexcept;
+    ~SnapshotFile();
+
+    SnapshotFile &operator=(const SnapshotFile &) = delete;
+    SnapshotFile &operator=(SnapshotFile &&) noexcept;
+
+    static std::optional<SnapshotFile> open(const char *path);
+
+    std::optional<FormView> root() const noexcept
+    {
+        return FormView::root(data, size);
+    }
+};
+} // namespace CanForm
@@ -4,8 +4,51 @@
 
 namespace CanForm
 {
-extern Form makeForm(bool makeInner = true);
+extern Form makeForm(bool makeInner = true, const Allocator & = Allocator());
 extern void printForm(const Form &, void *parent = nullptr);
+// Shows the example form and lists the fields that were changed when it is accepted
+extern std::shared_ptr<FormExecute> executeChangeReport(void *parent = nullptr);
+// Shows the example form from a FormSchema and FormValues and reports the stored values when it is accepted
+extern std::shared_ptr<FormExecute> executeSchemaForm(void *parent = nullptr);
+// Edits a struct in place through BIND
+extern std::shared_ptr<FormExecute> executeBoundStruct(void *parent = nullptr);
+// Edits many records of one shape as a table
+extern std::shared_ptr<FormExecute> executeBatchForm(void *parent = nullptr);
+// Shows the example form with checks that must pass before it is accepted
+extern std::shared_ptr<FormExecute> executeValidatedForm(void *parent = nullptr);
+// Shows a form with totals, conversions and an enable rule computed from other fields
+extern std::shared_ptr<FormExecute> executeComputedForm(void *parent = nullptr);
+// Shows a choice between large alternatives that are built when they are selected
+extern std::shared_ptr<FormExecute> executeLazyVariantForm(void *parent = nullptr);
+// Shows a pick from a million options that are fetched a window at a time
+extern std::shared_ptr<FormExecute> executeOptionPicker(void *parent = nullptr);
+// Shows the example form with undo and redo of its edits
+extern std::shared_ptr<FormExecute> executeJournalForm(void *parent = nullptr);
+// Shows the same form every time and rolls back its edits when the dialog is canceled or closed
+extern std::shared_ptr<FormExecute> executeTransactionForm(void *parent = nullptr);
+
+// Each benchmark returns a human readable report
+extern String benchmarkArena(size_t forms);
+extern String benchmarkMaps();
+extern String benchmarkAtoms(size_t forms);
+extern String benchmarkSnapshot(size_t forms);
+extern String benchmarkJson(size_t forms);
+extern String benchmarkPatch(size_t forms);
+extern String benchmarkHash(size_t forms);
+extern String benchmarkSharing(size_t forms);
+extern String benchmarkFields(size_t records);
+extern String benchmarkSchema(size_t records);
+extern String benchmarkRanges(size_t count);
+extern String benchmarkLayout(size_t fields);
+extern String benchmarkValidation(size_t fields);
+extern String benchmarkComputed(size_t fields);
+extern String benchmarkWalker(size_t depth);
+extern String benchmarkLazyVariant(size_t alternatives);
+extern String benchmarkOptions(size_t count);
+extern String benchmarkNumericEntry(size_t count);
+extern String benchmarkJournal(size_t fields);
+extern String benchmarkTransaction(size_t fields);
+extern String benchmarkMemory(size_t fields);
 
 template <typename T> T random() noexcept
 {
@@ -70,7 +113,7 @@ template <> inline void addForm<String>(StructForm &structForm, String &&s, Stri
 
 template <> inline void addForm<StringSelection>(StructForm &structForm, String &&s, StringSelection &&selection)
 {
-    selection.set = randomSet(rand() % 4 + 2, 3, 8);
+    selection.set = IndexedStringSet(randomSet(rand() % 4 + 2, 3, 8));
     selection.index = rand() % selection.set.size();
     structForm[std::move(s)] = std::move(selection);
 }
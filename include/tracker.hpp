@@ -0,0 +1,154 @@
+#pragma once
+
+#include "form.hpp"
+#include "hash.hpp"
+#include "patch.hpp"
+#include "walker.hpp"
+
+#include <functional>
+#include <unordered_map>
+
+namespace CanForm
+{
+using Revision = uint64_t;
+
+// Records which parts of a form changed. Every Form in the tree gets a revision that is raised when the form itself
+// or anything below it changes, so consumers can skip unchanged subtrees.
+//
+// Changes are reported with touch() using the address of the form or of any value inside it (a bool, String, Range,
+// selection index, map flag, ...), which is what the widgets of the backends hold. Addresses are collected by
+// track() and must be collected again after keys are inserted or removed.
+class FormTracker
+{
+  public:
+    // Called with the path and the form that changed
+    using Listener = std::function<void(const FormPath &, const Form &)>;
+
+  private:
+    struct Node
+    {
+        const Form *parent;
+        Atom key;
+        // Last change to this form or anything below it
+        Revision revision;
+        // Last change to this form itself
+        Revision changed;
+    };
+
+    Form *root;
+    std::pmr::unordered_map<const Form *, Node> nodes;
+    std::pmr::unordered_map<const void *, const Form *> owners;
+    std::pmr::vector<std::pair<size_t, Listener>> listeners;
+    // Called by prepare() before a change
+    std::pmr::vector<std::pair<size_t, Listener>> preparers;
+    Revision counter;
+    size_t nextListener;
+    // Kept between walks so its stack and path are allocated once
+    mutable FormWalker walker;
+
+    // Walks top with the given parent and key for it
+    void add(const Form &top, const Form *parent, const Atom &key);
+
+  public:
+    explicit FormTracker(const Allocator & = Allocator());
+    FormTracker(const FormTracker &) = delete;
+    FormTracker(FormTracker &&) noexcept = default;
+
+    FormTracker &operator=(const FormTracker &) = delete;
+    FormTracker &operator=(FormTracker &&) = default;
+
+    // Collects the addresses in the form after unsharing it. Revisions of forms that are still in the tree are kept.
+    void track(Form &);
+    // Collects the addresses of the tracked form again
+    void retrack();
+    // Collects the addresses in a tracked form that was replaced in place, e.g. a lazy alternative of a VariantForm
+    // that was just built. Only that form is walked. Returns false if the form is not tracked.
+    bool retrack(Form &);
+    // Forgets the forms below a tracked form and the parts of its value before they are destroyed, e.g. a lazy
+    // alternative that is about to be dropped. The form itself stays tracked; retrack it once it holds its new value.
+    void untrack(const Form &);
+
+    // Returns false if the address is not part of the tracked form
+    bool touch(const void *address);
+    // Called with the same address before a change that is then reported with touch(), so listeners such as an
+    // EditJournal can keep the old value. Returns false if the address is not part of the tracked form.
+    bool prepare(const void *address);
+
+    // Runs f on the form and records the change
+    template <typename F> void modify(Form &form, F &&f)
+    {
+        f(form);
+        touch(&form);
+    }
+
+    // Null until a form is tracked
+    Form *getRoot() const noexcept
+    {
+        return root;
+    }
+
+    constexpr Revision current() const noexcept
+    {
+        return counter;
+    }
+
+    // Zero if the form never changed or is not tracked
+    Revision revision(const Form &) const noexcept;
+
+    bool changedSince(const Form &form, Revision since) const noexcept
+    {
+        return revision(form) > since;
+    }
+
+    // Calls f(path, form) for every form that was changed itself after since. Unchanged subtrees are skipped. f must
+    // not track a form.
+    template <typename F> void changedSince(Revision since, F &&f) const
+    {
+        if (root == nullptr)
+        {
+            return;
+        }
+        walker.walk(*root, [&](const FormWalker::Step &step) {
+            auto iter = nodes.find(step.form);
+            if (iter == nodes.end() || iter->second.revision <= since)
+            {
+                return WalkAction::Skip;
+            }
+            if (iter->second.changed > since)
+            {
+                f(walker.getPath(), *step.form);
+            }
+            return WalkAction::Continue;
+        });
+    }
+
+    FormPath pathOf(const Form &) const;
+
+    // Hash of the tracked form with the subtree hashes cached in it. track() clears the caches and touch() clears them
+    // on the path to the change, so this is correct as long as every write is touched. Zero without a form.
+    FormHash hash() const;
+
+    size_t subscribe(Listener);
+    // The listener is called by prepare() instead of touch()
+    size_t subscribeBefore(Listener);
+    void unsubscribe(size_t);
+};
+
+// Used by the backends where a tracker is optional
+inline void touchForm(FormTracker *tracker, const void *address)
+{
+    if (tracker != nullptr)
+    {
+        tracker->touch(address);
+    }
+}
+inline void prepareForm(FormTracker *tracker, const void *address)
+{
+    if (tracker != nullptr)
+    {
+        tracker->prepare(address);
+    }
+}
+// Selects an alternative with the change recorded. Only an alternative that is built or dropped by it is walked again.
+extern Form *selectAlternative(FormTracker *, VariantForm &, const Atom &key);
+} // namespace CanForm
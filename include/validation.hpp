@@ -0,0 +1,127 @@
+#pragma once
+
+#include "form.hpp"
+#include "patch.hpp"
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+
+namespace CanForm
+{
+struct ValidationError
+{
+    FormPath path;
+    // The failing form inside the validated tree
+    const Form *form;
+    String message;
+};
+
+// Sorted by path
+using ValidationErrors = std::pmr::vector<ValidationError>;
+
+// Constraints on the fields of a form. Checks are registered for a path or for every field of a type and are run on
+// a work-stealing thread pool: each StructForm, VariantForm or EnableForm below the root is a task that idle threads
+// can take, and the fields inside a task are checked on the thread that runs it. The pool is started by the first
+// validation and kept until the engine is destroyed; its threads sleep between tasks and validations.
+//
+// Checks must not modify anything, must not throw and must be safe to call from several threads at once. Alternatives
+// of a VariantForm that are not selected and disabled fields of an EnableForm are not checked.
+class ValidationEngine
+{
+  public:
+    using allocator_type = Allocator;
+    // Returns a message if the form is invalid
+    using Check = std::function<std::optional<String>(const Form &)>;
+
+  private:
+    struct PathCheck
+    {
+        FormPath path;
+        Check check;
+    };
+
+    // Keyed by pathHash
+    std::pmr::unordered_multimap<size_t, PathCheck> paths;
+    std::array<std::pmr::vector<Check>, std::variant_size_v<Form::Data>> types;
+    size_t threads;
+
+    class Worker;
+    class Pool;
+    std::unique_ptr<Pool> pool;
+
+  public:
+    // 0 threads uses one per core. The paths of the tasks are allocated with the allocator from the threads of the
+    // pool, so it must be thread safe.
+    explicit ValidationEngine(size_t threads = 0, const allocator_type & = allocator_type());
+    ValidationEngine(const ValidationEngine &) = delete;
+    ~ValidationEngine();
+
+    ValidationEngine &operator=(const ValidationEngine &) = delete;
+
+    allocator_type get_allocator() const noexcept
+    {
+        return paths.get_allocator();
+    }
+
+    static constexpr size_t pathHash(size_t parent, const Atom &key) noexcept
+    {
+        return parent * 31 + key.hash();
+    }
+
+    size_t getThreads() const noexcept
+    {
+        return threads;
+    }
+
+    // Checks the form at path. Keys are separated by '/'; an empty path is the root. Checks on a StructForm can
+    // compare its fields with each other.
+    void add(std::string_view path, Check);
+    void add(const FormPath &, Check);
+    // Checks the form at path if it holds a T
+    template <typename T, typename F> void add(std::string_view path, F &&f)
+    {
+        add(path, typed<T>(std::forward<F>(f)));
+    }
+    // Checks every form that holds a T
+    template <typename T, typename F> void addType(F &&f)
+    {
+        types[Form::indexOf<T>()].push_back(typed<T>(std::forward<F>(f)));
+    }
+
+    bool empty() const noexcept;
+
+    // Errors of every failing check, with their paths and messages allocated with the allocator of the engine or the
+    // given one, from the threads of the pool. Validations with one engine run one at a time.
+    ValidationErrors validate(const Form &) const;
+    ValidationErrors validate(const Form &, const Allocator &) const;
+
+    // Skips forms that do not hold a T. f is called with the T, or with the form if it takes a Form.
+    template <typename T, typename F> static Check typed(F &&f)
+    {
+        return [f = std::forward<F>(f)](const Form &form) -> std::optional<String> {
+            if constexpr (std::is_invocable_v<const std::decay_t<F> &, const Form &>)
+            {
+                if (form.template holds<T>())
+                {
+                    return f(form);
+                }
+            }
+            else if (auto t = form.template getIf<T>())
+            {
+                return f(*t);
+            }
+            return std::nullopt;
+        };
+    }
+
+    // Fails a String or ComplexString that does not match the ECMAScript regular expression
+    static Check matches(std::string_view pattern, std::string_view message);
+    // Fails an empty String, ComplexString or StringSet
+    static Check notEmpty(std::string_view message);
+    // Fails a RangedValue outside min and max
+    static Check between(double min, double max, std::string_view message);
+};
+} // namespace CanForm
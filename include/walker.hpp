@@ -0,0 +1,191 @@
+#pragma once
+
+#include "form.hpp"
+#include "patch.hpp"
+
+#include <type_traits>
+
+namespace CanForm
+{
+enum class WalkAction : uint8_t
+{
+    // Walk the fields of the form
+    Continue,
+    // Do not walk the fields of the form. Its post callback still runs.
+    Skip,
+    // End the walk
+    Stop
+};
+
+// Walks a form and everything below it in depth first order with an explicit stack, so deeply nested forms cannot
+// overflow the call stack. The path to the current form is kept in one FormPath that grows and shrinks with the walk.
+//
+// Use FormWalker for const forms and MutableFormWalker to change values on the way. Callbacks must not add or remove
+// fields of forms that are still being walked.
+template <typename F> class BasicFormWalker
+{
+  public:
+    using allocator_type = Allocator;
+    using Flag = std::conditional_t<std::is_const_v<F>, const bool, bool>;
+
+    struct Step
+    {
+        F *form;
+        // The StructForm, VariantForm or EnableForm that holds the form. Null for the root.
+        F *parent;
+        // Key of the form in its parent
+        Atom key;
+        // Enabled flag of a field of an EnableForm, null otherwise
+        Flag *enabled;
+    };
+
+  private:
+    struct Entry
+    {
+        Step step;
+        uint32_t depth;
+        bool post;
+    };
+
+    // Walks without a post callback push no post entries
+    struct NoPost
+    {
+        WalkAction operator()(const Step &) const noexcept
+        {
+            return WalkAction::Continue;
+        }
+    };
+
+    std::pmr::vector<Entry> stack;
+    FormPath path;
+    bool activeOnly;
+
+    template <typename C> static WalkAction call(C &c, const Step &step)
+    {
+        if constexpr (std::is_void_v<std::invoke_result_t<C &, const Step &>>)
+        {
+            c(step);
+            return WalkAction::Continue;
+        }
+        else
+        {
+            return c(step);
+        }
+    }
+
+    // Fields are pushed last to first so the first one is walked first
+    template <typename Map, typename Push> static void pushReversed(Map &map, Push &&push)
+    {
+        for (auto iter = map.end(); iter != map.begin();)
+        {
+            --iter;
+            push(iter->first, iter->second);
+        }
+    }
+
+    void pushFields(const Step &step, uint32_t depth)
+    {
+        F &form = *step.form;
+        if (auto structForm = form.template getIf<StructForm>())
+        {
+            pushReversed(**structForm, [&](const Atom &key, F &child) {
+                stack.push_back(Entry{Step{&child, &form, key, nullptr}, depth, false});
+            });
+        }
+        else if (auto variant = form.template getIf<VariantForm>())
+        {
+            pushReversed(**variant, [&](const Atom &key, F &child) {
+                if (!activeOnly || key == variant->selected)
+                {
+                    stack.push_back(Entry{Step{&child, &form, key, nullptr}, depth, false});
+                }
+            });
+        }
+        else if (auto enableForm = form.template getIf<EnableForm>())
+        {
+            pushReversed(**enableForm, [&](const Atom &key, auto &pair) {
+                if (!activeOnly || pair.first)
+                {
+                    stack.push_back(Entry{Step{&pair.second, &form, key, &pair.first}, depth, false});
+                }
+            });
+        }
+    }
+
+  public:
+    // An active only walker skips the alternatives of a VariantForm that are not selected and the disabled fields of
+    // an EnableForm
+    explicit BasicFormWalker(bool active = false, const allocator_type &allocator = allocator_type())
+        : stack(allocator), path(allocator), activeOnly(active)
+    {
+    }
+
+    // Keys from the root to the current form
+    const FormPath &getPath() const noexcept
+    {
+        return path;
+    }
+    // Zero for the root
+    size_t depth() const noexcept
+    {
+        return path.size();
+    }
+
+    // pre(step) runs before the fields of a form are walked and post(step) after them. Either may return a
+    // WalkAction; returning nothing continues. Returns false if the walk was stopped.
+    template <typename Pre, typename Post> bool walk(F &root, Pre &&pre, Post &&post)
+    {
+        stack.clear();
+        path.clear();
+        stack.push_back(Entry{Step{&root, nullptr, Atom(), nullptr}, 0, false});
+        while (!stack.empty())
+        {
+            const Entry entry = stack.back();
+            stack.pop_back();
+            // Leave the path at the parent of the entry, then add its key
+            if (entry.depth > 0)
+            {
+                path.resize(entry.depth - 1);
+                path.push_back(entry.step.key);
+            }
+            else
+            {
+                path.clear();
+            }
+
+            if (entry.post)
+            {
+                if (call(post, entry.step) == WalkAction::Stop)
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            const WalkAction action = call(pre, entry.step);
+            if (action == WalkAction::Stop)
+            {
+                return false;
+            }
+            if constexpr (!std::is_same_v<std::decay_t<Post>, NoPost>)
+            {
+                stack.push_back(Entry{entry.step, entry.depth, true});
+            }
+            if (action == WalkAction::Skip)
+            {
+                continue;
+            }
+            pushFields(entry.step, entry.depth + 1);
+        }
+        return true;
+    }
+
+    template <typename Pre> bool walk(F &root, Pre &&pre)
+    {
+        return walk(root, pre, NoPost());
+    }
+};
+
+using FormWalker = BasicFormWalker<const Form>;
+using MutableFormWalker = BasicFormWalker<Form>;
+} // namespace CanForm
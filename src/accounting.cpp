@@ -0,0 +1,322 @@
+#include <accounting.hpp>
+#include <json.hpp>
+#include <unordered_set>
+#include <walker.hpp>
+
+namespace CanForm
+{
+CountingResource::CountingResource(std::pmr::memory_resource *u) noexcept
+    : upstream(u), bytes(0), peak(0), allocations(0), deallocations(0)
+{
+}
+
+void *CountingResource::do_allocate(size_t n, size_t alignment)
+{
+    void *p = upstream->allocate(n, alignment);
+    const size_t now = bytes.fetch_add(n, std::memory_order_relaxed) + n;
+    size_t high = peak.load(std::memory_order_relaxed);
+    while (high < now && !peak.compare_exchange_weak(high, now, std::memory_order_relaxed))
+    {
+    }
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return p;
+}
+
+void CountingResource::do_deallocate(void *p, size_t n, size_t alignment)
+{
+    bytes.fetch_sub(n, std::memory_order_relaxed);
+    deallocations.fetch_add(1, std::memory_order_relaxed);
+    upstream->deallocate(p, n, alignment);
+}
+
+bool CountingResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return this == &other;
+}
+
+void CountingResource::reset() noexcept
+{
+    peak.store(bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    allocations.store(0, std::memory_order_relaxed);
+    deallocations.store(0, std::memory_order_relaxed);
+}
+
+CountingScope::CountingScope() noexcept : resource(std::pmr::get_default_resource()), previous(nullptr)
+{
+    previous = std::pmr::set_default_resource(&resource);
+}
+
+CountingScope::~CountingScope()
+{
+    std::pmr::set_default_resource(previous);
+}
+
+// Red-black tree node of std::map and std::set before its value
+constexpr size_t NodeHeader = 4 * sizeof(void *);
+
+// Block of std::allocate_shared: the value, the counts with the vtable pointer and the allocator
+template <typename T> constexpr size_t ControlBlock = sizeof(T) + 3 * sizeof(void *);
+
+static size_t heapBytes(const String &s) noexcept
+{
+    const char *data = s.data();
+    const char *self = reinterpret_cast<const char *>(&s);
+    return data >= self && data < self + sizeof(String) ? 0 : s.capacity() + 1;
+}
+
+static void addStringSet(const StringSet &set, MemoryUsage &usage) noexcept
+{
+    usage.setNodes += set.size() * (NodeHeader + sizeof(String));
+    for (const String &s : set)
+    {
+        usage.strings += heapBytes(s);
+    }
+}
+
+template <typename V> static bool holdsRange(const V &value) noexcept
+{
+    if constexpr (std::is_same_v<V, Form>)
+    {
+        return value.template holds<RangedValue>();
+    }
+    else if constexpr (std::is_same_v<V, EnableForm::Value>)
+    {
+        return value.second.template holds<RangedValue>();
+    }
+    else
+    {
+        return false;
+    }
+}
+
+// The entries of a field map or StringMap. The forms in them are counted by their own visits; only the slots they
+// take are here.
+template <typename Map> static void addMap(const Map &map, MemoryUsage &usage) noexcept
+{
+    using Entry = typename Map::value_type;
+    using Key = std::decay_t<typename Entry::first_type>;
+    size_t ranges = 0;
+    for (const auto &entry : map)
+    {
+        ranges += holdsRange(entry.second);
+        if constexpr (std::is_same_v<Key, String>)
+        {
+            usage.keys += heapBytes(entry.first);
+        }
+    }
+#if CANFORM_ORDERED_MAPS
+    const size_t bytes = map.capacity() * sizeof(Entry) + map.getIndex().bytes();
+#else
+    const size_t bytes = map.size() * (NodeHeader + sizeof(Entry));
+#endif
+    const size_t keys = map.size() * sizeof(Key);
+    usage.keys += keys;
+    usage.ranges += ranges * sizeof(RangedValue);
+    usage.mapNodes += bytes - keys - ranges * sizeof(RangedValue);
+}
+
+class MemoryReporter
+{
+  private:
+    struct Frame
+    {
+        MemoryUsage usage;
+        size_t forms;
+        // Position in the subtrees or npos below the depth of the report
+        size_t subtree;
+    };
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    FormMemoryStats &stats;
+    size_t maxDepth;
+    FormWalker walker;
+    std::pmr::vector<Frame> frames;
+    std::pmr::unordered_set<const void *> seen;
+
+    // False if another form was counted with the same map
+    template <typename T, typename C> bool addShared(const Shared<T, C> &shared, MemoryUsage &usage)
+    {
+        if (!shared.allocated())
+        {
+            return true;
+        }
+        if (!seen.insert(&shared.read()).second)
+        {
+            ++stats.sharedMaps;
+            return false;
+        }
+        usage.mapNodes += ControlBlock<T>;
+        addMap(shared.read(), usage);
+        return true;
+    }
+
+    // The memory of the form itself, without its fields
+    WalkAction count(const Form &form, MemoryUsage &usage)
+    {
+        if (auto s = form.getIf<String>())
+        {
+            usage.strings += heapBytes(*s);
+        }
+        else if (auto complex = form.getIf<ComplexString>())
+        {
+            usage.strings += heapBytes(complex->string);
+            for (const auto &[key, set] : complex->map)
+            {
+                usage.keys += sizeof(String) + heapBytes(key);
+                usage.mapNodes += NodeHeader + sizeof(StringSet);
+                addStringSet(set, usage);
+            }
+        }
+        else if (auto set = form.getIf<StringSet>())
+        {
+            addStringSet(*set, usage);
+        }
+        else if (auto selection = form.getIf<StringSelection>())
+        {
+            usage.setNodes += selection->set.capacity() * sizeof(String) + selection->set.getIndex().bytes();
+            for (const String &s : selection->set)
+            {
+                usage.strings += heapBytes(s);
+            }
+            usage.strings += heapBytes(selection->key);
+        }
+        else if (auto map = form.getIf<StringMap>())
+        {
+            addMap(*map, usage);
+        }
+        else if (auto variant = form.getIf<VariantForm>())
+        {
+            usage.strings += heapBytes(variant->selected);
+            addShared(variant->factories, usage);
+            return addShared(variant->map, usage) ? WalkAction::Continue : WalkAction::Skip;
+        }
+        else if (auto structForm = form.getIf<StructForm>())
+        {
+            return addShared(structForm->map, usage) ? WalkAction::Continue : WalkAction::Skip;
+        }
+        else if (auto enableForm = form.getIf<EnableForm>())
+        {
+            return addShared(enableForm->map, usage) ? WalkAction::Continue : WalkAction::Skip;
+        }
+        return WalkAction::Continue;
+    }
+
+  public:
+    MemoryReporter(FormMemoryStats &s, size_t depth, const Allocator &allocator)
+        : stats(s), maxDepth(depth), walker(false, allocator), frames(allocator), seen(allocator)
+    {
+    }
+
+    void operator()(const Form &root)
+    {
+        walker.walk(
+            root,
+            [this](const FormWalker::Step &step) {
+                Frame frame{MemoryUsage(), 1, npos};
+                if (walker.depth() <= maxDepth)
+                {
+                    frame.subtree = stats.subtrees.size();
+                    stats.subtrees.push_back(
+                        FormMemoryStats::Subtree{FormPath(walker.getPath(), stats.subtrees.get_allocator()),
+                                                 MemoryUsage(), 0});
+                }
+                const WalkAction action = count(*step.form, frame.usage);
+                frames.push_back(frame);
+                return action;
+            },
+            [this](const FormWalker::Step &) {
+                const Frame frame = frames.back();
+                frames.pop_back();
+                if (frame.subtree != npos)
+                {
+                    stats.subtrees[frame.subtree].usage = frame.usage;
+                    stats.subtrees[frame.subtree].forms = frame.forms;
+                }
+                if (frames.empty())
+                {
+                    stats.total = frame.usage;
+                    stats.forms = frame.forms;
+                }
+                else
+                {
+                    frames.back().usage += frame.usage;
+                    frames.back().forms += frame.forms;
+                }
+            });
+    }
+};
+
+FormMemoryStats report(const Form &form, size_t depth, const Allocator &allocator)
+{
+    FormMemoryStats stats(allocator);
+    MemoryReporter reporter(stats, depth, allocator);
+    reporter(form);
+    if (auto counting = dynamic_cast<const CountingResource *>(form.get_allocator().resource()))
+    {
+        stats.resource = counting->getCounters();
+    }
+    return stats;
+}
+
+static void writeUsage(const MemoryUsage &usage, JsonWriter &writer)
+{
+    writer.beginObject();
+    // The categories follow the layout of the containers rather than counting allocations
+    writer.key("estimated");
+    writer.value(true);
+    writer.key("keys");
+    writer.value(usage.keys);
+    writer.key("strings");
+    writer.value(usage.strings);
+    writer.key("mapNodes");
+    writer.value(usage.mapNodes);
+    writer.key("setNodes");
+    writer.value(usage.setNodes);
+    writer.key("ranges");
+    writer.value(usage.ranges);
+    writer.key("total");
+    writer.value(usage.total());
+    writer.endObject();
+}
+
+void writeJson(const FormMemoryStats &stats, JsonWriter &writer)
+{
+    writer.beginObject();
+    writer.key("total");
+    writeUsage(stats.total, writer);
+    writer.key("forms");
+    writer.value(stats.forms);
+    writer.key("sharedMaps");
+    writer.value(stats.sharedMaps);
+    if (stats.resource)
+    {
+        writer.key("resource");
+        writer.beginObject();
+        writer.key("bytes");
+        writer.value(stats.resource->bytes);
+        writer.key("peak");
+        writer.value(stats.resource->peak);
+        writer.key("allocations");
+        writer.value(stats.resource->allocations);
+        writer.key("deallocations");
+        writer.value(stats.resource->deallocations);
+        writer.endObject();
+    }
+    writer.key("subtrees");
+    writer.beginArray();
+    for (const auto &subtree : stats.subtrees)
+    {
+        writer.beginObject();
+        writer.key("path");
+        writer.value(std::string_view(toString(subtree.path)));
+        writer.key("forms");
+        writer.value(subtree.forms);
+        writer.key("usage");
+        writeUsage(subtree.usage, writer);
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.endObject();
+}
+} // namespace CanForm
@@ -0,0 +1,80 @@
+#include <atom.hpp>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace CanForm
+{
+struct AtomPool
+{
+    struct Hash
+    {
+        size_t operator()(std::string_view s) const noexcept
+        {
+            return hashKey(s);
+        }
+    };
+
+    std::mutex mutex;
+    std::pmr::monotonic_buffer_resource storage;
+    std::unordered_map<std::string_view, const AtomEntry *, Hash> entries;
+    AtomStats stats;
+
+    AtomPool() : mutex(), storage(std::pmr::new_delete_resource()), entries(), stats()
+    {
+    }
+
+    static AtomPool &get()
+    {
+        static AtomPool pool;
+        return pool;
+    }
+
+    const AtomEntry *intern(std::string_view s)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.requests;
+        stats.requestedBytes += sizeof(std::pmr::string);
+        if (s.size() >= sizeof(std::pmr::string) / 2)
+        {
+            stats.requestedBytes += s.size() + 1;
+        }
+        stats.bytes += sizeof(Atom);
+
+        auto iter = entries.find(s);
+        if (iter != entries.end())
+        {
+            return iter->second;
+        }
+
+        char *data = static_cast<char *>(storage.allocate(s.size() + 1, 1));
+        s.copy(data, s.size());
+        data[s.size()] = '\0';
+
+        AtomEntry *entry = static_cast<AtomEntry *>(storage.allocate(sizeof(AtomEntry), alignof(AtomEntry)));
+        *entry = AtomEntry{data, static_cast<uint32_t>(s.size()), hashKey(s)};
+        entries.emplace(std::string_view(data, s.size()), entry);
+
+        ++stats.atoms;
+        stats.bytes += s.size() + 1 + sizeof(AtomEntry);
+        return entry;
+    }
+};
+
+const AtomEntry *Atom::intern(std::string_view s)
+{
+    if (s.empty())
+    {
+        return &Empty;
+    }
+    return AtomPool::get().intern(s);
+}
+
+AtomStats Atom::getStats()
+{
+    auto &pool = AtomPool::get();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    return pool.stats;
+}
+} // namespace CanForm
@@ -0,0 +1,506 @@
+#include <batch.hpp>
+
+namespace CanForm
+{
+using Column = FormBatch::Column;
+
+static bool addColumns(const Form &prototype, const Form &form, FormPath &path, std::pmr::vector<Column> &columns)
+{
+    const Allocator allocator = columns.get_allocator();
+    if (auto structForm = form.getIf<StructForm>())
+    {
+        for (const auto &[key, child] : **structForm)
+        {
+            path.push_back(key);
+            const bool added = addColumns(prototype, child, path, columns);
+            path.pop_back();
+            if (!added)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    auto field = FieldRef::compile(path, prototype, allocator);
+    if (!field)
+    {
+        return false;
+    }
+    String name(allocator);
+    for (const Atom &key : path)
+    {
+        if (!name.empty())
+        {
+            name += '/';
+        }
+        name += std::string_view(key);
+    }
+
+    using Values = Column::Values;
+    Values values;
+    RangedValue bounds = Range<int8_t>(0);
+    IndexedStringSet options(allocator);
+    if (form.holds<bool>())
+    {
+        values.emplace<std::pmr::vector<uint8_t>>(allocator);
+    }
+    else if (auto range = form.getIf<RangedValue>())
+    {
+        bounds = *range;
+        std::visit(
+            [&values, &allocator](const auto &r) {
+                using T = std::decay_t<decltype(*r)>;
+                values.emplace<NumberColumn>(std::in_place_type<std::pmr::vector<T>>, allocator);
+            },
+            *range);
+    }
+    else if (form.holds<String>())
+    {
+        values.emplace<std::pmr::vector<String>>(allocator);
+    }
+    else if (auto selection = form.getIf<StringSelection>())
+    {
+        options = IndexedStringSet(selection->set, allocator);
+        values.emplace<std::pmr::vector<int32_t>>(allocator);
+    }
+    else
+    {
+        return false;
+    }
+    columns.push_back(Column{std::move(name), std::move(*field), std::move(values), bounds, std::move(options)});
+    return true;
+}
+
+// Whether the field can be stored in the column
+static bool matches(const Column &column, const Form *field) noexcept
+{
+    if (field == nullptr || (*field)->index() != column.getAlternative())
+    {
+        return false;
+    }
+    if (auto range = field->getIf<RangedValue>())
+    {
+        return range->index() == column.bounds.index();
+    }
+    return true;
+}
+
+static void store(Column &column, size_t record, const Form &field)
+{
+    std::visit(
+        [record, &field](auto &values) {
+            using V = std::decay_t<decltype(values)>;
+            if constexpr (std::is_same_v<V, NumberColumn>)
+            {
+                std::visit(
+                    [record, &field](auto &numbers) {
+                        using T = typename std::decay_t<decltype(numbers)>::value_type;
+                        numbers[record] = *std::get<Range<T>>(field.get<RangedValue>());
+                    },
+                    values);
+            }
+            else if constexpr (std::is_same_v<V, std::pmr::vector<uint8_t>>)
+            {
+                values[record] = field.get<bool>() ? 1 : 0;
+            }
+            else if constexpr (std::is_same_v<V, std::pmr::vector<String>>)
+            {
+                values[record] = field.get<String>();
+            }
+            else
+            {
+                values[record] = field.get<StringSelection>().index;
+            }
+        },
+        column.values);
+}
+
+static void load(const Column &column, size_t record, Form &field)
+{
+    std::visit(
+        [&column, record, &field](const auto &values) {
+            using V = std::decay_t<decltype(values)>;
+            if constexpr (std::is_same_v<V, NumberColumn>)
+            {
+                std::visit(
+                    [&column, record, &field](const auto &numbers) {
+                        using T = typename std::decay_t<decltype(numbers)>::value_type;
+                        auto range = std::get<Range<T>>(column.bounds);
+                        *range.operator->() = numbers[record];
+                        field.emplace<RangedValue>(range);
+                    },
+                    values);
+            }
+            else if constexpr (std::is_same_v<V, std::pmr::vector<uint8_t>>)
+            {
+                field = values[record] != 0;
+            }
+            else if constexpr (std::is_same_v<V, std::pmr::vector<String>>)
+            {
+                field.emplace<String>(values[record]);
+            }
+            else
+            {
+                field.get<StringSelection>().index = values[record];
+            }
+        },
+        column.values);
+}
+
+FormBatch::FormBatch(Form &&p, std::pmr::vector<Column> &&c) : prototype(std::move(p)), columns(std::move(c)), count(0)
+{
+}
+
+std::optional<FormBatch> FormBatch::create(const Form &prototype, const allocator_type &allocator)
+{
+    if (!prototype.holds<StructForm>())
+    {
+        return std::nullopt;
+    }
+    std::pmr::vector<Column> columns(allocator);
+    FormPath path(allocator);
+    if (!addColumns(prototype, prototype, path, columns))
+    {
+        return std::nullopt;
+    }
+    return FormBatch(Form(prototype, allocator), std::move(columns));
+}
+
+std::optional<size_t> FormBatch::find(std::string_view name) const noexcept
+{
+    for (size_t i = 0; i < columns.size(); ++i)
+    {
+        if (columns[i].name == name)
+        {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+void FormBatch::resize(size_t n)
+{
+    const size_t old = count;
+    for (Column &column : columns)
+    {
+        std::visit(
+            [n](auto &values) {
+                if constexpr (std::is_same_v<std::decay_t<decltype(values)>, NumberColumn>)
+                {
+                    std::visit([n](auto &numbers) { numbers.resize(n); }, values);
+                }
+                else
+                {
+                    values.resize(n);
+                }
+            },
+            column.values);
+        const Form &field = *column.field.resolve(prototype);
+        for (size_t record = old; record < n; ++record)
+        {
+            store(column, record, field);
+        }
+    }
+    count = n;
+}
+
+void FormBatch::erase(size_t record)
+{
+    for (Column &column : columns)
+    {
+        std::visit(
+            [record](auto &values) {
+                if constexpr (std::is_same_v<std::decay_t<decltype(values)>, NumberColumn>)
+                {
+                    std::visit([record](auto &numbers) { numbers.erase(numbers.begin() + record); }, values);
+                }
+                else
+                {
+                    values.erase(values.begin() + record);
+                }
+            },
+            column.values);
+    }
+    --count;
+}
+
+bool FormBatch::append(const Form &form)
+{
+    for (const Column &column : columns)
+    {
+        if (!matches(column, column.field.resolve(form)))
+        {
+            return false;
+        }
+    }
+    resize(count + 1);
+    for (Column &column : columns)
+    {
+        store(column, count - 1, *column.field.resolve(form));
+    }
+    return true;
+}
+
+Form FormBatch::get(size_t record, const allocator_type &allocator) const
+{
+    Form form(prototype, allocator);
+    for (const Column &column : columns)
+    {
+        load(column, record, *column.field.resolve(form));
+    }
+    return form;
+}
+
+bool FormBatch::set(size_t record, const Form &form)
+{
+    for (const Column &column : columns)
+    {
+        if (!matches(column, column.field.resolve(form)))
+        {
+            return false;
+        }
+    }
+    for (Column &column : columns)
+    {
+        store(column, record, *column.field.resolve(form));
+    }
+    return true;
+}
+
+std::optional<double> FormBatch::setNumber(size_t i, size_t record, double d)
+{
+    Column &column = columns[i];
+    return std::visit(
+        [&column, record, d](auto &values) -> std::optional<double> {
+            using V = std::decay_t<decltype(values)>;
+            if constexpr (std::is_same_v<V, NumberColumn>)
+            {
+                return std::visit(
+                    [&column, record, d](auto &numbers) {
+                        using T = typename std::decay_t<decltype(numbers)>::value_type;
+                        const auto [min, max] = std::get<Range<T>>(column.bounds).getMinMax();
+                        numbers[record] = convertNumber(d, min, max).value_or(numbers[record]);
+                        return static_cast<double>(numbers[record]);
+                    },
+                    values);
+            }
+            else if constexpr (std::is_same_v<V, std::pmr::vector<uint8_t>>)
+            {
+                values[record] = d != 0 ? 1 : 0;
+                return values[record];
+            }
+            else if constexpr (std::is_same_v<V, std::pmr::vector<int32_t>>)
+            {
+                const int32_t last = static_cast<int32_t>(std::max<size_t>(column.options.size(), 1) - 1);
+                values[record] = convertNumber(d, 0, last).value_or(values[record]);
+                return values[record];
+            }
+            else
+            {
+                return std::nullopt;
+            }
+        },
+        column.values);
+}
+
+std::optional<double> FormBatch::getNumber(size_t i, size_t record) const noexcept
+{
+    return std::visit(
+        [record](const auto &values) -> std::optional<double> {
+            using V = std::decay_t<decltype(values)>;
+            if constexpr (std::is_same_v<V, NumberColumn>)
+            {
+                return std::visit([record](const auto &numbers) { return static_cast<double>(numbers[record]); },
+                                  values);
+            }
+            else if constexpr (std::is_same_v<V, std::pmr::vector<String>>)
+            {
+                return std::nullopt;
+            }
+            else
+            {
+                return static_cast<double>(values[record]);
+            }
+        },
+        columns[i].values);
+}
+
+bool FormBatch::setNumberFromChars(size_t i, size_t record, std::string_view text)
+{
+    Column &column = columns[i];
+    auto numbers = std::get_if<NumberColumn>(&column.values);
+    if (numbers == nullptr)
+    {
+        return false;
+    }
+    return std::visit(
+        [&column, record, text](auto &values) {
+            using T = typename std::decay_t<decltype(values)>::value_type;
+            const auto [min, max] = std::get<Range<T>>(column.bounds).getMinMax();
+            if (auto t = parseNumber(text, min, max))
+            {
+                values[record] = *t;
+                return true;
+            }
+            return false;
+        },
+        *numbers);
+}
+
+char *FormBatch::numberToChars(size_t i, size_t record, char *first, char *last) const noexcept
+{
+    auto numbers = std::get_if<NumberColumn>(&columns[i].values);
+    if (numbers == nullptr)
+    {
+        return nullptr;
+    }
+    return std::visit([record, first, last](const auto &values) { return formatNumber(first, last, values[record]); },
+                      *numbers);
+}
+
+bool FormBatch::setString(size_t i, size_t record, std::string_view s)
+{
+    Column &column = columns[i];
+    if (auto strings = std::get_if<std::pmr::vector<String>>(&column.values))
+    {
+        (*strings)[record] = s;
+        return true;
+    }
+    if (auto indices = std::get_if<std::pmr::vector<int32_t>>(&column.values))
+    {
+        const size_t index = column.options.indexOf(s);
+        if (index == IndexedStringSet::npos)
+        {
+            return false;
+        }
+        (*indices)[record] = static_cast<int32_t>(index);
+        return true;
+    }
+    return false;
+}
+
+std::optional<std::string_view> FormBatch::getString(size_t i, size_t record) const noexcept
+{
+    const Column &column = columns[i];
+    if (auto strings = std::get_if<std::pmr::vector<String>>(&column.values))
+    {
+        return (*strings)[record];
+    }
+    if (auto indices = std::get_if<std::pmr::vector<int32_t>>(&column.values))
+    {
+        const int32_t index = (*indices)[record];
+        if (0 <= index && static_cast<size_t>(index) < column.options.size())
+        {
+            return column.options[index];
+        }
+    }
+    return std::nullopt;
+}
+
+size_t FormBatch::validate(size_t i, std::pmr::vector<size_t> &records) const
+{
+    const Column &column = columns[i];
+    const size_t before = records.size();
+    std::visit(
+        [&column, &records](const auto &values) {
+            using V = std::decay_t<decltype(values)>;
+            if constexpr (std::is_same_v<V, NumberColumn>)
+            {
+                std::visit(
+                    [&column, &records](const auto &numbers) {
+                        using T = typename std::decay_t<decltype(numbers)>::value_type;
+                        const auto [min, max] = std::get<Range<T>>(column.bounds).getMinMax();
+                        for (size_t record = 0; record < numbers.size(); ++record)
+                        {
+                            if (numbers[record] < min || max < numbers[record])
+                            {
+                                records.push_back(record);
+                            }
+                        }
+                    },
+                    values);
+            }
+            else if constexpr (std::is_same_v<V, std::pmr::vector<int32_t>>)
+            {
+                const int32_t n = static_cast<int32_t>(column.options.size());
+                for (size_t record = 0; record < values.size(); ++record)
+                {
+                    if (values[record] < 0 || n <= values[record])
+                    {
+                        records.push_back(record);
+                    }
+                }
+            }
+            else if constexpr (std::is_same_v<V, std::pmr::vector<uint8_t>>)
+            {
+                for (size_t record = 0; record < values.size(); ++record)
+                {
+                    if (values[record] > 1)
+                    {
+                        records.push_back(record);
+                    }
+                }
+            }
+        },
+        column.values);
+    return records.size() - before;
+}
+
+size_t FormBatch::clamp(size_t i)
+{
+    Column &column = columns[i];
+    return std::visit(
+        [&column](auto &values) -> size_t {
+            using V = std::decay_t<decltype(values)>;
+            size_t changed = 0;
+            if constexpr (std::is_same_v<V, NumberColumn>)
+            {
+                std::visit(
+                    [&column, &changed](auto &numbers) {
+                        using T = typename std::decay_t<decltype(numbers)>::value_type;
+                        const auto [min, max] = std::get<Range<T>>(column.bounds).getMinMax();
+                        for (T &t : numbers)
+                        {
+                            const T clamped = std::clamp(t, min, max);
+                            changed += clamped != t;
+                            t = clamped;
+                        }
+                    },
+                    values);
+            }
+            else if constexpr (std::is_same_v<V, std::pmr::vector<int32_t>>)
+            {
+                const int32_t n = static_cast<int32_t>(column.options.size());
+                for (int32_t &index : values)
+                {
+                    if (index < 0 || n <= index)
+                    {
+                        index = 0;
+                        ++changed;
+                    }
+                }
+            }
+            else if constexpr (std::is_same_v<V, std::pmr::vector<uint8_t>>)
+            {
+                for (uint8_t &flag : values)
+                {
+                    changed += flag > 1;
+                    flag = flag != 0;
+                }
+            }
+            return changed;
+        },
+        column.values);
+}
+
+size_t FormBatch::clamp()
+{
+    size_t changed = 0;
+    for (size_t i = 0; i < columns.size(); ++i)
+    {
+        changed += clamp(i);
+    }
+    return changed;
+}
+} // namespace CanForm
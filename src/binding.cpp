@@ -0,0 +1,23 @@
+#include <binding.hpp>
+
+namespace CanForm
+{
+std::vector<std::string_view> splitBindingNames(std::string_view names)
+{
+    std::vector<std::string_view> result;
+    while (!names.empty())
+    {
+        const size_t comma = names.find(',');
+        std::string_view name = names.substr(0, comma);
+        const size_t first = name.find_first_not_of(" \t\r\n");
+        const size_t last = name.find_last_not_of(" \t\r\n");
+        result.push_back(first == std::string_view::npos ? std::string_view() : name.substr(first, last - first + 1));
+        if (comma == std::string_view::npos)
+        {
+            break;
+        }
+        names.remove_prefix(comma + 1);
+    }
+    return result;
+}
+} // namespace CanForm
@@ -0,0 +1,312 @@
+#include <computed.hpp>
+#include <hash.hpp>
+#include <tracker.hpp>
+
+#include <algorithm>
+
+namespace CanForm
+{
+// Whether one path is the other or lies below it
+static bool related(const FormPath &a, const FormPath &b) noexcept
+{
+    const size_t n = std::min(a.size(), b.size());
+    return std::equal(a.begin(), a.begin() + n, b.begin());
+}
+
+// Calls f with every entry of a map keyed by paths whose path is the given one or above or below it
+template <typename Map, typename F> static void forRelated(Map &map, const FormPath &path, F &&f)
+{
+    FormPath prefix(path.get_allocator());
+    prefix.reserve(path.size());
+    for (size_t i = 0;; ++i)
+    {
+        auto iter = map.find(prefix);
+        if (iter != map.end())
+        {
+            f(iter->second);
+        }
+        if (i == path.size())
+        {
+            break;
+        }
+        prefix.push_back(path[i]);
+    }
+
+    // Paths below it sort right after it
+    for (auto iter = map.upper_bound(path); iter != map.end() && related(iter->first, path); ++iter)
+    {
+        f(iter->second);
+    }
+}
+
+ComputedFields::ComputedFields(const allocator_type &allocator)
+    : fields(allocator), order(allocator), readers(allocator), targets(allocator), sorted(true), updating(false)
+{
+}
+
+bool ComputedFields::add(std::string_view target, std::initializer_list<std::string_view> inputs, Compute compute)
+{
+    std::pmr::vector<FormPath> paths(get_allocator());
+    paths.reserve(inputs.size());
+    for (auto input : inputs)
+    {
+        paths.push_back(toPath(input, get_allocator()));
+    }
+    return add(toPath(target, get_allocator()), paths, std::move(compute));
+}
+
+bool ComputedFields::add(const FormPath &target, const std::pmr::vector<FormPath> &inputs, Compute compute)
+{
+    if (targets.find(target) != targets.end() ||
+        std::any_of(inputs.begin(), inputs.end(), [&target](const FormPath &input) { return related(input, target); }))
+    {
+        return false;
+    }
+
+    const uint32_t index = static_cast<uint32_t>(fields.size());
+    std::pmr::vector<uint32_t> dependents(get_allocator());
+    forRelated(readers, target, [&dependents](const std::pmr::vector<uint32_t> &list) {
+        dependents.insert(dependents.end(), list.begin(), list.end());
+    });
+    std::pmr::vector<uint32_t> sources(get_allocator());
+    for (const FormPath &input : inputs)
+    {
+        forRelated(targets, input, [&sources](uint32_t i) { sources.push_back(i); });
+    }
+    // The new field would depend on itself if a field it reads already depends on it
+    for (uint32_t d : dependents)
+    {
+        if (reaches(d, sources))
+        {
+            return false;
+        }
+    }
+
+    for (uint32_t source : sources)
+    {
+        fields[source].dependents.push_back(index);
+    }
+    fields.push_back(Field{FormPath(target, get_allocator()), std::pmr::vector<FormPath>(inputs, get_allocator()),
+                           std::move(compute), std::move(dependents), true});
+    for (const FormPath &input : inputs)
+    {
+        readers[input].push_back(index);
+    }
+    targets.emplace(target, index);
+    sorted = false;
+    return true;
+}
+
+bool ComputedFields::reaches(uint32_t from, const std::pmr::vector<uint32_t> &to) const
+{
+    if (to.empty())
+    {
+        return false;
+    }
+    std::pmr::vector<bool> visited(fields.size(), false, get_allocator());
+    std::pmr::vector<uint32_t> stack(1, from, get_allocator());
+    while (!stack.empty())
+    {
+        const uint32_t i = stack.back();
+        stack.pop_back();
+        if (visited[i])
+        {
+            continue;
+        }
+        if (std::find(to.begin(), to.end(), i) != to.end())
+        {
+            return true;
+        }
+        visited[i] = true;
+        stack.insert(stack.end(), fields[i].dependents.begin(), fields[i].dependents.end());
+    }
+    return false;
+}
+
+void ComputedFields::sort()
+{
+    std::pmr::vector<uint32_t> incoming(fields.size(), 0, get_allocator());
+    for (const Field &field : fields)
+    {
+        for (uint32_t d : field.dependents)
+        {
+            ++incoming[d];
+        }
+    }
+    order.clear();
+    for (uint32_t i = 0; i < fields.size(); ++i)
+    {
+        if (incoming[i] == 0)
+        {
+            order.push_back(i);
+        }
+    }
+    // order doubles as the queue
+    for (size_t next = 0; next < order.size(); ++next)
+    {
+        for (uint32_t d : fields[order[next]].dependents)
+        {
+            if (--incoming[d] == 0)
+            {
+                order.push_back(d);
+            }
+        }
+    }
+    sorted = true;
+}
+
+void ComputedFields::markReaders(const FormPath &path)
+{
+    forRelated(readers, path, [this](const std::pmr::vector<uint32_t> &list) {
+        for (uint32_t i : list)
+        {
+            fields[i].dirty = true;
+        }
+    });
+}
+
+size_t ComputedFields::dirtyCount() const noexcept
+{
+    return std::count_if(fields.begin(), fields.end(), [](const Field &f) { return f.dirty; });
+}
+
+void ComputedFields::invalidate(const FormPath &path)
+{
+    markReaders(path);
+}
+
+void ComputedFields::invalidate() noexcept
+{
+    for (Field &field : fields)
+    {
+        field.dirty = true;
+    }
+}
+
+// Cached hashes of the target and the forms above it
+static void invalidatePath(const Form &root, const FormPath &path)
+{
+    FormPath prefix(path.get_allocator());
+    for (size_t i = 0;; ++i)
+    {
+        if (const Form *form = resolve(root, prefix))
+        {
+            form->invalidate();
+        }
+        if (i == path.size())
+        {
+            break;
+        }
+        prefix.push_back(path[i]);
+    }
+}
+
+size_t ComputedFields::update(Form &root, FormTracker *tracker, const Changed &onChanged)
+{
+    if (updating)
+    {
+        return 0;
+    }
+    struct Running
+    {
+        bool &flag;
+        ~Running()
+        {
+            flag = false;
+        }
+    } running{updating};
+    updating = true;
+    if (!sorted)
+    {
+        sort();
+    }
+
+    size_t count = 0;
+    Inputs inputs(get_allocator());
+    for (uint32_t index : order)
+    {
+        Field &field = fields[index];
+        if (!field.dirty)
+        {
+            continue;
+        }
+        field.dirty = false;
+        Form *target = resolve(root, field.target);
+        if (target == nullptr)
+        {
+            continue;
+        }
+
+        inputs.clear();
+        for (const FormPath &path : field.inputs)
+        {
+            inputs.push_back(resolve(static_cast<const Form &>(root), path));
+        }
+        const Form before(*target);
+        field.compute(inputs, *target);
+        invalidatePath(root, field.target);
+        if (equal(before, *target))
+        {
+            continue;
+        }
+
+        ++count;
+        for (uint32_t d : field.dependents)
+        {
+            fields[d].dirty = true;
+        }
+        if (tracker != nullptr)
+        {
+            tracker->touch(target);
+        }
+        if (onChanged)
+        {
+            onChanged(field.target, *target);
+        }
+    }
+    return count;
+}
+
+size_t ComputedFields::changed(const FormPath &path, Form &root, FormTracker *tracker, const Changed &onChanged)
+{
+    if (updating)
+    {
+        return 0;
+    }
+    markReaders(path);
+    return update(root, tracker, onChanged);
+}
+
+std::optional<double> ComputedFields::number(const Form *form) noexcept
+{
+    if (form == nullptr)
+    {
+        return std::nullopt;
+    }
+    if (auto b = form->getIf<bool>())
+    {
+        return *b ? 1.0 : 0.0;
+    }
+    if (auto value = form->getIf<RangedValue>())
+    {
+        return std::visit([](const auto &range) { return static_cast<double>(*range); }, *value);
+    }
+    return std::nullopt;
+}
+
+bool ComputedFields::setNumber(Form &form, double d) noexcept
+{
+    if (auto b = form.getIf<bool>())
+    {
+        *b = d != 0;
+        return true;
+    }
+    if (auto value = form.getIf<RangedValue>())
+    {
+        // Converted by convertNumber, so values beyond the bounds clamp and integers round
+        std::visit([d](auto &range) { range.setFromDouble(d); }, *value);
+        return true;
+    }
+    return false;
+}
+} // namespace CanForm
@@ -37,6 +37,7 @@ int FormVisitor::operator()(bool &b)
             let id = $0;
             let value = $1;
             let addr = $2;
+            let tracker = $3;
 
             let div = document.getElementById('div_' + id.toString());
 
@@ -46,11 +47,13 @@ int FormVisitor::operator()(bool &b)
             input.checked = value ? true : false;
             input.onchange = function()
             {
+                Module.ccall('prepareChange', null, [ 'number', 'number' ], [ tracker, addr ]);
                 Module.ccall('updateBoolean', null, [ 'number', 'boolean' ], [ addr, input.checked ]);
+                Module.ccall('trackChange', null, [ 'number', 'number' ], [ tracker, addr ]);
             };
             div.append(input);
         },
-        id, b, &b);
+        id, b, &b, tracker);
     return id;
 }
 
@@ -67,6 +70,7 @@ int FormVisitor::operator()(StringMap &map)
                 let flag = $2;
                 let index = $3;
                 let addr = $4;
+                let tracker = $5;
 
                 let div = document.getElementById('div_' + id.toString());
 
@@ -82,18 +86,20 @@ int FormVisitor::operator()(StringMap &map)
                 input.checked = flag;
                 input.onchange = function()
                 {
+                    Module.ccall('prepareChange', null, [ 'number', 'number' ], [ tracker, addr ]);
                     Module.ccall('updateBoolean', null, [ 'number', 'boolean' ], [ addr, input.checked ]);
+                    Module.ccall('trackChange', null, [ 'number', 'number' ], [ tracker, addr ]);
                 };
                 div.append(input);
 
                 div.append(document.createElement("br"));
             },
-            id, name.c_str(), flag, index++, &flag);
+            id, name.c_str(), flag, index++, &flag, tracker);
     }
     return id;
 }
 
-int FormVisitor::operator()(String &s)
+int FormVisitor::textArea(const char *value, void *address, const char *update)
 {
     const int id = makeDiv();
     EM_ASM(
@@ -101,6 +107,8 @@ int FormVisitor::operator()(String &s)
             let id = $0;
             let value = UTF8ToString($1);
             let addr = $2;
+            let tracker = $3;
+            let update = UTF8ToString($4);
 
             let div = document.getElementById('div_' + id.toString());
 
@@ -110,7 +118,9 @@ int FormVisitor::operator()(String &s)
             textarea.value = value;
             textarea.onchange = function()
             {
-                Module.ccall('updateString', null, [ 'number', 'number' ], [ addr, stringToNewUTF8(textarea.value) ]);
+                Module.ccall('prepareChange', null, [ 'number', 'number' ], [ tracker, addr ]);
+                Module.ccall(update, null, [ 'number', 'number' ], [ addr, stringToNewUTF8(textarea.value) ]);
+                Module.ccall('trackChange', null, [ 'number', 'number' ], [ tracker, addr ]);
             };
             textarea.onkeypress = function()
             {
@@ -126,10 +136,20 @@ int FormVisitor::operator()(String &s)
             };
             div.append(textarea);
         },
-        id, s.c_str(), &s);
+        id, value, address, tracker, update);
     return id;
 }
 
+int FormVisitor::operator()(String &s)
+{
+    return textArea(s.c_str(), &s, "updateString");
+}
+
+int FormVisitor::operator()(std::string &s)
+{
+    return textArea(s.c_str(), &s, "updateStdString");
+}
+
 int FormVisitor::operator()(ComplexString &s)
 {
     const int id = operator()(s.string);
@@ -174,18 +194,115 @@ int FormVisitor::operator()(ComplexString &s)
     return id;
 }
 
+// Exact text of a number for the inputs
+struct NumberText
+{
+    char data[NumberChars + 1];
+
+    template <typename T> explicit NumberText(T t) noexcept
+    {
+        char *end = formatNumber(data, data + NumberChars, t);
+        *(end == nullptr ? data : end) = '\0';
+    }
+};
+
+// Writes the value of a range to a buffer that stays valid until the next call
+template <typename R> static const char *rangeText(const R &range)
+{
+    static char buffer[NumberChars + 1];
+    char *end = range.toChars(buffer, buffer + NumberChars);
+    *(end == nullptr ? buffer : end) = '\0';
+    return buffer;
+}
+
+int FormVisitor::numberInput(const char *value, const char *min, const char *max, bool integer, void *address,
+                             const char *update)
+{
+    const int id = makeDiv();
+    EM_ASM(
+        {
+            let id = $0;
+            let value = UTF8ToString($1);
+            let integer = $4;
+            // Integers go through BigInt so 64 bit values stay exact
+            let min = integer ? BigInt(UTF8ToString($2)) : parseFloat(UTF8ToString($2));
+            let max = integer ? BigInt(UTF8ToString($3)) : parseFloat(UTF8ToString($3));
+            let r = $5;
+            let tracker = $6;
+            let update = UTF8ToString($7);
+
+            let div = document.getElementById('div_' + id.toString());
+
+            let input = document.createElement('input');
+            input.type = 'text';
+            input.inputMode = integer ? 'numeric' : 'decimal';
+            input.value = value;
+            input.title = min.toString() + ' to ' + max.toString();
+            // The change is prepared and tracked only if the text is a number
+            let send = function()
+            {
+                return Module.ccall(update, 'string', [ 'number', 'number', 'string' ], [ tracker, r, input.value ]);
+            };
+            // Partial text such as '-' is kept while typing; the clamped value is shown once the edit is done
+            input.oninput = function()
+            {
+                send();
+            };
+            input.onchange = function()
+            {
+                input.value = send();
+            };
+            input.onkeydown = function(e)
+            {
+                if (e.key != 'ArrowUp' && e.key != 'ArrowDown')
+                {
+                    return;
+                }
+                e.preventDefault();
+                let step = e.key == 'ArrowUp' ? 1 : -1;
+                try
+                {
+                    let v = integer ? BigInt(input.value.trim()) + BigInt(step) : parseFloat(input.value) + step;
+                    if (!integer && isNaN(v))
+                    {
+                        return;
+                    }
+                    input.value = (v < min ? min : v > max ? max : v).toString();
+                }
+                catch (_)
+                {
+                    return;
+                }
+                input.value = send();
+            };
+            div.append(input);
+        },
+        id, value, min, max, integer, address, tracker, update);
+    return id;
+}
+
 int FormVisitor::operator()(RangedValue &n)
 {
-    return std::visit(*this, n);
+    return std::visit(
+        [this, &n](const auto &range) {
+            using T = std::decay_t<decltype(*range)>;
+            const auto [min, max] = range.getMinMax();
+            return numberInput(NumberText(*range).data, NumberText(min).data, NumberText(max).data,
+                               std::is_integral_v<T>, &n, "updateRangeText");
+        },
+        n);
 }
 
-int FormVisitor::operator()(StringSet &set)
+int FormVisitor::editableSet(void *address, const char *add, const char *update)
 {
     const int id = makeDiv();
     EM_ASM(
         {
             let id = $0;
             let addr = $1;
+            let tracker = $2;
+            let add = UTF8ToString($3);
+            let update = UTF8ToString($4);
 
             let div = document.getElementById('div_' + id.toString());
             let content = document.createElement("div");
@@ -198,24 +315,120 @@ int FormVisitor::operator()(StringSet &set)
             button.innerText = 'Add';
             button.onclick = function()
             {
-                Module.ccall('addToStringSet', null, [ 'number', 'number' ], [ addr, 0 ]);
-                Module.ccall('updateStringSetDiv', null, [ 'number', 'number' ], [ addr, id ]);
+                Module.ccall('prepareChange', null, [ 'number', 'number' ], [ tracker, addr ]);
+                Module.ccall(add, null, [ 'number', 'number' ], [ addr, 0 ]);
+                Module.ccall('trackChange', null, [ 'number', 'number' ], [ tracker, addr ]);
+                Module.ccall(update, null, [ 'number', 'number', 'number' ], [ addr, id, tracker ]);
             };
             div.append(button);
         },
-        id, &set);
+        id, address, tracker, add, update);
+    return id;
+}
 
-    updateStringSetDiv(set, id);
+int FormVisitor::operator()(StringSet &set)
+{
+    const int id = editableSet(&set, "addToStringSet", "updateStringSetDiv");
+    updateStringSetDiv(set, id, tracker);
+    return id;
+}
+
+int FormVisitor::operator()(std::set<std::string> &set)
+{
+    const int id = editableSet(&set, "addToStdStringSet", "updateStdStringSetDiv");
+    updateStdStringSetDiv(set, id, tracker);
+    return id;
+}
+
+// Shows PickerRows options of the provider at a time, starting at the first one that matches the search
+int FormVisitor::optionPicker(StringSelection &selection)
+{
+    const int id = makeDiv();
+    EM_ASM(
+        {
+            let id = $0;
+            let addr = $1;
+            let tracker = $2;
+            let rows = $3;
+
+            let div = document.getElementById('div_' + id.toString());
+
+            function show(first)
+            {
+                Module.ccall('showOptions', null, [ 'number', 'number', 'number' ], [ addr, id, first ]);
+            };
+
+            let search = document.createElement('input');
+            search.type = 'search';
+            search.id = 'search_' + id.toString();
+            search.value = UTF8ToString($4, $5);
+            search.oninput = function()
+            {
+                let i = Module.ccall('findOption', 'number', [ 'number', 'number' ],
+                                     [ addr, stringToNewUTF8(search.value) ]);
+                if (i >= 0)
+                {
+                    show(i);
+                }
+            };
+            div.append(search);
+
+            let select = document.createElement('select');
+            select.id = 'select_' + id.toString();
+            select.size = rows;
+            select.dataset.first = '0';
+            select.style.display = 'block';
+            select.onchange = function()
+            {
+                let i = parseInt(select.dataset.first) + select.selectedIndex;
+                Module.ccall('prepareChange', null, [ 'number', 'number' ], [ tracker, addr ]);
+                if (Module.ccall('selectOption', 'boolean', [ 'number', 'number' ], [ addr, i ]))
+                {
+                    search.value = select.value;
+                    Module.ccall('trackChange', null, [ 'number', 'number' ], [ tracker, addr ]);
+                }
+            };
+            div.append(select);
+
+            let navigation = document.createElement('div');
+            let previous = document.createElement('button');
+            previous.innerText = 'Previous';
+            previous.id = 'previous_' + id.toString();
+            previous.onclick = function()
+            {
+                show(Math.max(0, parseInt(select.dataset.first) - rows));
+            };
+            navigation.append(previous);
+            let label = document.createElement('span');
+            label.id = 'page_' + id.toString();
+            navigation.append(label);
+            let next = document.createElement('button');
+            next.innerText = 'Next';
+            next.id = 'next_' + id.toString();
+            next.onclick = function()
+            {
+                show(parseInt(select.dataset.first) + rows);
+            };
+            navigation.append(next);
+            div.append(navigation);
+        },
+        id, &selection, tracker, PickerRows, selection.key.data(), selection.key.size());
+    showOptions(selection, id, selection.valid() ? selection.index : 0);
     return id;
 }
 
 int FormVisitor::operator()(StringSelection &selection)
 {
+    if (selection.provider != nullptr)
+    {
+        return optionPicker(selection);
+    }
     const int id = makeDiv();
     EM_ASM(
         {
             let id = $0;
             let addr = $1;
+            let tracker = $2;
 
             let div = document.getElementById('div_' + id.toString());
 
@@ -223,11 +436,13 @@ int FormVisitor::operator()(StringSelection &selection)
             select.id = 'select_' + id.toString();
             select.onchange = function()
             {
+                Module.ccall('prepareChange', null, [ 'number', 'number' ], [ tracker, addr ]);
                 setValue(addr, parseInt(select.selectedIndex), 'i32');
+                Module.ccall('trackChange', null, [ 'number', 'number' ], [ tracker, addr ]);
             };
             div.append(select);
         },
-        id, &selection.index);
+        id, &selection.index, tracker);
     int i = selection.index;
     for (auto &item : selection.set)
     {
@@ -254,13 +469,15 @@ int FormVisitor::operator()(StringSelection &selection)
     return id;
 }
 
+// Only the selected alternative is in the DOM. Choosing another one replaces it through selectVariantForm.
 int FormVisitor::operator()(VariantForm &variant)
 {
     const int id = makeDiv();
     EM_ASM(
         {
             let id = $0;
-            let addr = $1;
+            let visitor = $1;
+            let addr = $2;
 
             let div = document.getElementById('div_' + id);
 
@@ -268,71 +485,65 @@ int FormVisitor::operator()(VariantForm &variant)
             select.id = 'select_' + id.toString();
             select.onchange = function()
             {
-                for (let child of div.getElementsByClassName("tabContent"))
-                {
-                    child.classList.remove("active");
-                }
-                let outer = document.getElementById(select.value);
-                outer.classList.add("active");
-                for (let option of select.children)
-                {
-                    if (option.selected)
-                    {
-                        Module.ccall('updateVariantForm', null, [ 'number', 'number' ],
-                                     [ addr, stringToNewUTF8(option.innerText) ]);
-                        break;
-                    }
-                }
+                Module.ccall('selectVariantForm', null, [ 'number', 'number', 'number', 'number' ],
+                             [ visitor, addr, id, stringToNewUTF8(select.value) ]);
             };
             div.append(select);
-            setTimeout(
-                function() { select.onchange(); }, 10);
+
+            let content = document.createElement("div");
+            content.id = 'variant_' + id.toString();
+            div.append(content);
         },
-        id, &variant);
-    name = std::string_view();
-    for (auto &[n, form] : variant.map)
+        id, this, &variant);
+    for (const auto &[n, _] : *std::as_const(variant))
     {
-        const int inner = std::visit(*this, *form);
         EM_ASM(
             {
-                let id = $0;
-                let inner = $1;
-                let title = UTF8ToString($2);
-                let selected = $3;
-
-                let div = document.getElementById('div_' + id);
-
-                let select = document.getElementById('select_' + id.toString());
+                let select = document.getElementById('select_' + $0.toString());
                 let option = document.createElement("option");
-                option.innerText = title;
+                option.innerText = UTF8ToString($1);
+                option.value = option.innerText;
                 select.append(option);
-
-                let outer = document.createElement("div");
-                outer.id = 'option_' + inner.toString();
-                outer.classList.add("tabContent");
-                div.append(outer);
-
-                option.value = outer.id;
-
-                let div2 = document.getElementById('div_' + inner);
-                div2.remove();
-                outer.append(div2);
-
-                if (selected)
+                if ($2)
                 {
-                    select.value = title;
-                    outer.classList.add('active');
+                    select.value = option.value;
                 }
             },
-            id, inner, n.c_str(), variant.selected == n);
+            id, n.c_str(), variant.selected == n);
     }
+    select(variant, id, Atom(variant.selected));
     return id;
 }
 
-int FormVisitor::operator()(StructForm &structForm)
+void FormVisitor::select(VariantForm &variant, int id, const Atom &key)
+{
+    // The divs of the alternative that is shown now are removed with it
+    auto shown = std::as_const(variant)->find(Atom(variant.selected));
+    if (shown != std::as_const(variant)->end())
+    {
+        FormWalker().walk(shown->second, [this](const FormWalker::Step &step) { divs.erase(step.form); });
+    }
+
+    Form *form = selectAlternative(tracker, variant, key);
+
+    EM_ASM({ document.getElementById('variant_' + $0.toString()).replaceChildren(); }, id);
+    if (form == nullptr)
+    {
+        return;
+    }
+    showInside(*form, std::string_view(), [id](int inner) {
+        EM_ASM(
+            {
+                let div = document.getElementById('div_' + $1.toString());
+                div.remove();
+                document.getElementById('variant_' + $0.toString()).append(div);
+            },
+            id, inner);
+    });
+}
+
+int FormVisitor::openGrid(size_t columns)
 {
-    const String origName(name);
-    const bool useExpander = !name.empty();
     const int id = rand();
     EM_ASM(
         {
@@ -354,25 +565,29 @@ int FormVisitor::operator()(StructForm &structForm)
             div.style.gridTemplateColumns = repeat(columns);
             document.body.append(div);
         },
-        id, structForm.columns);
-    for (auto &[n, form] : *structForm)
-    {
-        name = n;
-        const int i = std::visit(*this, *form);
-        EM_ASM(
-            {
-                let parent = $0;
-                let child = $1;
+        id, columns);
+    return id;
+}
 
-                let div = document.getElementById('div_' + parent.toString());
-                let div2 = document.getElementById('div_' + child.toString());
+void FormVisitor::attach(int parent, int child)
+{
+    EM_ASM(
+        {
+            let parent = $0;
+            let child = $1;
 
-                div2.remove();
-                div.append(div2);
-            },
-            id, i);
-    }
-    if (!useExpander)
+            let div = document.getElementById('div_' + parent.toString());
+            let div2 = document.getElementById('div_' + child.toString());
+
+            div2.remove();
+            div.append(div2);
+        },
+        parent, child);
+}
+
+int FormVisitor::expander(int id, const String &title)
+{
+    if (title.empty())
     {
         return id;
     }
@@ -402,14 +617,63 @@ int FormVisitor::operator()(StructForm &structForm)
             form.remove();
             div.append(form);
         },
-        id, divId, origName.c_str());
+        id, divId, title.c_str());
     return divId;
 }
 
+// visit sets the name of a field and returns the id of its div
+template <typename Fields, typename F> int FormVisitor::grid(size_t columns, Fields &fields, F &&visit)
+{
+    const String origName(name);
+    const int id = openGrid(columns);
+    for (auto &field : fields)
+    {
+        attach(id, visit(field));
+    }
+    return expander(id, origName);
+}
+
+int FormVisitor::operator()(StructForm &structForm)
+{
+    return grid(structForm.columns, *structForm, [this](auto &pair) {
+        name = pair.first;
+        return show(pair.second);
+    });
+}
+
+int FormVisitor::operator()(BoundNumber &n)
+{
+    return std::visit(
+        [this, &n](const auto &range) {
+            using T = std::decay_t<decltype(*range.value)>;
+            return numberInput(NumberText(*range.value).data, NumberText(range.min).data, NumberText(range.max).data,
+                               std::is_integral_v<T>, &n, "updateBoundRangeText");
+        },
+        n);
+}
+
+int FormVisitor::operator()(BoundStruct &bound)
+{
+    return grid(bound.columns, bound.fields, [this](BoundField &field) {
+        name = field.name;
+        return std::visit(
+            [this](auto &value) {
+                if constexpr (std::is_pointer_v<std::decay_t<decltype(value)>>)
+                {
+                    return this->operator()(*value);
+                }
+                else
+                {
+                    return this->operator()(value);
+                }
+            },
+            field.value);
+    });
+}
+
 int FormVisitor::operator()(EnableForm &enableForm)
 {
     const String origName(name);
-    const bool useExpander = !name.empty();
     const int id = rand();
     EM_ASM(
         {
@@ -427,79 +691,200 @@ int FormVisitor::operator()(EnableForm &enableForm)
     {
         bool &enabled = pair.first;
         Form &form = pair.second;
-        const int i = std::visit(*this, *form);
-        EM_ASM(
-            {
-                let parent = $0;
-                let child = $1;
-                let title = UTF8ToString($2);
-                let enabled = $3;
-                let addr = $4;
-
-                let div = document.getElementById('div_' + parent.toString());
-
-                let div2 = document.getElementById('div_' + child.toString());
-                if (!enabled)
+        showInside(form, std::string_view(), [this, id, n = n, &enabled](int i) {
+            EM_ASM(
                 {
-                    div2.style.visibility = 'hidden';
-                }
-                div2.remove();
+                    let parent = $0;
+                    let child = $1;
+                    let title = UTF8ToString($2);
+                    let enabled = $3;
+                    let addr = $4;
+                    let tracker = $5;
 
-                let boxDiv = document.createElement("div");
-                div.append(boxDiv);
-                div.append(div2);
+                    let div = document.getElementById('div_' + parent.toString());
 
-                let newID = 'checkbox_' + parent.toString() + child.toString();
-                let label = document.createElement("label");
-                label.innerText = title;
-                label.setAttribute("for", newID);
-                boxDiv.append(label);
+                    let div2 = document.getElementById('div_' + child.toString());
+                    if (!enabled)
+                    {
+                        div2.style.visibility = 'hidden';
+                    }
+                    div2.remove();
+
+                    let boxDiv = document.createElement("div");
+                    div.append(boxDiv);
+                    div.append(div2);
+
+                    let newID = 'checkbox_' + parent.toString() + child.toString();
+                    let label = document.createElement("label");
+                    label.innerText = title;
+                    label.setAttribute("for", newID);
+                    boxDiv.append(label);
+
+                    let input = document.createElement("input");
+                    input.type = "checkbox";
+                    input.id = newID;
+                    input.checked = enabled ? true : false;
+                    input.onchange = function()
+                    {
+                        div2.style.visibility = input.checked ? 'initial' : 'hidden';
+                        Module.ccall('prepareChange', null, [ 'number', 'number' ], [ tracker, addr ]);
+                        Module.ccall('updateBoolean', null, [ 'number', 'boolean' ], [ addr, input.checked ]);
+                        Module.ccall('trackChange', null, [ 'number', 'number' ], [ tracker, addr ]);
+                    };
+                    boxDiv.append(input);
+                },
+                id, i, n.c_str(), enabled, &enabled, tracker);
+        });
+    }
+    return expander(id, origName);
+}
 
-                let input = document.createElement("input");
-                input.type = "checkbox";
-                input.id = newID;
-                input.checked = enabled ? true : false;
-                input.onchange = function()
-                {
-                    div2.style.visibility = input.checked ? 'initial' : 'hidden';
-                    Module.ccall('updateBoolean', null, [ 'number', 'boolean' ], [ addr, input.checked ]);
-                };
-                boxDiv.append(input);
-            },
-            id, i, n.c_str(), enabled, &enabled);
+int FormVisitor::show(Form &root)
+{
+    std::vector<Pending> later;
+    std::vector<Pending> *outer = std::exchange(pending, &later);
+    MutableFormWalker walker;
+    const int id = build(root, walker);
+    // In the order they were left, so the fields of an EnableForm keep their order
+    for (size_t i = 0; i < later.size(); ++i)
+    {
+        Pending inside = std::move(later[i]);
+        name = inside.name;
+        inside.place(build(*inside.form, walker));
     }
-    if (!useExpander)
+    pending = outer;
+    return id;
+}
+
+void FormVisitor::showInside(Form &form, std::string_view formName, std::function<void(int)> place)
+{
+    if (pending != nullptr)
     {
-        return id;
+        pending->push_back(Pending{&form, formName, std::move(place)});
+        return;
     }
-    const int divId = rand();
-    EM_ASM(
+    name = formName;
+    place(show(form));
+}
+
+int FormVisitor::build(Form &root, MutableFormWalker &walker)
+{
+    // Nested StructForms are walked instead of visited so deep forms do not recurse. Each open grid waits on the
+    // stack until all of its fields are attached.
+    struct Open
+    {
+        int id;
+        String title;
+    };
+    std::vector<Open> open;
+    const std::string_view rootName = name;
+    int rootId = 0;
+    auto nameOf = [rootName](const MutableFormWalker::Step &step) {
+        return step.parent == nullptr ? rootName : step.key.view();
+    };
+    auto done = [&](Form &form, std::string_view formName, int id) {
+        divs.insert_or_assign(&form, std::make_pair(id, formName));
+        if (open.empty())
         {
-            let id = $0;
-            let divId = $1;
+            rootId = id;
+        }
+        else
+        {
+            attach(open.back().id, id);
+        }
+    };
 
-            let form = document.getElementById("div_" + id.toString());
-            form.classList.add("expandable");
+    walker.walk(
+        root,
+        [&](const MutableFormWalker::Step &step) {
+            const std::string_view formName = nameOf(step);
+            if (auto structForm = step.form->getIf<StructForm>())
+            {
+                open.push_back(Open{openGrid(structForm->columns), String(formName)});
+                return WalkAction::Continue;
+            }
+            name = formName;
+            done(*step.form, formName, visit(*this, *step.form));
+            return WalkAction::Skip;
+        },
+        [&](const MutableFormWalker::Step &step) {
+            if (step.form->holds<StructForm>())
+            {
+                const Open grid = std::move(open.back());
+                open.pop_back();
+                done(*step.form, nameOf(step), expander(grid.id, grid.title));
+            }
+        });
+    return rootId;
+}
 
-            let button = document.createElement("button");
-            button.innerText = UTF8ToString($2);
-            button.onclick = function()
+void FormVisitor::refresh(Form &form)
+{
+    auto iter = divs.find(&form);
+    if (iter == divs.end())
+    {
+        return;
+    }
+    const auto [oldId, formName] = iter->second;
+    name = formName;
+    const int id = show(form);
+    EM_ASM(
+        {
+            let old = document.getElementById('div_' + $0.toString());
+            let div = document.getElementById('div_' + $1.toString());
+            if (old && div)
             {
-                button.classList.toggle("active");
-                form.classList.toggle("active");
-            };
-            button.classList.add("expander");
+                div.remove();
+                old.replaceWith(div);
+            }
+        },
+        oldId, id);
+}
 
-            let div = document.createElement("div");
-            div.id = "div_" + divId.toString();
-            form.parentNode.insertBefore(div, form);
+void FormVisitor::replay(bool redo)
+{
+    EditJournal *journal = formExecute->getJournal();
+    if (journal == nullptr)
+    {
+        return;
+    }
+    Form *form = redo ? journal->redo() : journal->undo();
+    if (form != nullptr)
+    {
+        refresh(*form);
+    }
+}
 
-            div.append(button);
-            form.remove();
-            div.append(form);
-        },
-        id, divId, origName.c_str());
-    return divId;
+void FormVisitor::highlight(const std::pmr::vector<ValidationError> &errors) const
+{
+    std::unordered_map<const Form *, String> messages;
+    for (const auto &error : errors)
+    {
+        auto &message = messages[error.form];
+        if (!message.empty())
+        {
+            message.push_back('\n');
+        }
+        message.append(error.message);
+    }
+    for (const auto &[form, div] : divs)
+    {
+        const int id = div.first;
+        auto iter = messages.find(form);
+        const std::string_view message = iter == messages.end() ? std::string_view() : std::string_view(iter->second);
+        EM_ASM(
+            {
+                let div = document.getElementById('div_' + $0.toString());
+                if (!div)
+                {
+                    return;
+                }
+                let message = UTF8ToString($1, $2);
+                div.style.borderColor = message ? 'red' : '';
+                div.title = message;
+            },
+            id, message.data(), message.size());
+    }
 }
 
 void FormVisitor::checkLater()
@@ -522,17 +907,57 @@ void FormVisitor::checkForResponse(void *userData)
             {
                 return -1;
             }
-            dialog.remove();
             return dialog.returnValue == "ok" ? 1 : 0;
         },
         handler->dialogId);
+    // Stops updating the computed fields and removes the dialog
+    const auto closeDialog = [handler]() {
+        if (handler->listener != 0)
+        {
+            handler->tracker->unsubscribe(handler->listener);
+        }
+        if (EditJournal *journal = handler->formExecute->getJournal())
+        {
+            journal->detach();
+        }
+        EM_ASM(
+            {
+                let dialog = document.getElementById("dialog_" + $0.toString());
+                if (dialog)
+                {
+                    dialog.remove();
+                }
+            },
+            handler->dialogId);
+    };
+    if (response == 1)
+    {
+        const auto errors = handler->formExecute->validate();
+        handler->highlight(errors);
+        if (!errors.empty())
+        {
+            EM_ASM(
+                {
+                    let dialog = document.getElementById("dialog_" + $0.toString());
+                    dialog.returnValue = "";
+                    dialog.showModal();
+                },
+                handler->dialogId);
+            handler->checkLater();
+            return;
+        }
+    }
     switch (response)
     {
     case 0:
+        closeDialog();
+        handler->formExecute->rollback();
         handler->formExecute->cancel();
         delete handler;
         break;
     case 1:
+        closeDialog();
+        handler->formExecute->commit();
         handler->formExecute->ok();
         delete handler;
         break;
@@ -542,10 +967,86 @@ void FormVisitor::checkForResponse(void *userData)
     }
 }
 
+int FormVisitor::operator()(FormBatch &batch)
+{
+    const int id = makeDiv();
+    EM_ASM(
+        {
+            let id = $0;
+            let batch = $1;
+            let pageSize = $2;
+
+            let div = document.getElementById('div_' + id.toString());
+
+            let table = document.createElement('table');
+            table.id = 'table_' + id.toString();
+            table.dataset.first = '0';
+            let head = document.createElement('thead');
+            let row = document.createElement('tr');
+            row.id = 'head_' + id.toString();
+            row.append(document.createElement('th'));
+            head.append(row);
+            table.append(head);
+            table.append(document.createElement('tbody'));
+            div.append(table);
+
+            function show(first)
+            {
+                Module.ccall('showBatchPage', null, [ 'number', 'number', 'number' ], [ batch, id, first ]);
+            };
+
+            let navigation = document.createElement('div');
+            let previous = document.createElement('button');
+            previous.innerText = 'Previous';
+            previous.id = 'previous_' + id.toString();
+            previous.onclick = function()
+            {
+                show(Math.max(0, parseInt(table.dataset.first) - pageSize));
+            };
+            navigation.append(previous);
+            let label = document.createElement('span');
+            label.id = 'page_' + id.toString();
+            navigation.append(label);
+            let next = document.createElement('button');
+            next.innerText = 'Next';
+            next.id = 'next_' + id.toString();
+            next.onclick = function()
+            {
+                show(parseInt(table.dataset.first) + pageSize);
+            };
+            navigation.append(next);
+            div.append(navigation);
+        },
+        id, &batch, BatchPageSize);
+    for (size_t column = 0; column < batch.columnCount(); ++column)
+    {
+        const String &columnName = batch.column(column).name;
+        EM_ASM(
+            {
+                let th = document.createElement('th');
+                th.innerText = UTF8ToString($1, $2);
+                document.getElementById('head_' + $0.toString()).append(th);
+            },
+            id, columnName.data(), columnName.size());
+    }
+    showBatchPage(batch, id, 0);
+    return id;
+}
+
 void FormExecute::execute(std::string_view title, const std::shared_ptr<FormExecute> &formExecute, void *)
 {
-    FormVisitor *visitor = new FormVisitor(formExecute);
-    const int id = std::visit(*visitor, *(formExecute->form));
+    FormVisitor *visitor = new FormVisitor(formExecute, &formExecute->track());
+    BoundStruct *binding = formExecute->getBinding();
+    FormBatch *batch = formExecute->getBatch();
+    int id = 0;
+    if (batch != nullptr)
+    {
+        id = (*visitor)(*batch);
+    }
+    else
+    {
+        id = binding == nullptr ? visitor->show(formExecute->form) : (*visitor)(*binding);
+    }
     EM_ASM(
         {
             let id = $0;
@@ -589,10 +1090,57 @@ void FormExecute::execute(std::string_view title, const std::shared_ptr<FormExec
             };
             dialog.append(button);
 
+            let visitor = $3;
+            if (visitor != 0)
+            {
+                let replay = function(redo)
+                {
+                    Module.ccall(redo ? 'redoEdit' : 'undoEdit', null, [ 'number' ], [ visitor ]);
+                };
+                button = document.createElement("button");
+                button.innerText = 'Undo';
+                button.onclick = function()
+                {
+                    replay(false);
+                };
+                dialog.append(button);
+                button = document.createElement("button");
+                button.innerText = 'Redo';
+                button.onclick = function()
+                {
+                    replay(true);
+                };
+                dialog.append(button);
+                // Replaces the undo of text inputs so every edit goes through the journal
+                dialog.onkeydown = function(e)
+                {
+                    let key = e.key.toLowerCase();
+                    if (e.ctrlKey && (key == 'z' || key == 'y'))
+                    {
+                        e.preventDefault();
+                        replay(key == 'y' || e.shiftKey);
+                    }
+                };
+            }
+
             dialog.showModal();
         },
-        id, title.data(), title.size());
+        id, title.data(), title.size(), formExecute->getJournal() == nullptr ? nullptr : visitor);
+    if (EditJournal *journal = formExecute->getJournal())
+    {
+        journal->attach(*visitor->tracker);
+    }
     visitor->dialogId = id;
+
+    // Edits update the computed fields that read them and the divs of the ones that changed
+    if (ComputedFields *computed = formExecute->getComputed())
+    {
+        Form *root = &formExecute->form;
+        visitor->listener = visitor->tracker->subscribe([computed, root, visitor](const FormPath &path, const Form &) {
+            computed->changed(path, *root, visitor->tracker,
+                              [visitor](const FormPath &, Form &target) { visitor->refresh(target); });
+        });
+    }
     visitor->checkLater();
 }
 
@@ -611,15 +1159,43 @@ void updateString(String &oldValue, char *newValue)
     free(newValue);
 }
 
-double updateRange(IRange &range, double d)
+void updateStdString(std::string &oldValue, char *newValue)
 {
-    return range.setFromDouble(d);
+    oldValue.assign(newValue);
+    free(newValue);
 }
 
-void updateVariantForm(VariantForm &variant, char *string)
+// Partial text such as "-" changes nothing and is not reported to the tracker
+template <typename V> static const char *updateNumberText(FormTracker *tracker, V &value, const char *text)
 {
-    variant.selected.assign(string);
+    return std::visit(
+        [tracker, &value, text](auto &range) {
+            if (range.parseChars(text))
+            {
+                prepareForm(tracker, &value);
+                range.setFromChars(text);
+                touchForm(tracker, &value);
+            }
+            return rangeText(range);
+        },
+        value);
+}
+
+const char *updateRangeText(FormTracker *tracker, RangedValue &value, const char *text)
+{
+    return updateNumberText(tracker, value, text);
+}
+
+const char *updateBoundRangeText(FormTracker *tracker, BoundNumber &value, const char *text)
+{
+    return updateNumberText(tracker, value, text);
+}
+
+void selectVariantForm(FormVisitor &visitor, VariantForm &variant, int id, char *string)
+{
+    const Atom key(string);
     free(string);
+    visitor.select(variant, id, key);
 }
 
 bool updateHandler(FileDialog::Handler &handler, char *string)
@@ -634,7 +1210,7 @@ void cancelHandler(FileDialog::Handler &handler)
     handler.canceled();
 }
 
-void addToStringSet(StringSet &set, char *string)
+template <typename Set> static void addToSet(Set &set, char *string)
 {
     if (string == nullptr)
     {
@@ -647,13 +1223,54 @@ void addToStringSet(StringSet &set, char *string)
     }
 }
 
-void removeFromStringSet(StringSet &set, char *string)
+template <typename Set> static void removeFromSet(Set &set, char *string)
 {
-    set.erase(string);
+    set.erase(typename Set::value_type(string));
     free(string);
 }
 
-void updateStringSetDiv(StringSet &set, int id)
+void addToStringSet(StringSet &set, char *string)
+{
+    addToSet(set, string);
+}
+
+void removeFromStringSet(StringSet &set, char *string)
+{
+    removeFromSet(set, string);
+}
+
+void addToStdStringSet(std::set<std::string> &set, char *string)
+{
+    addToSet(set, string);
+}
+
+void removeFromStdStringSet(std::set<std::string> &set, char *string)
+{
+    removeFromSet(set, string);
+}
+
+void trackChange(FormTracker *tracker, void *address)
+{
+    CanForm::touchForm(tracker, address);
+}
+
+void prepareChange(FormTracker *tracker, void *address)
+{
+    prepareForm(tracker, address);
+}
+
+void undoEdit(FormVisitor &visitor)
+{
+    visitor.replay(false);
+}
+
+void redoEdit(FormVisitor &visitor)
+{
+    visitor.replay(true);
+}
+
+template <typename Set>
+static void updateSetDiv(Set &set, int id, FormTracker *tracker, const char *add, const char *remove)
 {
     EM_ASM(
         {
@@ -669,6 +1286,9 @@ void updateStringSetDiv(StringSet &set, int id)
                 let id = $0;
                 let string = UTF8ToString($1);
                 let addr = $2;
+                let tracker = $3;
+                let add = UTF8ToString($4);
+                let remove = UTF8ToString($5);
 
                 let div = document.getElementById('content_' + id.toString());
 
@@ -680,10 +1300,12 @@ void updateStringSetDiv(StringSet &set, int id)
                 input.value = string;
                 input.onchange = function()
                 {
-                    Module.ccall('removeFromStringSet', null, [ 'number', 'number' ],
+                    Module.ccall('prepareChange', null, [ 'number', 'number' ], [ tracker, addr ]);
+                    Module.ccall(remove, null, [ 'number', 'number' ],
                                  [ addr, stringToNewUTF8(string) ]);
-                    Module.ccall('addToStringSet', null, [ 'number', 'number' ],
+                    Module.ccall(add, null, [ 'number', 'number' ],
                                  [ addr, stringToNewUTF8(input.value) ]);
+                    Module.ccall('trackChange', null, [ 'number', 'number' ], [ tracker, addr ]);
                     string = input.value;
                 };
                 input.onkeypress = function()
@@ -702,12 +1324,263 @@ void updateStringSetDiv(StringSet &set, int id)
 
                 button.onclick = function()
                 {
-                    Module.ccall('removeFromStringSet', null, [ 'number', 'number' ],
+                    Module.ccall('prepareChange', null, [ 'number', 'number' ], [ tracker, addr ]);
+                    Module.ccall(remove, null, [ 'number', 'number' ],
                                  [ addr, stringToNewUTF8(input.value) ]);
+                    Module.ccall('trackChange', null, [ 'number', 'number' ], [ tracker, addr ]);
                     button.remove();
                     input.remove();
                 };
             },
-            id, s.c_str(), &set);
+            id, s.c_str(), &set, tracker, add, remove);
+    }
+}
+
+void updateStringSetDiv(StringSet &set, int id, FormTracker *tracker)
+{
+    updateSetDiv(set, id, tracker, "addToStringSet", "removeFromStringSet");
+}
+
+void updateStdStringSetDiv(std::set<std::string> &set, int id, FormTracker *tracker)
+{
+    updateSetDiv(set, id, tracker, "addToStdStringSet", "removeFromStdStringSet");
+}
+
+void updateBatchFlag(FormBatch &batch, int column, int record, bool flag)
+{
+    batch.setNumber(column, record, flag ? 1 : 0);
+}
+
+const char *updateBatchNumber(FormBatch &batch, int column, int record, const char *text)
+{
+    static char buffer[NumberChars + 1];
+    batch.setNumberFromChars(column, record, text);
+    char *end = batch.numberToChars(column, record, buffer, buffer + NumberChars);
+    *(end == nullptr ? buffer : end) = '\0';
+    return buffer;
+}
+
+bool updateBatchString(FormBatch &batch, int column, int record, char *string)
+{
+    const bool set = batch.setString(column, record, string);
+    free(string);
+    return set;
+}
+
+// Replaces the options of a picker with the ones from first
+void showOptions(StringSelection &selection, int id, int first)
+{
+    const int count = static_cast<int>(selection.optionCount());
+    first = count == 0 ? 0 : std::clamp(first, 0, count - 1);
+    std::pmr::vector<std::string_view> options;
+    selection.provider->fetch(first, FormVisitor::PickerRows, options);
+    const int last = first + static_cast<int>(options.size());
+    EM_ASM(
+        {
+            let id = $0;
+            let first = $1;
+            let last = $2;
+            let count = $3;
+
+            let select = document.getElementById('select_' + id.toString());
+            select.dataset.first = first.toString();
+            select.replaceChildren();
+            document.getElementById('page_' + id.toString()).innerText =
+                ' ' + (count == 0 ? 0 : first + 1) + ' to ' + last + ' of ' + count + ' ';
+            document.getElementById('previous_' + id.toString()).disabled = first == 0;
+            document.getElementById('next_' + id.toString()).disabled = last >= count;
+        },
+        id, first, last, count);
+    for (int i = first; i < last; ++i)
+    {
+        const std::string_view option = options[i - first];
+        EM_ASM(
+            {
+                let option = document.createElement('option');
+                option.innerText = UTF8ToString($1, $2);
+                option.value = option.innerText;
+                option.selected = $3;
+                document.getElementById('select_' + $0.toString()).append(option);
+            },
+            id, option.data(), option.size(), i == selection.index);
+    }
+}
+
+int findOption(StringSelection &selection, char *prefix)
+{
+    const size_t i = selection.provider->find(prefix);
+    free(prefix);
+    return i == OptionProvider::npos ? -1 : static_cast<int>(i);
+}
+
+bool selectOption(StringSelection &selection, int index)
+{
+    return index >= 0 && selection.select(index);
+}
+
+// Replaces the rows of a FormBatch table with the records from first
+void showBatchPage(FormBatch &batch, int id, int first)
+{
+    const int size = static_cast<int>(batch.size());
+    first = size == 0 ? 0 : std::clamp(first, 0, (size - 1) / FormVisitor::BatchPageSize * FormVisitor::BatchPageSize);
+    const int last = std::min(first + FormVisitor::BatchPageSize, size);
+    EM_ASM(
+        {
+            let id = $0;
+            let first = $1;
+            let last = $2;
+            let size = $3;
+
+            let table = document.getElementById('table_' + id.toString());
+            table.dataset.first = first.toString();
+            table.tBodies[0].replaceChildren();
+            document.getElementById('page_' + id.toString()).innerText =
+                ' Records ' + (size == 0 ? 0 : first + 1) + ' to ' + last + ' of ' + size + ' ';
+            document.getElementById('previous_' + id.toString()).disabled = first == 0;
+            document.getElementById('next_' + id.toString()).disabled = last >= size;
+        },
+        id, first, last, size);
+    for (int record = first; record < last; ++record)
+    {
+        EM_ASM(
+            {
+                let row = document.createElement('tr');
+                row.id = 'row_' + $0.toString() + '_' + $1.toString();
+                let th = document.createElement('th');
+                th.innerText = ($1 + 1).toString();
+                row.append(th);
+                document.getElementById('table_' + $0.toString()).tBodies[0].append(row);
+            },
+            id, record);
+        for (size_t column = 0; column < batch.columnCount(); ++column)
+        {
+            const FormBatch::Column &c = batch.column(column);
+            const size_t alternative = c.getAlternative();
+            if (alternative == Form::indexOf<bool>())
+            {
+                EM_ASM(
+                    {
+                        let batch = $1;
+                        let column = $2;
+                        let record = $3;
+
+                        let input = document.createElement('input');
+                        input.type = 'checkbox';
+                        input.checked = $4;
+                        input.onchange = function()
+                        {
+                            Module.ccall('updateBatchFlag', null, [ 'number', 'number', 'number', 'boolean' ],
+                                         [ batch, column, record, input.checked ]);
+                        };
+                        let td = document.createElement('td');
+                        td.append(input);
+                        document.getElementById('row_' + $0.toString() + '_' + record.toString()).append(td);
+                    },
+                    id, &batch, column, record, batch.getNumber(column, record).value_or(0) != 0);
+                continue;
+            }
+            if (alternative == Form::indexOf<RangedValue>())
+            {
+                // Numbers stay text on the way in and out so 64 bit integers are exact
+                char value[NumberChars + 1];
+                char *end = batch.numberToChars(column, record, value, value + NumberChars);
+                *(end == nullptr ? value : end) = '\0';
+                const auto [min, max] = std::visit(
+                    [](const auto &range) {
+                        const auto [mi, ma] = range.getMinMax();
+                        return std::make_pair(NumberText(mi), NumberText(ma));
+                    },
+                    c.bounds);
+                EM_ASM(
+                    {
+                        let batch = $1;
+                        let column = $2;
+                        let record = $3;
+
+                        let input = document.createElement('input');
+                        input.type = 'text';
+                        input.inputMode = $7 ? 'numeric' : 'decimal';
+                        input.value = UTF8ToString($4);
+                        input.title = UTF8ToString($5) + ' to ' + UTF8ToString($6);
+                        let send = function()
+                        {
+                            return Module.ccall('updateBatchNumber', 'string',
+                                                [ 'number', 'number', 'number', 'string' ],
+                                                [ batch, column, record, input.value ]);
+                        };
+                        // Partial text such as '-' is kept while typing; the clamped value is shown once the edit is
+                        // done
+                        input.oninput = function()
+                        {
+                            send();
+                        };
+                        input.onchange = function()
+                        {
+                            input.value = send();
+                        };
+                        let td = document.createElement('td');
+                        td.append(input);
+                        document.getElementById('row_' + $0.toString() + '_' + record.toString()).append(td);
+                    },
+                    id, &batch, column, record, value, min.data, max.data,
+                    std::visit([](const auto &range) { return std::is_integral_v<std::decay_t<decltype(*range)>>; },
+                               c.bounds));
+                continue;
+            }
+
+            const std::string_view value = batch.getString(column, record).value_or(std::string_view());
+            const bool selection = alternative == Form::indexOf<StringSelection>();
+            EM_ASM(
+                {
+                    let id = $0;
+                    let batch = $1;
+                    let column = $2;
+                    let record = $3;
+                    let value = UTF8ToString($4, $5);
+                    let selection = $6;
+
+                    let input = document.createElement(selection ? 'select' : 'input');
+                    input.id = 'cell_' + id.toString() + '_' + column.toString() + '_' + record.toString();
+                    if (!selection)
+                    {
+                        input.type = 'text';
+                        input.value = value;
+                    }
+                    input.onchange = function()
+                    {
+                        Module.ccall('updateBatchString', 'boolean', [ 'number', 'number', 'number', 'number' ],
+                                     [ batch, column, record, stringToNewUTF8(input.value) ]);
+                    };
+                    if (!selection)
+                    {
+                        input.oninput = function()
+                        {
+                            this.onchange();
+                        };
+                    }
+                    let td = document.createElement('td');
+                    td.append(input);
+                    document.getElementById('row_' + id.toString() + '_' + record.toString()).append(td);
+                },
+                id, &batch, column, record, value.data(), value.size(), selection);
+            if (!selection)
+            {
+                continue;
+            }
+            for (const String &option : c.options)
+            {
+                EM_ASM(
+                    {
+                        let select = document.getElementById('cell_' + $0.toString() + '_' + $1.toString() + '_' +
+                                                             $2.toString());
+                        let option = document.createElement('option');
+                        option.value = UTF8ToString($3, $4);
+                        option.innerText = option.value;
+                        option.selected = $5;
+                        select.append(option);
+                    },
+                    id, column, record, option.data(), option.size(), option == value);
+            }
+        }
     }
-}
\ No newline at end of file
+}
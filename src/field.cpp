@@ -0,0 +1,209 @@
+#include <field.hpp>
+#include <iterator>
+
+namespace CanForm
+{
+// Checks the position from the schema before looking the key up
+template <typename Map> static auto locate(Map &map, const FieldRef::Step &step)
+{
+    using Iterator = decltype(map.begin());
+    using Category = typename std::iterator_traits<Iterator>::iterator_category;
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag, Category>)
+    {
+        if (step.position < map.size())
+        {
+            auto iter = map.begin() + step.position;
+            if (iter->first == step.key)
+            {
+                return iter;
+            }
+        }
+    }
+    return map.find(step.key);
+}
+
+template <typename Map> static size_t positionOf(const Map &map, typename Map::const_iterator iter)
+{
+    return static_cast<size_t>(std::distance(map.begin(), iter));
+}
+
+// F is Form or const Form. Mutable forms go through the non-const accessors so shared maps are copied.
+template <typename F> static F *child(F &form, const FieldRef::Step &step)
+{
+    if (form->index() != step.container)
+    {
+        return nullptr;
+    }
+    switch (step.container)
+    {
+    case Form::indexOf<StructForm>(): {
+        auto &map = *form.template get<StructForm>();
+        auto iter = locate(map, step);
+        return iter == map.end() ? nullptr : &iter->second;
+    }
+    case Form::indexOf<VariantForm>(): {
+        auto &map = *form.template get<VariantForm>();
+        auto iter = locate(map, step);
+        return iter == map.end() ? nullptr : &iter->second;
+    }
+    case Form::indexOf<EnableForm>(): {
+        auto &map = *form.template get<EnableForm>();
+        auto iter = locate(map, step);
+        return iter == map.end() ? nullptr : &iter->second.second;
+    }
+    default:
+        return nullptr;
+    }
+}
+
+template <typename F> static F *walk(F &form, const FieldRef::Steps &steps)
+{
+    F *current = &form;
+    for (const auto &step : steps)
+    {
+        current = child(*current, step);
+        if (current == nullptr)
+        {
+            break;
+        }
+    }
+    return current;
+}
+
+std::optional<FieldRef> FieldRef::compile(const FormPath &path, const Form &schema, const Allocator &allocator)
+{
+    Steps steps(allocator);
+    steps.reserve(path.size());
+    const Form *current = &schema;
+    for (const Atom &key : path)
+    {
+        Step step{key, static_cast<uint8_t>(current->data.index()), 0};
+        const Form *next = visit(
+            [&step](const auto &value) -> const Form * {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same_v<T, StructForm> || std::is_same_v<T, VariantForm> ||
+                              std::is_same_v<T, EnableForm>)
+                {
+                    auto iter = value->find(step.key);
+                    if (iter == value->end())
+                    {
+                        return nullptr;
+                    }
+                    step.position = static_cast<uint32_t>(positionOf(*value, iter));
+                    if constexpr (std::is_same_v<T, EnableForm>)
+                    {
+                        return &iter->second.second;
+                    }
+                    else
+                    {
+                        return &iter->second;
+                    }
+                }
+                else
+                {
+                    return nullptr;
+                }
+            },
+            *current);
+        if (next == nullptr)
+        {
+            return std::nullopt;
+        }
+        steps.push_back(step);
+        current = next;
+    }
+    return FieldRef(std::move(steps), current->data.index());
+}
+
+std::optional<FieldRef> FieldRef::compile(std::string_view path, const Form &schema, const Allocator &allocator)
+{
+    FormPath keys(allocator);
+    while (!path.empty())
+    {
+        const size_t slash = path.find('/');
+        keys.emplace_back(path.substr(0, slash));
+        if (slash == std::string_view::npos)
+        {
+            break;
+        }
+        path.remove_prefix(slash + 1);
+    }
+    return compile(keys, schema, allocator);
+}
+
+const Form *FieldRef::resolve(const Form &form) const noexcept
+{
+    return walk(form, steps);
+}
+
+Form *FieldRef::resolve(Form &form) const
+{
+    return walk(form, steps);
+}
+
+FormPath FieldRef::getPath(const Allocator &allocator) const
+{
+    FormPath path(allocator);
+    path.reserve(steps.size());
+    for (const auto &step : steps)
+    {
+        path.push_back(step.key);
+    }
+    return path;
+}
+
+FieldGather::FieldGather(const Allocator &allocator) : nodes(allocator), count(0)
+{
+    nodes.emplace_back(FieldRef::Step{Atom(), 0, 0}, allocator);
+}
+
+size_t FieldGather::add(const FieldRef &field)
+{
+    uint32_t node = 0;
+    for (const auto &step : field.getSteps())
+    {
+        uint32_t next = 0;
+        for (uint32_t c : nodes[node].children)
+        {
+            const auto &s = nodes[c].step;
+            if (s.key == step.key && s.container == step.container)
+            {
+                next = c;
+                break;
+            }
+        }
+        if (next == 0)
+        {
+            next = static_cast<uint32_t>(nodes.size());
+            nodes.emplace_back(step, nodes.get_allocator());
+            nodes[node].children.push_back(next);
+        }
+        node = next;
+    }
+    nodes[node].fields.push_back(static_cast<uint32_t>(count));
+    return count++;
+}
+
+void FieldGather::gather(uint32_t node, const Form &form, const Form **out) const noexcept
+{
+    const Node &n = nodes[node];
+    for (uint32_t field : n.fields)
+    {
+        out[field] = &form;
+    }
+    for (uint32_t c : n.children)
+    {
+        const Form *next = child(form, nodes[c].step);
+        if (next != nullptr)
+        {
+            gather(c, *next, out);
+        }
+    }
+}
+
+void FieldGather::gather(const Form &form, std::pmr::vector<const Form *> &out) const
+{
+    out.assign(count, nullptr);
+    gather(0, form, out.data());
+}
+} // namespace CanForm
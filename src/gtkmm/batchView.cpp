@@ -0,0 +1,158 @@
+#include <gtkmm/batchView.hpp>
+#include <gtkmm/gtkmm.hpp>
+
+namespace CanForm
+{
+BatchView::BatchView(FormBatch &b)
+    : Gtk::VBox(), batch(b), first(0), loading(false), grid(), navigation(), previousButton("Previous"),
+      nextButton("Next"), pageLabel(), loaders()
+{
+    grid.set_row_spacing(5);
+    grid.set_column_spacing(10);
+
+    for (size_t column = 0; column < batch.columnCount(); ++column)
+    {
+        Gtk::Label *label = Gtk::make_managed<Gtk::Label>(convert(batch.column(column).name));
+        grid.attach(*label, column + 1, 0);
+    }
+    for (size_t row = 0; row < PageSize; ++row)
+    {
+        Gtk::Label *label = Gtk::make_managed<Gtk::Label>();
+        grid.attach(*label, 0, row + 1);
+        loaders.emplace_back([this, label, row]() {
+            const size_t record = first + row;
+            label->set_text(record < batch.size() ? Glib::ustring::format(record + 1) : Glib::ustring());
+        });
+        for (size_t column = 0; column < batch.columnCount(); ++column)
+        {
+            grid.attach(*makeCell(column, row), column + 1, row + 1);
+        }
+    }
+    pack_start(grid, Gtk::PACK_EXPAND_WIDGET);
+
+    previousButton.signal_clicked().connect([this]() { showPage(first < PageSize ? 0 : first - PageSize); });
+    nextButton.signal_clicked().connect([this]() { showPage(first + PageSize); });
+    navigation.pack_start(previousButton, Gtk::PACK_SHRINK);
+    navigation.pack_start(pageLabel, Gtk::PACK_EXPAND_WIDGET);
+    navigation.pack_start(nextButton, Gtk::PACK_SHRINK);
+    pack_start(navigation, Gtk::PACK_SHRINK, 10);
+
+    showPage(0);
+}
+
+Gtk::Widget *BatchView::makeCell(size_t column, size_t row)
+{
+    const FormBatch::Column &c = batch.column(column);
+    const size_t alternative = c.getAlternative();
+    if (alternative == Form::indexOf<bool>())
+    {
+        Gtk::CheckButton *button = Gtk::make_managed<Gtk::CheckButton>();
+        button->signal_toggled().connect([this, button, column, row]() {
+            if (!loading)
+            {
+                batch.setNumber(column, first + row, button->get_active() ? 1 : 0);
+            }
+        });
+        loaders.emplace_back([this, button, column, row]() {
+            const size_t record = first + row;
+            button->set_sensitive(record < batch.size());
+            button->set_active(record < batch.size() && batch.getNumber(column, record).value_or(0) != 0);
+        });
+        return button;
+    }
+    if (alternative == Form::indexOf<RangedValue>())
+    {
+        // Text keeps the exact digits of the number type, which a spin button would round through double
+        Gtk::Entry *entry = Gtk::make_managed<Gtk::Entry>();
+        entry->set_input_purpose(Gtk::INPUT_PURPOSE_NUMBER);
+        std::visit(
+            [entry](const auto &range) {
+                char buffer[NumberChars * 2 + 4];
+                const auto [min, max] = range.getMinMax();
+                char *end = formatNumber(buffer, buffer + NumberChars, min);
+                end = std::copy_n(" to ", 4, end);
+                end = formatNumber(end, end + NumberChars, max);
+                entry->set_tooltip_text(Glib::ustring(buffer, end));
+            },
+            c.bounds);
+        // Shows the clamped value of the record
+        auto show = [this, entry, column, row]() {
+            const size_t record = first + row;
+            char buffer[NumberChars];
+            char *end =
+                record < batch.size() ? batch.numberToChars(column, record, buffer, buffer + sizeof(buffer)) : nullptr;
+            entry->set_text(Glib::ustring(buffer, end == nullptr ? buffer : end));
+        };
+        // Partial text such as "-" does not change the value
+        entry->signal_changed().connect([this, entry, column, row]() {
+            if (!loading)
+            {
+                batch.setNumberFromChars(column, first + row, entry->get_text().raw());
+            }
+        });
+        entry->signal_activate().connect(show);
+        entry->signal_focus_out_event().connect([show](GdkEventFocus *) {
+            show();
+            return false;
+        });
+        loaders.emplace_back([this, entry, column, row, show]() {
+            entry->set_sensitive(first + row < batch.size());
+            show();
+        });
+        return entry;
+    }
+    if (alternative == Form::indexOf<StringSelection>())
+    {
+        Gtk::ComboBoxText *box = Gtk::make_managed<Gtk::ComboBoxText>();
+        for (auto &text : c.options)
+        {
+            box->append(convert(text));
+        }
+        box->signal_changed().connect([this, box, column, row]() {
+            if (!loading)
+            {
+                batch.setString(column, first + row, toView(box->get_active_text()));
+            }
+        });
+        loaders.emplace_back([this, box, column, row]() {
+            const size_t record = first + row;
+            box->set_sensitive(record < batch.size());
+            auto text = record < batch.size() ? batch.getString(column, record) : std::nullopt;
+            box->set_active_text(text ? convert(*text) : Glib::ustring());
+        });
+        return box;
+    }
+
+    Gtk::Entry *entry = Gtk::make_managed<Gtk::Entry>();
+    entry->signal_changed().connect([this, entry, column, row]() {
+        if (!loading)
+        {
+            batch.setString(column, first + row, toView(entry->get_text()));
+        }
+    });
+    loaders.emplace_back([this, entry, column, row]() {
+        const size_t record = first + row;
+        entry->set_sensitive(record < batch.size());
+        auto text = record < batch.size() ? batch.getString(column, record) : std::nullopt;
+        entry->set_text(text ? convert(*text) : Glib::ustring());
+    });
+    return entry;
+}
+
+void BatchView::showPage(size_t f)
+{
+    first = batch.size() == 0 ? 0 : std::min(f, (batch.size() - 1) / PageSize * PageSize);
+    loading = true;
+    for (auto &load : loaders)
+    {
+        load();
+    }
+    loading = false;
+
+    const size_t last = std::min(first + PageSize, batch.size());
+    pageLabel.set_text(Glib::ustring::compose("Records %1 to %2 of %3", batch.size() == 0 ? 0 : first + 1, last,
+                                              batch.size()));
+    previousButton.set_sensitive(first > 0);
+    nextButton.set_sensitive(last < batch.size());
+}
+} // namespace CanForm
@@ -1,3 +1,4 @@
+#include <gtkmm/batchView.hpp>
 #include <gtkmm/editableSet.hpp>
 #include <gtkmm/form_visitor.hpp>
 
@@ -8,6 +9,208 @@ Gtk::Frame *FormVisitor::makeFrame() const
     return Gtk::make_managed<Gtk::Frame>(convert(name));
 }
 
+Gtk::Expander *FormVisitor::makeExpander() const
+{
+    if (name.empty())
+    {
+        return nullptr;
+    }
+    Gtk::Expander *expander = Gtk::make_managed<Gtk::Expander>();
+    expander->set_label(convert(name));
+    expander->set_label_fill(true);
+    expander->set_resize_toplevel(true);
+    expander->set_expanded(true);
+    return expander;
+}
+
+Gtk::Grid *FormVisitor::makeGrid()
+{
+    Gtk::Grid *grid = Gtk::make_managed<Gtk::Grid>();
+    grid->set_row_spacing(10);
+    grid->set_column_spacing(10);
+    return grid;
+}
+
+Gtk::Widget *FormVisitor::expand(Gtk::Expander *expander, Gtk::Widget &widget)
+{
+    if (expander == nullptr)
+    {
+        return &widget;
+    }
+    expander->add(widget);
+    return expander;
+}
+
+Gtk::Widget *FormVisitor::hold(Form &form, std::string_view formName, Gtk::Widget *widget)
+{
+    if (widgets == nullptr)
+    {
+        return widget;
+    }
+    Gtk::VBox *holder = Gtk::make_managed<Gtk::VBox>();
+    holder->pack_start(*widget, Gtk::PACK_EXPAND_WIDGET);
+    widgets->insert_or_assign(&form, FormWidget{holder, formName});
+    return holder;
+}
+
+Gtk::Widget *FormVisitor::show(Form &root)
+{
+    std::vector<Pending> later;
+    std::vector<Pending> *outer = std::exchange(pending, &later);
+    MutableFormWalker walker;
+    Gtk::Widget *widget = build(root, walker);
+    // In the order they were left, so the fields of an EnableForm keep their order
+    for (size_t i = 0; i < later.size(); ++i)
+    {
+        Pending inside = std::move(later[i]);
+        name = inside.name;
+        inside.place(build(*inside.form, walker));
+    }
+    pending = outer;
+    return widget;
+}
+
+void FormVisitor::showInside(Form &form, std::string_view formName, std::function<void(Gtk::Widget *)> place)
+{
+    if (pending != nullptr)
+    {
+        pending->push_back(Pending{&form, formName, std::move(place)});
+        return;
+    }
+    FormVisitor visitor(tracker, widgets);
+    visitor.name = formName;
+    place(visitor.show(form));
+}
+
+Gtk::Widget *FormVisitor::build(Form &root, MutableFormWalker &walker)
+{
+    // Nested StructForms are walked instead of visited so deep forms do not recurse. Each open grid waits on the
+    // stack until all of its fields are attached.
+    struct Open
+    {
+        Gtk::Grid *grid;
+        Gtk::Expander *expander;
+        size_t columns;
+        size_t index;
+    };
+    std::vector<Open> open;
+    const std::string_view rootName = name;
+    Gtk::Widget *rootWidget = nullptr;
+    auto nameOf = [rootName](const MutableFormWalker::Step &step) {
+        return step.parent == nullptr ? rootName : step.key.view();
+    };
+    auto done = [&](Form &form, std::string_view formName, Gtk::Widget *widget) {
+        widget = hold(form, formName, widget);
+        if (open.empty())
+        {
+            rootWidget = widget;
+            return;
+        }
+        Open &parent = open.back();
+        parent.grid->attach(*widget, parent.index % parent.columns, parent.index / parent.columns);
+        ++parent.index;
+    };
+
+    walker.walk(
+        root,
+        [&](const MutableFormWalker::Step &step) {
+            const std::string_view formName = nameOf(step);
+            name = formName;
+            if (auto structForm = step.form->getIf<StructForm>())
+            {
+                open.push_back(Open{makeGrid(), makeExpander(), structForm->columns, 0});
+                return WalkAction::Continue;
+            }
+            done(*step.form, formName, visit(*this, *step.form));
+            return WalkAction::Skip;
+        },
+        [&](const MutableFormWalker::Step &step) {
+            if (step.form->holds<StructForm>())
+            {
+                const Open grid = open.back();
+                open.pop_back();
+                done(*step.form, nameOf(step), expand(grid.expander, *grid.grid));
+            }
+        });
+    return rootWidget;
+}
+
+void FormVisitor::forgetInside(FormWidgets &widgets, Gtk::Widget &widget)
+{
+    for (auto i = widgets.begin(); i != widgets.end();)
+    {
+        if (i->second.holder != &widget && i->second.holder->is_ancestor(widget))
+        {
+            i = widgets.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+void FormVisitor::refresh(const std::shared_ptr<FormWidgets> &widgets, FormTracker *tracker, Form &form)
+{
+    auto iter = widgets->find(&form);
+    if (iter == widgets->end())
+    {
+        return;
+    }
+    Gtk::Box *holder = iter->second.holder;
+    const std::string_view formName = iter->second.name;
+
+    // The widgets of the forms inside it are replaced as well
+    forgetInside(*widgets, *holder);
+    for (Gtk::Widget *child : holder->get_children())
+    {
+        holder->remove(*child);
+    }
+
+    FormVisitor visitor(tracker, widgets);
+    visitor.name = formName;
+    holder->pack_start(*visit(visitor, form), Gtk::PACK_EXPAND_WIDGET);
+    holder->show_all_children();
+}
+
+void FormVisitor::highlight(const FormWidgets &widgets, const std::pmr::vector<ValidationError> &errors)
+{
+    static Glib::RefPtr<Gtk::CssProvider> provider;
+    if (!provider)
+    {
+        provider = Gtk::CssProvider::create();
+        provider->load_from_data(".canform-error { border: 2px solid red; }");
+        Gtk::StyleContext::add_provider_for_screen(Gdk::Screen::get_default(), provider,
+                                                   GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    }
+
+    std::unordered_map<const Form *, Glib::ustring> messages;
+    for (const auto &error : errors)
+    {
+        auto &message = messages[error.form];
+        if (!message.empty())
+        {
+            message += '\n';
+        }
+        message += convert(error.message);
+    }
+    for (const auto &[form, formWidget] : widgets)
+    {
+        Gtk::Widget *widget = formWidget.holder;
+        auto iter = messages.find(form);
+        if (iter == messages.end())
+        {
+            widget->get_style_context()->remove_class("canform-error");
+            widget->set_has_tooltip(false);
+        }
+        else
+        {
+            widget->get_style_context()->add_class("canform-error");
+            widget->set_tooltip_text(iter->second);
+        }
+    }
+}
+
 Gtk::Widget *FormVisitor::operator()(std::monostate &)
 {
     return makeFrame();
@@ -16,7 +219,11 @@ Gtk::Widget *FormVisitor::operator()(bool &b)
 {
     Gtk::CheckButton *button = Gtk::make_managed<Gtk::CheckButton>(convert(name));
     button->set_active(b);
-    button->signal_toggled().connect([&b, button]() { b = button->get_active(); });
+    button->signal_toggled().connect([&b, button, tracker = tracker]() {
+        prepareForm(tracker, &b);
+        b = button->get_active();
+        touchForm(tracker, &b);
+    });
     return button;
 }
 
@@ -29,7 +236,7 @@ Gtk::TextView *FormVisitor::makeTextView()
     return entry;
 }
 
-Gtk::Widget *FormVisitor::operator()(String &s)
+template <typename S> Gtk::Widget *FormVisitor::text(S &s)
 {
     auto frame = makeFrame();
     Gtk::VBox *box = Gtk::make_managed<Gtk::VBox>();
@@ -38,7 +245,11 @@ Gtk::Widget *FormVisitor::operator()(String &s)
 
     auto buffer = entry->get_buffer();
     buffer->set_text(convert(s));
-    buffer->signal_changed().connect([&s, buffer]() { s = convert(buffer->get_text()); });
+    buffer->signal_changed().connect([&s, buffer, tracker = tracker]() {
+        prepareForm(tracker, &s);
+        s = convert(buffer->get_text());
+        touchForm(tracker, &s);
+    });
 
     box->pack_start(*entry, Gtk::PACK_EXPAND_WIDGET, 10);
 
@@ -48,6 +259,16 @@ Gtk::Widget *FormVisitor::operator()(String &s)
     return frame;
 }
 
+Gtk::Widget *FormVisitor::operator()(String &s)
+{
+    return text(s);
+}
+
+Gtk::Widget *FormVisitor::operator()(std::string &s)
+{
+    return text(s);
+}
+
 Gtk::Widget *FormVisitor::operator()(ComplexString &s)
 {
     auto frame = makeFrame();
@@ -57,7 +278,11 @@ Gtk::Widget *FormVisitor::operator()(ComplexString &s)
 
     auto buffer = entry->get_buffer();
     buffer->set_text(convert(s.string));
-    buffer->signal_changed().connect([&s, buffer]() { s.string = convert(buffer->get_text()); });
+    buffer->signal_changed().connect([&s, buffer, tracker = tracker]() {
+        prepareForm(tracker, &s.string);
+        s.string = convert(buffer->get_text());
+        touchForm(tracker, &s.string);
+    });
 
     box->pack_start(*entry, Gtk::PACK_EXPAND_WIDGET, 10);
 
@@ -98,8 +323,9 @@ Gtk::Widget *FormVisitor::operator()(RangedValue &n)
     return std::visit(*this, n);
 }
 
-Gtk::Widget *FormVisitor::operator()(StringSet &set)
+template <typename Set> Gtk::Widget *FormVisitor::editableSet(Set &set)
 {
+    using Value = typename Set::value_type;
     auto frame = makeFrame();
 
     auto editableSet = Gtk::make_managed<EditableSet>();
@@ -108,20 +334,117 @@ Gtk::Widget *FormVisitor::operator()(StringSet &set)
         editableSet->add(convert(text));
     }
 
-    editableSet->signal_added().connect([&set](const Glib::ustring &s) { set.emplace(convert(s)); });
-    editableSet->signal_removed().connect([&set](const Glib::ustring &s) {
+    editableSet->signal_added().connect([&set, tracker = tracker](const Glib::ustring &s) {
+        prepareForm(tracker, &set);
+        set.emplace(convert(s));
+        touchForm(tracker, &set);
+    });
+    editableSet->signal_removed().connect([&set, tracker = tracker](const Glib::ustring &s) {
         std::string string(s);
-        set.erase(String(string));
+        prepareForm(tracker, &set);
+        set.erase(Value(string));
+        touchForm(tracker, &set);
+    });
+    editableSet->signal_cleared().connect([&set, tracker = tracker]() {
+        prepareForm(tracker, &set);
+        set.clear();
+        touchForm(tracker, &set);
     });
-    editableSet->signal_cleared().connect([&set]() { set.clear(); });
 
     frame->add(*editableSet);
 
     return frame;
 }
 
+Gtk::Widget *FormVisitor::operator()(StringSet &set)
+{
+    return editableSet(set);
+}
+
+Gtk::Widget *FormVisitor::operator()(std::set<std::string> &set)
+{
+    return editableSet(set);
+}
+
+// Shows PickerRows options of the provider at a time, starting at the first one that matches the search
+Gtk::Widget *FormVisitor::optionPicker(StringSelection &selection)
+{
+    auto frame = makeFrame();
+    auto box = Gtk::make_managed<Gtk::VBox>();
+
+    auto entry = Gtk::make_managed<Gtk::SearchEntry>();
+    entry->set_text(convert(selection.key));
+    box->pack_start(*entry, Gtk::PACK_SHRINK);
+
+    auto list = Gtk::make_managed<Gtk::ListBox>();
+    list->set_activate_on_single_click(true);
+    box->pack_start(*list, Gtk::PACK_EXPAND_WIDGET);
+
+    auto buttons = Gtk::make_managed<Gtk::HBox>();
+    auto previous = Gtk::make_managed<Gtk::Button>("Previous");
+    auto label = Gtk::make_managed<Gtk::Label>();
+    auto next = Gtk::make_managed<Gtk::Button>("Next");
+    buttons->pack_start(*previous, Gtk::PACK_SHRINK);
+    buttons->pack_start(*label, Gtk::PACK_EXPAND_WIDGET);
+    buttons->pack_start(*next, Gtk::PACK_SHRINK);
+    box->pack_start(*buttons, Gtk::PACK_SHRINK);
+
+    // Position of the first row
+    auto first = std::make_shared<size_t>(0);
+    const auto show = [first, list, label, previous, next, &selection](size_t f) {
+        const size_t count = selection.optionCount();
+        *first = count == 0 ? 0 : std::min(f, count - 1);
+        for (Gtk::Widget *child : list->get_children())
+        {
+            list->remove(*child);
+        }
+        std::pmr::vector<std::string_view> options;
+        selection.provider->fetch(*first, PickerRows, options);
+        for (auto option : options)
+        {
+            auto row = Gtk::make_managed<Gtk::Label>(convert(option));
+            row->set_xalign(0);
+            list->add(*row);
+        }
+        list->show_all_children();
+        label->set_text(Glib::ustring::compose("%1 of %2", count == 0 ? 0 : *first + 1, count));
+        previous->set_sensitive(*first > 0);
+        next->set_sensitive(*first + options.size() < count);
+    };
+
+    entry->signal_search_changed().connect([entry, &selection, show]() {
+        const size_t i = selection.provider->find(toView(entry->get_text()));
+        if (i != OptionProvider::npos)
+        {
+            show(i);
+        }
+    });
+    previous->signal_clicked().connect([first, show]() { show(*first < PickerRows ? 0 : *first - PickerRows); });
+    next->signal_clicked().connect([first, show]() { show(*first + PickerRows); });
+    list->signal_row_activated().connect([first, entry, &selection, tracker = tracker](Gtk::ListBoxRow *row) {
+        if (row == nullptr)
+        {
+            return;
+        }
+        prepareForm(tracker, &selection);
+        if (selection.select(*first + row->get_index()))
+        {
+            entry->set_text(convert(selection.key));
+            touchForm(tracker, &selection);
+        }
+    });
+    show(selection.valid() ? selection.index : 0);
+
+    frame->add(*box);
+    return frame;
+}
+
 Gtk::Widget *FormVisitor::operator()(StringSelection &selection)
 {
+    if (selection.provider != nullptr)
+    {
+        return optionPicker(selection);
+    }
     auto frame = makeFrame();
     Gtk::ComboBoxText *box = Gtk::make_managed<Gtk::ComboBoxText>();
     for (auto &text : selection.set)
@@ -133,7 +456,13 @@ Gtk::Widget *FormVisitor::operator()(StringSelection &selection)
     {
         box->set_active_text(convert(*s));
     }
-    box->signal_changed().connect([box, &selection]() { selection.setSelection(convert(box->get_active_text())); });
+    box->signal_changed().connect([box, &selection, tracker = tracker]() {
+        prepareForm(tracker, &selection);
+        if (selection.setSelection(convert(box->get_active_text())))
+        {
+            touchForm(tracker, &selection);
+        }
+    });
     frame->add(*box);
     return frame;
 }
@@ -146,7 +475,11 @@ Gtk::Widget *FormVisitor::operator()(StringMap &map)
     {
         Gtk::CheckButton *button = Gtk::make_managed<Gtk::CheckButton>(convert(pair.first));
         button->set_active(pair.second);
-        button->signal_clicked().connect([&pair, button]() { pair.second = button->get_active(); });
+        button->signal_clicked().connect([&pair, button, tracker = tracker]() {
+            prepareForm(tracker, &pair.second);
+            pair.second = button->get_active();
+            touchForm(tracker, &pair.second);
+        });
         box->add(*button);
     }
     frame->add(*box);
@@ -161,7 +494,7 @@ Gtk::Widget *FormVisitor::operator()(VariantForm &variant)
     box->set_spacing(10);
 
     auto over = Gtk::make_managed<Gtk::ComboBoxText>();
-    for (auto &[name, _] : variant.map)
+    for (auto &[name, _] : *variant)
     {
         over->append(convert(name));
     }
@@ -175,25 +508,54 @@ Gtk::Widget *FormVisitor::operator()(VariantForm &variant)
     using Map = std::pmr::map<Glib::ustring, Gtk::Widget *>;
     auto map = std::make_shared<Map>();
 
-    const auto activate = [map, &variant, over, under]() {
+    // Widgets are made when an alternative is first shown. Lazy alternatives are built then as well.
+    const auto activate = [map, &variant, over, under, tracker = tracker, widgets = widgets](FormVisitor &visitor) {
         const auto text = over->get_active_text();
-        variant.selected = convert(text);
+        const Atom key(convert(text));
+        Form *form = selectAlternative(tracker, variant, key);
+
+        // Alternatives that were dropped lose their widgets
+        for (auto iter = map->begin(); iter != map->end();)
+        {
+            const Atom name(convert(iter->first));
+            if (variant.isBuilt(name))
+            {
+                ++iter;
+                continue;
+            }
+            if (widgets != nullptr)
+            {
+                forgetInside(*widgets, *iter->second);
+                const auto &alternatives = variant.map.read();
+                auto alternative = alternatives.find(name);
+                if (alternative != alternatives.end())
+                {
+                    widgets->erase(&alternative->second);
+                }
+            }
+            under->remove(*iter->second);
+            iter = map->erase(iter);
+        }
+
         auto iter = map->find(text);
-        auto iter2 = variant.map.find(variant.selected);
-        if (iter == map->end() && iter2 != variant.map.end())
+        if (iter == map->end() && form != nullptr)
         {
-            Gtk::Widget *widget = std::visit(FormVisitor(), *iter2->second);
-            under->pack_start(*widget, Gtk::PACK_SHRINK);
-            under->show_all_children();
-            map->emplace(text, widget);
+            visitor.showInside(*form, std::string_view(), [map, under, text](Gtk::Widget *widget) {
+                under->pack_start(*widget, Gtk::PACK_SHRINK);
+                under->show_all_children();
+                map->emplace(text, widget);
+            });
         }
         for (auto &[name, widget] : *map)
         {
             widget->set_visible(name == text);
         }
     };
-    over->signal_changed().connect(activate);
-    activate();
+    over->signal_changed().connect([activate, tracker = tracker, widgets = widgets]() {
+        FormVisitor visitor(tracker, widgets);
+        activate(visitor);
+    });
+    activate(*this);
 
     frame->add(*box);
     return frame;
@@ -201,15 +563,7 @@ Gtk::Widget *FormVisitor::operator()(VariantForm &variant)
 
 Gtk::Widget *FormVisitor::operator()(EnableForm &enableForm)
 {
-    Gtk::Expander *expander = nullptr;
-    if (!name.empty())
-    {
-        expander = Gtk::make_managed<Gtk::Expander>();
-        expander->set_label(convert(name));
-        expander->set_label_fill(true);
-        expander->set_resize_toplevel(true);
-        expander->set_expanded(true);
-    }
+    Gtk::Expander *expander = makeExpander();
 
     auto box = Gtk::make_managed<Gtk::HBox>();
     box->set_spacing(10);
@@ -220,26 +574,31 @@ Gtk::Widget *FormVisitor::operator()(EnableForm &enableForm)
     auto right = Gtk::make_managed<Gtk::VBox>();
     box->pack_start(*right, Gtk::PACK_EXPAND_WIDGET);
 
-    using Map = std::pmr::map<String, Gtk::Widget *>;
+    using Map = std::pmr::map<Atom, Gtk::Widget *>;
     auto map = std::make_shared<Map>();
 
-    const auto activate = [map, right, &enableForm](const String &key, bool visible) {
+    const auto activate = [map, right, &enableForm, tracker = tracker](FormVisitor &visitor, const Atom &key,
+                                                                       bool visible) {
         auto iter = enableForm->find(key);
         if (iter == enableForm->end())
         {
             return;
         }
-        iter->second.first = visible;
+        if (iter->second.first != visible)
+        {
+            prepareForm(tracker, &iter->second.first);
+            iter->second.first = visible;
+            touchForm(tracker, &iter->second.first);
+        }
         auto iter2 = map->find(key);
         if (iter2 == map->end())
         {
-            FormVisitor visitor;
-            visitor.name = key;
-            auto widget = std::visit(visitor, *iter->second.second);
-            widget->set_visible(visible);
-            right->pack_start(*widget, Gtk::PACK_SHRINK);
-            right->show_all_children();
-            map->emplace(key, widget);
+            visitor.showInside(iter->second.second, key.view(), [map, right, key, visible](Gtk::Widget *widget) {
+                widget->set_visible(visible);
+                right->pack_start(*widget, Gtk::PACK_SHRINK);
+                right->show_all_children();
+                map->emplace(key, widget);
+            });
         }
         else
         {
@@ -247,65 +606,186 @@ Gtk::Widget *FormVisitor::operator()(EnableForm &enableForm)
         }
     };
 
-    for (auto &pair : enableForm.map)
+    for (auto &pair : *enableForm)
     {
         auto button = Gtk::make_managed<Gtk::CheckButton>(convert(pair.first));
         button->set_active(pair.second.first);
         if (pair.second.first)
         {
-            activate(pair.first, true);
+            activate(*this, pair.first, true);
         }
-        button->signal_toggled().connect(
-            [button, key = pair.first, activate]() { activate(key, button->get_active()); });
+        button->signal_toggled().connect([button, key = pair.first, activate, tracker = tracker, widgets = widgets]() {
+            FormVisitor visitor(tracker, widgets);
+            activate(visitor, key, button->get_active());
+        });
         left->pack_start(*button, Gtk::PACK_SHRINK);
     }
 
-    if (expander == nullptr)
-    {
-        return box;
-    }
-    expander->add(*box);
-    return expander;
+    return expand(expander, *box);
 }
 
 Gtk::Widget *FormVisitor::operator()(StructForm &structForm)
 {
-    Gtk::Expander *expander = nullptr;
-    if (!name.empty())
-    {
-        expander = Gtk::make_managed<Gtk::Expander>();
-        expander->set_label(convert(name));
-        expander->set_label_fill(true);
-        expander->set_resize_toplevel(true);
-        expander->set_expanded(true);
-    }
+    Gtk::Expander *expander = makeExpander();
 
-    Gtk::Grid *grid = Gtk::make_managed<Gtk::Grid>();
-    grid->set_row_spacing(10);
-    grid->set_column_spacing(10);
+    Gtk::Grid *grid = makeGrid();
     size_t index = 0;
     for (auto &[n, form] : *structForm)
     {
         const int row = index / structForm.columns;
         const int column = index % structForm.columns;
         name = n;
-        grid->attach(*std::visit(*this, *form), column, row);
+        grid->attach(*show(form), column, row);
         ++index;
     }
 
-    if (expander == nullptr)
+    return expand(expander, *grid);
+}
+
+Gtk::Widget *FormVisitor::operator()(BoundNumber &n)
+{
+    return std::visit(*this, n);
+}
+
+// Laid out like a StructForm
+Gtk::Widget *FormVisitor::operator()(BoundStruct &bound)
+{
+    Gtk::Expander *expander = makeExpander();
+
+    Gtk::Grid *grid = makeGrid();
+    size_t index = 0;
+    for (auto &field : bound.fields)
     {
-        return grid;
+        const int row = index / bound.columns;
+        const int column = index % bound.columns;
+        name = field.name;
+        Gtk::Widget *widget = std::visit(
+            [this](auto &value) -> Gtk::Widget * {
+                if constexpr (std::is_pointer_v<std::decay_t<decltype(value)>>)
+                {
+                    return this->operator()(*value);
+                }
+                else
+                {
+                    return this->operator()(value);
+                }
+            },
+            field.value);
+        grid->attach(*widget, column, row);
+        ++index;
     }
-    expander->add(*grid);
-    return expander;
+
+    return expand(expander, *grid);
 }
 
 void FormExecute::execute(std::string_view title, const std::shared_ptr<FormExecute> &formExecute, void *ptr)
 {
-    createWindow(
-        convert(title), std::make_pair(nullptr, std::visit(FormVisitor(), *(formExecute->form))), ptr, Gtk::Stock::OK,
-        [formExecute]() { formExecute->ok(); }, Gtk::Stock::CANCEL, [formExecute]() { formExecute->cancel(); });
+    auto widgets = std::make_shared<FormWidgets>();
+    FormTracker *tracker = &formExecute->track();
+    FormVisitor visitor(tracker, widgets);
+    BoundStruct *binding = formExecute->getBinding();
+    FormBatch *batch = formExecute->getBatch();
+    Gtk::Widget *widget = nullptr;
+    if (batch != nullptr)
+    {
+        widget = Gtk::make_managed<BatchView>(*batch);
+    }
+    else
+    {
+        widget = binding == nullptr ? visitor.show(formExecute->form) : visitor(*binding);
+    }
+
+    // Edits update the computed fields that read them and the widgets of the ones that changed
+    size_t listener = 0;
+    if (ComputedFields *computed = formExecute->getComputed())
+    {
+        Form *root = &formExecute->form;
+        listener = tracker->subscribe([computed, root, tracker, widgets](const FormPath &path, const Form &) {
+            computed->changed(path, *root, tracker, [&widgets, tracker](const FormPath &, Form &target) {
+                FormVisitor::refresh(widgets, tracker, target);
+            });
+        });
+    }
+
+    // Undo and redo replace the widgets of the forms they change
+    EditJournal *journal = formExecute->getJournal();
+    const auto replay = [journal, widgets, tracker](bool redo) {
+        Form *form = redo ? journal->redo() : journal->undo();
+        if (form != nullptr)
+        {
+            FormVisitor::refresh(widgets, tracker, *form);
+        }
+    };
+    if (journal != nullptr)
+    {
+        journal->attach(*tracker);
+        Gtk::VBox *vbox = Gtk::make_managed<Gtk::VBox>();
+        Gtk::HBox *hbox = Gtk::make_managed<Gtk::HBox>();
+        Gtk::Button *undo = Gtk::make_managed<Gtk::Button>(Gtk::Stock::UNDO);
+        undo->signal_clicked().connect([replay]() { replay(false); });
+        hbox->pack_start(*undo, Gtk::PACK_SHRINK);
+        Gtk::Button *redo = Gtk::make_managed<Gtk::Button>(Gtk::Stock::REDO);
+        redo->signal_clicked().connect([replay]() { replay(true); });
+        hbox->pack_start(*redo, Gtk::PACK_SHRINK);
+        vbox->pack_start(*hbox, Gtk::PACK_SHRINK);
+        vbox->pack_start(*widget, Gtk::PACK_EXPAND_WIDGET);
+        widget = vbox;
+    }
+
+    Gtk::Window *window = createWindow(
+        convert(title), std::make_pair(nullptr, widget), ptr, Gtk::Stock::OK,
+        [formExecute, widgets]() {
+            const auto errors = formExecute->validate();
+            FormVisitor::highlight(*widgets, errors);
+            if (!errors.empty())
+            {
+                return false;
+            }
+            formExecute->commit();
+            formExecute->ok();
+            return true;
+        },
+        Gtk::Stock::CANCEL,
+        [formExecute]() {
+            formExecute->rollback();
+            formExecute->cancel();
+        });
+    // Closing the window cancels the dialog as well
+    window->signal_delete_event().connect([formExecute](GdkEventAny *) {
+        formExecute->rollback();
+        formExecute->cancel();
+        return false;
+    });
+    if (listener != 0)
+    {
+        window->signal_hide().connect([tracker, listener]() { tracker->unsubscribe(listener); });
+    }
+    if (journal != nullptr)
+    {
+        window->add_events(Gdk::KEY_PRESS_MASK);
+        window->signal_key_press_event().connect(
+            [replay](GdkEventKey *event) {
+                if ((event->state & GDK_CONTROL_MASK) == 0)
+                {
+                    return false;
+                }
+                const bool shift = (event->state & GDK_SHIFT_MASK) != 0;
+                switch (event->keyval)
+                {
+                case GDK_KEY_z:
+                case GDK_KEY_Z:
+                    replay(shift);
+                    return true;
+                case GDK_KEY_y:
+                    replay(true);
+                    return true;
+                default:
+                    return false;
+                }
+            },
+            false);
+        window->signal_hide().connect([journal]() { journal->detach(); });
+    }
 }
 
 } // namespace CanForm
\ No newline at end of file
@@ -0,0 +1,288 @@
+#include <cstring>
+#include <hash.hpp>
+
+namespace CanForm
+{
+// 64 bit FNV-1a for strings, mixed with the splitmix64 finalizer when values are combined
+static constexpr uint64_t hashBytes(std::string_view s, uint64_t hash = 14695981039346656037ull) noexcept
+{
+    for (char c : s)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static constexpr uint64_t mix(uint64_t h) noexcept
+{
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return h;
+}
+
+static constexpr uint64_t combine(uint64_t seed, uint64_t value) noexcept
+{
+    return mix(seed + 0x9e3779b97f4a7c15ull + value);
+}
+
+template <typename T> static uint64_t hashNumber(T t) noexcept
+{
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        // 0 and -0 compare equal so they must hash the same
+        if (t == 0)
+        {
+            t = 0;
+        }
+        double d = t;
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        return bits;
+    }
+    else
+    {
+        return static_cast<uint64_t>(t);
+    }
+}
+
+template <typename Strings> static uint64_t hashStrings(const Strings &strings, uint64_t seed) noexcept
+{
+    for (const auto &s : strings)
+    {
+        seed = combine(seed, hashBytes(s));
+    }
+    return combine(seed, strings.size());
+}
+
+static uint64_t hashKey(const Atom &key, uint64_t seed) noexcept
+{
+    return combine(seed, (static_cast<uint64_t>(key.hash()) << 32) | key.size());
+}
+
+// Zero marks an empty cache
+static uint64_t store(uint64_t &cache, uint64_t hash) noexcept
+{
+    cache = hash == 0 ? 1 : hash;
+    return cache;
+}
+
+struct Hasher
+{
+    // Whether the hashes cached in StructForm, EnableForm and VariantForm are read and stored
+    bool cached;
+
+    uint64_t operator()(const Form &form) const noexcept
+    {
+        return combine(form->index(), visit(*this, form));
+    }
+
+    uint64_t remember(uint64_t &cache, uint64_t hash) const noexcept
+    {
+        return cached ? store(cache, hash) : hash;
+    }
+
+    uint64_t operator()(std::monostate) const noexcept
+    {
+        return 0;
+    }
+
+    uint64_t operator()(bool b) const noexcept
+    {
+        return b ? 1 : 0;
+    }
+
+    uint64_t operator()(const String &s) const noexcept
+    {
+        return hashBytes(s);
+    }
+
+    uint64_t operator()(const RangedValue &value) const noexcept
+    {
+        return std::visit(
+            [&value](const auto &range) {
+                const auto [min, max] = range.getMinMax();
+                uint64_t hash = combine(value.index(), hashNumber(*range));
+                hash = combine(hash, hashNumber(min));
+                return combine(hash, hashNumber(max));
+            },
+            value);
+    }
+
+    uint64_t operator()(const ComplexString &c) const noexcept
+    {
+        uint64_t hash = hashBytes(c.string);
+        for (const auto &[key, set] : c.map)
+        {
+            hash = hashStrings(set, combine(hash, hashBytes(key)));
+        }
+        return combine(hash, c.map.size());
+    }
+
+    uint64_t operator()(const StringSet &set) const noexcept
+    {
+        return hashStrings(set, 0);
+    }
+
+    uint64_t operator()(const StringSelection &selection) const noexcept
+    {
+        const uint64_t hash = hashStrings(selection.set, static_cast<uint64_t>(selection.index));
+        // Options of a provider are not part of the form
+        return selection.provider == nullptr ? hash : combine(hash, hashBytes(selection.key));
+    }
+
+    uint64_t operator()(const StringMap &map) const noexcept
+    {
+        uint64_t hash = 0;
+        for (const auto &[key, flag] : map)
+        {
+            hash = combine(combine(hash, hashBytes(key)), flag ? 1 : 0);
+        }
+        return combine(hash, map.size());
+    }
+
+    uint64_t operator()(const VariantForm &variant) const noexcept
+    {
+        if (cached && variant.cachedHash != 0)
+        {
+            return variant.cachedHash;
+        }
+        uint64_t hash = hashBytes(variant.selected);
+        for (const auto &[key, form] : *variant)
+        {
+            hash = combine(hashKey(key, hash), operator()(form));
+        }
+        return remember(variant.cachedHash, combine(hash, variant->size()));
+    }
+
+    uint64_t operator()(const StructForm &structForm) const noexcept
+    {
+        if (cached && structForm.cachedHash != 0)
+        {
+            return structForm.cachedHash;
+        }
+        uint64_t hash = structForm.columns;
+        for (const auto &[key, form] : *structForm)
+        {
+            hash = combine(hashKey(key, hash), operator()(form));
+        }
+        return remember(structForm.cachedHash, combine(hash, structForm->size()));
+    }
+
+    uint64_t operator()(const EnableForm &enableForm) const noexcept
+    {
+        if (cached && enableForm.cachedHash != 0)
+        {
+            return enableForm.cachedHash;
+        }
+        uint64_t hash = 0;
+        for (const auto &[key, pair] : *enableForm)
+        {
+            hash = combine(combine(hashKey(key, hash), pair.first ? 1 : 0), operator()(pair.second));
+        }
+        return remember(enableForm.cachedHash, combine(hash, enableForm->size()));
+    }
+};
+
+FormHash hashForm(const Form &form)
+{
+    return Hasher{false}(form);
+}
+
+FormHash hashCached(const Form &form)
+{
+    return Hasher{true}(form);
+}
+
+// Entries are compared in order. Shared maps are not walked at all.
+template <typename Map, typename F> static bool sameEntries(const Map &a, const Map &b, F &&same)
+{
+    if (&a == &b)
+    {
+        return true;
+    }
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    auto x = a.begin();
+    for (auto y = b.begin(); y != b.end(); ++x, ++y)
+    {
+        if (x->first != y->first || !same(x->second, y->second))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool same(const Form &a, const Form &b)
+{
+    if (&a == &b)
+    {
+        return true;
+    }
+    if (a->index() != b->index())
+    {
+        return false;
+    }
+    return visit(
+        [&b](const auto &x) {
+            using T = std::decay_t<decltype(x)>;
+            const T &y = b.get<T>();
+            if constexpr (std::is_same_v<T, std::monostate>)
+            {
+                return true;
+            }
+            else if constexpr (std::is_same_v<T, RangedValue>)
+            {
+                return x.index() == y.index() && std::visit(
+                                                     [&y](const auto &r) {
+                                                         const auto &s = std::get<std::decay_t<decltype(r)>>(y);
+                                                         return *r == *s && r.getMinMax() == s.getMinMax();
+                                                     },
+                                                     x);
+            }
+            else if constexpr (std::is_same_v<T, ComplexString>)
+            {
+                return x.string == y.string && x.map == y.map;
+            }
+            else if constexpr (std::is_same_v<T, StringSelection>)
+            {
+                return x.index == y.index && x.provider == y.provider && x.key == y.key &&
+                       x.set.size() == y.set.size() && std::equal(x.set.begin(), x.set.end(), y.set.begin());
+            }
+            else if constexpr (std::is_same_v<T, StringMap>)
+            {
+                return sameEntries(x, y, [](bool p, bool q) { return p == q; });
+            }
+            else if constexpr (std::is_same_v<T, VariantForm>)
+            {
+                return x.selected == y.selected && sameEntries(*x, *y, same);
+            }
+            else if constexpr (std::is_same_v<T, StructForm>)
+            {
+                return x.columns == y.columns && sameEntries(*x, *y, same);
+            }
+            else if constexpr (std::is_same_v<T, EnableForm>)
+            {
+                return sameEntries(*x, *y, [](const EnableForm::Value &p, const EnableForm::Value &q) {
+                    return p.first == q.first && same(p.second, q.second);
+                });
+            }
+            else
+            {
+                return x == y;
+            }
+        },
+        a);
+}
+
+bool equal(const Form &a, const Form &b)
+{
+    return same(a, b);
+}
+} // namespace CanForm
@@ -0,0 +1,357 @@
+#include <algorithm>
+#include <hash.hpp>
+#include <journal.hpp>
+#include <tracker.hpp>
+
+namespace CanForm
+{
+using Kind = PatchOperation::Kind;
+
+EditJournal::EditJournal(size_t c, const allocator_type &allocator)
+    : ring(allocator), capacity(std::max<size_t>(c, 1)), first(0), count(0), applied(0),
+      pending{nullptr, Form(allocator), Atom(), std::pmr::vector<std::pair<Atom, bool>>(allocator)}, tracker(nullptr),
+      preparer(0), listener(0), replaying(false), sealed(false)
+{
+    ring.reserve(capacity);
+}
+
+EditJournal::~EditJournal()
+{
+    detach();
+}
+
+void EditJournal::attach(FormTracker &t)
+{
+    detach();
+    tracker = &t;
+    preparer = t.subscribeBefore([this](const FormPath &path, const Form &form) { prepare(path, form); });
+    listener = t.subscribe([this](const FormPath &path, const Form &form) { record(path, form); });
+}
+
+void EditJournal::detach()
+{
+    if (tracker != nullptr)
+    {
+        tracker->unsubscribe(preparer);
+        tracker->unsubscribe(listener);
+        tracker = nullptr;
+    }
+    pending.form = nullptr;
+}
+
+void EditJournal::prepare(const FormPath &, const Form &form)
+{
+    if (replaying)
+    {
+        return;
+    }
+    pending.form = &form;
+    if (auto variant = form.getIf<VariantForm>())
+    {
+        pending.selected = Atom(variant->selected);
+    }
+    else if (auto enableForm = form.getIf<EnableForm>())
+    {
+        pending.flags.clear();
+        for (const auto &[key, pair] : **enableForm)
+        {
+            pending.flags.emplace_back(key, pair.first);
+        }
+    }
+    else if (form.holds<StructForm>())
+    {
+        // The backends do not edit structs themselves
+        pending.form = nullptr;
+    }
+    else
+    {
+        pending.value = form;
+    }
+}
+
+void EditJournal::record(const FormPath &path, const Form &form)
+{
+    // Touches without a prepare, such as the targets of computed fields or nested touches, are not edits
+    if (replaying || pending.form != &form)
+    {
+        return;
+    }
+    pending.form = nullptr;
+    const allocator_type allocator = get_allocator();
+
+    if (auto variant = form.getIf<VariantForm>())
+    {
+        if (pending.selected == variant->selected)
+        {
+            return;
+        }
+        Edit edit{PatchOperation(Kind::Switch, path, allocator), PatchOperation(Kind::Switch, path, allocator), false};
+        edit.undo.text = pending.selected.view();
+        edit.redo.text = variant->selected;
+        push(std::move(edit));
+        return;
+    }
+
+    if (auto enableForm = form.getIf<EnableForm>())
+    {
+        FormPath fieldPath(path, allocator);
+        for (const auto &[key, flag] : pending.flags)
+        {
+            auto iter = (*enableForm)->find(key);
+            if (iter == (*enableForm)->end() || iter->second.first == flag)
+            {
+                continue;
+            }
+            fieldPath.push_back(key);
+            Edit edit{PatchOperation(Kind::Enable, fieldPath, allocator),
+                      PatchOperation(Kind::Enable, fieldPath, allocator), false};
+            edit.undo.flag = flag;
+            edit.redo.flag = !flag;
+            push(std::move(edit));
+            fieldPath.pop_back();
+        }
+        return;
+    }
+
+    if (equal(pending.value, form))
+    {
+        return;
+    }
+    const bool text = form.holds<String>() || form.holds<ComplexString>();
+    if (text && !sealed && count > 0 && applied == count)
+    {
+        Edit &last = at(count - 1);
+        if (last.text && last.redo.path == path)
+        {
+            last.redo.value = form;
+            return;
+        }
+    }
+    Edit edit{PatchOperation(Kind::Replace, path, allocator), PatchOperation(Kind::Replace, path, allocator), text};
+    edit.undo.value = std::move(pending.value);
+    edit.redo.value = form;
+    push(std::move(edit));
+}
+
+void EditJournal::push(Edit &&edit)
+{
+    // A new edit drops the ones that were undone
+    count = applied;
+    if (count == capacity)
+    {
+        first = (first + 1) % capacity;
+        --count;
+    }
+    const size_t slot = (first + count) % capacity;
+    if (slot < ring.size())
+    {
+        ring[slot] = std::move(edit);
+    }
+    else
+    {
+        ring.push_back(std::move(edit));
+    }
+    applied = ++count;
+    sealed = false;
+}
+
+// Applies an operation that restores a value. Leaves are assigned in place so the widgets and the tracker keep their
+// addresses. Returns the form that changed after touching it.
+static Form *restore(FormTracker &tracker, const PatchOperation &op)
+{
+    Form *root = tracker.getRoot();
+    if (root == nullptr)
+    {
+        return nullptr;
+    }
+
+    Form *form = nullptr;
+    // Whether the addresses the tracker collected are still valid
+    bool moved = false;
+    switch (op.kind)
+    {
+    case Kind::Replace:
+        form = resolve(*root, op.path);
+        if (form == nullptr)
+        {
+            return nullptr;
+        }
+        if (form->data.index() == op.value.data.index())
+        {
+            form->visit([&op](auto &value) { value = op.value.get<std::decay_t<decltype(value)>>(); });
+        }
+        else
+        {
+            *form = op.value;
+            moved = true;
+        }
+        break;
+    case Kind::Switch: {
+        form = resolve(*root, op.path);
+        auto variant = form == nullptr ? nullptr : form->getIf<VariantForm>();
+        if (variant == nullptr)
+        {
+            return nullptr;
+        }
+        const Atom key(op.text);
+        // Lazy alternatives are built or dropped
+        moved = variant->isLazy(key) || variant->isLazy(Atom(variant->selected));
+        if (variant->select(key) == nullptr)
+        {
+            return nullptr;
+        }
+        break;
+    }
+    case Kind::Enable: {
+        if (!apply(*root, op))
+        {
+            return nullptr;
+        }
+        const FormPath parent(op.path.begin(), op.path.end() - 1, op.path.get_allocator());
+        form = resolve(*root, parent);
+        break;
+    }
+    default:
+        return nullptr;
+    }
+
+    if (moved)
+    {
+        tracker.retrack();
+    }
+    tracker.touch(form);
+    return form;
+}
+
+Form *EditJournal::replay(const PatchOperation &op)
+{
+    if (tracker == nullptr)
+    {
+        return nullptr;
+    }
+    struct Replaying
+    {
+        bool &flag;
+        ~Replaying()
+        {
+            flag = false;
+        }
+    } running{replaying};
+    replaying = true;
+    return restore(*tracker, op);
+}
+
+Form *EditJournal::undo()
+{
+    if (!canUndo())
+    {
+        return nullptr;
+    }
+    Form *form = replay(at(applied - 1).undo);
+    if (form != nullptr)
+    {
+        --applied;
+        sealed = true;
+    }
+    return form;
+}
+
+Form *EditJournal::redo()
+{
+    if (!canRedo())
+    {
+        return nullptr;
+    }
+    Form *form = replay(at(applied).redo);
+    if (form != nullptr)
+    {
+        ++applied;
+        sealed = true;
+    }
+    return form;
+}
+
+void EditJournal::clear() noexcept
+{
+    ring.clear();
+    first = 0;
+    count = 0;
+    applied = 0;
+    pending.form = nullptr;
+    sealed = false;
+}
+
+FormTransaction::FormTransaction(const allocator_type &allocator)
+    : operations(allocator), edited(allocator), tracker(nullptr), preparer(0)
+{
+}
+
+FormTransaction::~FormTransaction()
+{
+    commit();
+}
+
+void FormTransaction::begin(FormTracker &t)
+{
+    commit();
+    tracker = &t;
+    preparer = t.subscribeBefore([this](const FormPath &path, const Form &form) { prepare(path, form); });
+}
+
+void FormTransaction::prepare(const FormPath &path, const Form &form)
+{
+    // Only the value from before the first edit is needed
+    if (form.holds<StructForm>() || !edited.insert(path).second)
+    {
+        return;
+    }
+    if (auto variant = form.getIf<VariantForm>())
+    {
+        operations.emplace_back(Kind::Switch, path).text = variant->selected;
+    }
+    else if (auto enableForm = form.getIf<EnableForm>())
+    {
+        FormPath fieldPath(path, get_allocator());
+        for (const auto &[key, pair] : **enableForm)
+        {
+            fieldPath.push_back(key);
+            operations.emplace_back(Kind::Enable, fieldPath).flag = pair.first;
+            fieldPath.pop_back();
+        }
+    }
+    else
+    {
+        operations.emplace_back(Kind::Replace, path).value = form;
+    }
+}
+
+void FormTransaction::commit() noexcept
+{
+    if (tracker != nullptr)
+    {
+        tracker->unsubscribe(preparer);
+        tracker = nullptr;
+    }
+    operations.clear();
+    edited.clear();
+}
+
+size_t FormTransaction::rollback()
+{
+    size_t restored = 0;
+    if (tracker != nullptr)
+    {
+        FormTracker &t = *tracker;
+        t.unsubscribe(preparer);
+        tracker = nullptr;
+        // Last edited first, so forms inside a VariantForm are restored before it switches back
+        for (auto iter = operations.rbegin(); iter != operations.rend(); ++iter)
+        {
+            restored += restore(t, *iter) != nullptr;
+        }
+    }
+    operations.clear();
+    edited.clear();
+    return restored;
+}
+} // namespace CanForm
@@ -0,0 +1,1171 @@
+#include <cstring>
+#include <json.hpp>
+#include <memory>
+
+#if _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace CanForm
+{
+#if _WIN32
+static long writeFile(int fd, const char *data, size_t size)
+{
+    return _write(fd, data, static_cast<unsigned int>(size));
+}
+static long readFile(int fd, char *data, size_t size)
+{
+    return _read(fd, data, static_cast<unsigned int>(size));
+}
+static int openFile(const char *path, bool writing)
+{
+    return writing ? _open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644) : _open(path, _O_RDONLY | _O_BINARY);
+}
+static int closeFile(int fd)
+{
+    return _close(fd);
+}
+#else
+static long writeFile(int fd, const char *data, size_t size)
+{
+    return ::write(fd, data, size);
+}
+static long readFile(int fd, char *data, size_t size)
+{
+    return ::read(fd, data, size);
+}
+static int openFile(const char *path, bool writing)
+{
+    return writing ? ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644) : ::open(path, O_RDONLY);
+}
+static int closeFile(int fd)
+{
+    return ::close(fd);
+}
+#endif
+
+JsonWriter::JsonWriter(int f) : fd(f), string(nullptr), used(0), failed(false), first(), afterKey(false)
+{
+}
+
+JsonWriter::JsonWriter(String &s) : fd(-1), string(&s), used(0), failed(false), first(), afterKey(false)
+{
+}
+
+JsonWriter::~JsonWriter()
+{
+    flush();
+}
+
+bool JsonWriter::flush()
+{
+    if (string != nullptr)
+    {
+        string->append(buffer, used);
+    }
+    else
+    {
+        size_t written = 0;
+        while (!failed && written < used)
+        {
+            const long n = writeFile(fd, buffer + written, used - written);
+            if (n <= 0)
+            {
+                failed = true;
+            }
+            else
+            {
+                written += n;
+            }
+        }
+    }
+    used = 0;
+    return !failed;
+}
+
+void JsonWriter::put(std::string_view s)
+{
+    while (!s.empty())
+    {
+        if (used == BufferSize)
+        {
+            flush();
+        }
+        const size_t n = std::min(s.size(), BufferSize - used);
+        std::memcpy(buffer + used, s.data(), n);
+        used += n;
+        s.remove_prefix(n);
+    }
+}
+
+void JsonWriter::separate()
+{
+    if (afterKey)
+    {
+        afterKey = false;
+    }
+    else if (!first.empty())
+    {
+        if (first.back())
+        {
+            put(',');
+        }
+        first.back() = 1;
+    }
+}
+
+void JsonWriter::quoted(std::string_view s)
+{
+    constexpr char Hex[] = "0123456789abcdef";
+    put('"');
+    size_t start = 0;
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+        const unsigned char c = s[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+        put(s.substr(start, i - start));
+        start = i + 1;
+        put('\\');
+        switch (c)
+        {
+        case '"':
+        case '\\':
+            put(static_cast<char>(c));
+            break;
+        case '\n':
+            put('n');
+            break;
+        case '\r':
+            put('r');
+            break;
+        case '\t':
+            put('t');
+            break;
+        case '\b':
+            put('b');
+            break;
+        case '\f':
+            put('f');
+            break;
+        default:
+            put("u00");
+            put(Hex[c >> 4]);
+            put(Hex[c & 0xf]);
+            break;
+        }
+    }
+    put(s.substr(start));
+    put('"');
+}
+
+void JsonWriter::beginObject()
+{
+    separate();
+    put('{');
+    first.push_back(0);
+}
+
+void JsonWriter::endObject()
+{
+    first.pop_back();
+    put('}');
+}
+
+void JsonWriter::beginArray()
+{
+    separate();
+    put('[');
+    first.push_back(0);
+}
+
+void JsonWriter::endArray()
+{
+    first.pop_back();
+    put(']');
+}
+
+void JsonWriter::key(std::string_view k)
+{
+    separate();
+    quoted(k);
+    put(':');
+    afterKey = true;
+}
+
+void JsonWriter::null()
+{
+    separate();
+    put("null");
+}
+
+void JsonWriter::value(bool b)
+{
+    separate();
+    put(b ? std::string_view("true") : std::string_view("false"));
+}
+
+void JsonWriter::value(std::string_view s)
+{
+    separate();
+    quoted(s);
+}
+
+// Parser states inside the current container
+enum : char
+{
+    AfterOpen,
+    AfterComma,
+    AfterKey,
+    AfterValue
+};
+
+JsonReader::JsonReader(int f)
+    : fd(f), data(buffer), size(0), position(0), line(1), token(), levels(), error(nullptr)
+{
+    levels.push_back(Level{AfterOpen, false});
+}
+
+JsonReader::JsonReader(std::string_view s)
+    : fd(-1), data(s.data()), size(s.size()), position(0), line(1), token(), levels(), error(nullptr)
+{
+    levels.push_back(Level{AfterOpen, false});
+}
+
+bool JsonReader::fill()
+{
+    if (fd < 0)
+    {
+        return false;
+    }
+    const long n = readFile(fd, buffer, BufferSize);
+    if (n <= 0)
+    {
+        return false;
+    }
+    data = buffer;
+    size = n;
+    position = 0;
+    return true;
+}
+
+int JsonReader::peek()
+{
+    if (position == size && !fill())
+    {
+        return -1;
+    }
+    return static_cast<unsigned char>(data[position]);
+}
+
+int JsonReader::get()
+{
+    const int c = peek();
+    if (c >= 0)
+    {
+        ++position;
+    }
+    return c;
+}
+
+bool JsonReader::skipSpace()
+{
+    while (true)
+    {
+        const int c = peek();
+        switch (c)
+        {
+        case '\n':
+            ++line;
+            [[fallthrough]];
+        case ' ':
+        case '\t':
+        case '\r':
+            ++position;
+            break;
+        default:
+            return c >= 0;
+        }
+    }
+}
+
+JsonReader::Token JsonReader::fail(const char *message)
+{
+    if (error == nullptr)
+    {
+        error = message;
+    }
+    return Token::Error;
+}
+
+bool JsonReader::literal(std::string_view s)
+{
+    for (char c : s)
+    {
+        if (get() != c)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void appendUtf8(String &s, uint32_t c)
+{
+    if (c < 0x80)
+    {
+        s += static_cast<char>(c);
+    }
+    else if (c < 0x800)
+    {
+        s += static_cast<char>(0xc0 | (c >> 6));
+        s += static_cast<char>(0x80 | (c & 0x3f));
+    }
+    else if (c < 0x10000)
+    {
+        s += static_cast<char>(0xe0 | (c >> 12));
+        s += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        s += static_cast<char>(0x80 | (c & 0x3f));
+    }
+    else
+    {
+        s += static_cast<char>(0xf0 | (c >> 18));
+        s += static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+        s += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        s += static_cast<char>(0x80 | (c & 0x3f));
+    }
+}
+
+bool JsonReader::readString()
+{
+    auto hex = [this]() -> int32_t {
+        int32_t value = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            const int c = get();
+            value <<= 4;
+            if ('0' <= c && c <= '9')
+            {
+                value |= c - '0';
+            }
+            else if ('a' <= c && c <= 'f')
+            {
+                value |= c - 'a' + 10;
+            }
+            else if ('A' <= c && c <= 'F')
+            {
+                value |= c - 'A' + 10;
+            }
+            else
+            {
+                return -1;
+            }
+        }
+        return value;
+    };
+
+    token.clear();
+    get();
+    while (true)
+    {
+        // Copy runs of plain characters straight from the buffer
+        size_t start = position;
+        while (position < size && data[position] != '"' && data[position] != '\\' &&
+               static_cast<unsigned char>(data[position]) >= 0x20)
+        {
+            ++position;
+        }
+        token.append(data + start, position - start);
+
+        int c = get();
+        if (c == '"')
+        {
+            return true;
+        }
+        if (c < 0)
+        {
+            fail("Unterminated string");
+            return false;
+        }
+        if (c != '\\')
+        {
+            if (c < 0x20)
+            {
+                fail("Control character in string");
+                return false;
+            }
+            token += static_cast<char>(c);
+            continue;
+        }
+        c = get();
+        switch (c)
+        {
+        case '"':
+        case '\\':
+        case '/':
+            token += static_cast<char>(c);
+            break;
+        case 'n':
+            token += '\n';
+            break;
+        case 'r':
+            token += '\r';
+            break;
+        case 't':
+            token += '\t';
+            break;
+        case 'b':
+            token += '\b';
+            break;
+        case 'f':
+            token += '\f';
+            break;
+        case 'u': {
+            int32_t code = hex();
+            if (code < 0)
+            {
+                fail("Invalid unicode escape");
+                return false;
+            }
+            if (0xd800 <= code && code < 0xdc00)
+            {
+                if (get() != '\\' || get() != 'u')
+                {
+                    fail("Unpaired surrogate");
+                    return false;
+                }
+                const int32_t low = hex();
+                if (low < 0xdc00 || low >= 0xe000)
+                {
+                    fail("Unpaired surrogate");
+                    return false;
+                }
+                code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+            }
+            appendUtf8(token, code);
+            break;
+        }
+        default:
+            fail("Invalid escape");
+            return false;
+        }
+    }
+}
+
+bool JsonReader::readNumber()
+{
+    token.clear();
+    auto digits = [this]() {
+        size_t count = 0;
+        for (int c = peek(); '0' <= c && c <= '9'; c = peek())
+        {
+            token += static_cast<char>(get());
+            ++count;
+        }
+        return count;
+    };
+
+    if (peek() == '-')
+    {
+        token += static_cast<char>(get());
+    }
+    const bool zero = peek() == '0';
+    const size_t whole = digits();
+    if (whole == 0 || (zero && whole > 1))
+    {
+        fail("Invalid number");
+        return false;
+    }
+    if (peek() == '.')
+    {
+        token += static_cast<char>(get());
+        if (digits() == 0)
+        {
+            fail("Invalid number");
+            return false;
+        }
+    }
+    if (peek() == 'e' || peek() == 'E')
+    {
+        token += static_cast<char>(get());
+        if (peek() == '+' || peek() == '-')
+        {
+            token += static_cast<char>(get());
+        }
+        if (digits() == 0)
+        {
+            fail("Invalid number");
+            return false;
+        }
+    }
+    return true;
+}
+
+JsonReader::Token JsonReader::next()
+{
+    if (error != nullptr)
+    {
+        return Token::Error;
+    }
+    const bool topLevel = levels.size() == 1;
+    Level &level = levels.back();
+    if (!skipSpace())
+    {
+        if (topLevel && level.state == AfterValue)
+        {
+            return Token::End;
+        }
+        return fail("Unexpected end of input");
+    }
+    int c = peek();
+    if (topLevel)
+    {
+        if (level.state == AfterValue)
+        {
+            return fail("Unexpected data after value");
+        }
+    }
+    else
+    {
+        const char closer = level.object ? '}' : ']';
+        if (c == closer)
+        {
+            if (level.state == AfterComma || level.state == AfterKey)
+            {
+                return fail("Unexpected end of container");
+            }
+            ++position;
+            levels.pop_back();
+            return closer == '}' ? Token::EndObject : Token::EndArray;
+        }
+        if (level.state == AfterValue)
+        {
+            if (c != ',')
+            {
+                return fail("Expected ',' or end of container");
+            }
+            ++position;
+            level.state = AfterComma;
+            if (!skipSpace())
+            {
+                return fail("Unexpected end of input");
+            }
+            c = peek();
+        }
+        if (level.object && level.state != AfterKey)
+        {
+            if (c != '"')
+            {
+                return fail("Expected key");
+            }
+            if (!readString())
+            {
+                return Token::Error;
+            }
+            if (!skipSpace() || get() != ':')
+            {
+                return fail("Expected ':'");
+            }
+            level.state = AfterKey;
+            return Token::Key;
+        }
+    }
+
+    // The container holding this value is complete once it ends
+    level.state = AfterValue;
+    switch (c)
+    {
+    case '{':
+    case '[':
+        ++position;
+        levels.push_back(Level{AfterOpen, c == '{'});
+        return c == '{' ? Token::BeginObject : Token::BeginArray;
+    case '"':
+        if (!readString())
+        {
+            return Token::Error;
+        }
+                return Token::String;
+    case 't':
+        return literal("true") ? Token::True : fail("Invalid literal");
+    case 'f':
+        return literal("false") ? Token::False : fail("Invalid literal");
+    case 'n':
+        return literal("null") ? Token::Null : fail("Invalid literal");
+    default:
+        if (c == '-' || ('0' <= c && c <= '9'))
+        {
+            if (!readNumber())
+            {
+                return Token::Error;
+            }
+                        return Token::Number;
+        }
+        return fail("Unexpected character");
+    }
+}
+
+bool JsonReader::skip(Token token)
+{
+    size_t depth = 0;
+    while (true)
+    {
+        switch (token)
+        {
+        case Token::BeginObject:
+        case Token::BeginArray:
+            ++depth;
+            break;
+        case Token::EndObject:
+        case Token::EndArray:
+            --depth;
+            break;
+        case Token::Error:
+        case Token::End:
+            return false;
+        default:
+            break;
+        }
+        if (depth == 0)
+        {
+            return true;
+        }
+        token = next();
+    }
+}
+
+// Indexed the same as RangedValue
+static constexpr std::string_view RangeNames[] = {"int8",   "int16",  "int32",  "int64", "uint8",
+                                                  "uint16", "uint32", "uint64", "float", "double"};
+static_assert(std::size(RangeNames) == std::variant_size_v<RangedValue>);
+
+struct JsonFormWriter
+{
+    JsonWriter &writer;
+
+    void operator()(const Form &form)
+    {
+        visit(*this, form);
+    }
+
+    void operator()(std::monostate)
+    {
+        writer.null();
+    }
+
+    void operator()(bool b)
+    {
+        writer.value(b);
+    }
+
+    void operator()(const String &s)
+    {
+        writer.value(s);
+    }
+
+    void operator()(const RangedValue &value)
+    {
+        writer.beginObject();
+        writer.key("range");
+        writer.value(RangeNames[value.index()]);
+        std::visit(
+            [this](const auto &range) {
+                const auto [min, max] = range.getMinMax();
+                writer.key("value");
+                writer.value(*range);
+                writer.key("min");
+                writer.value(min);
+                writer.key("max");
+                writer.value(max);
+            },
+            value);
+        writer.endObject();
+    }
+
+    template <typename Set> void strings(const Set &set)
+    {
+        writer.beginArray();
+        for (const auto &s : set)
+        {
+            writer.value(s);
+        }
+        writer.endArray();
+    }
+
+    void operator()(const ComplexString &c)
+    {
+        writer.beginObject();
+        writer.key("complex");
+        writer.value(c.string);
+        writer.key("map");
+        writer.beginObject();
+        for (const auto &[key, set] : c.map)
+        {
+            writer.key(key);
+            strings(set);
+        }
+        writer.endObject();
+        writer.endObject();
+    }
+
+    void operator()(const StringSet &set)
+    {
+        writer.beginObject();
+        writer.key("set");
+        strings(set);
+        writer.endObject();
+    }
+
+    void operator()(const StringSelection &selection)
+    {
+        writer.beginObject();
+        writer.key("selection");
+        writer.value(selection.index);
+        writer.key("options");
+        strings(selection.set);
+        // The options of a provider are not saved, only the chosen one
+        if (selection.provider != nullptr)
+        {
+            writer.key("key");
+            writer.value(selection.key);
+        }
+        writer.endObject();
+    }
+
+    void operator()(const StringMap &map)
+    {
+        writer.beginObject();
+        writer.key("flags");
+        writer.beginObject();
+        for (const auto &[key, flag] : map)
+        {
+            writer.key(key);
+            writer.value(flag);
+        }
+        writer.endObject();
+        writer.endObject();
+    }
+
+    void operator()(const VariantForm &variant)
+    {
+        writer.beginObject();
+        writer.key("variant");
+        writer.value(variant.selected);
+        writer.key("forms");
+        writer.beginObject();
+        for (const auto &[key, form] : *variant)
+        {
+            writer.key(key);
+            operator()(form);
+        }
+        writer.endObject();
+        writer.endObject();
+    }
+
+    void operator()(const StructForm &structForm)
+    {
+        writer.beginObject();
+        writer.key("struct");
+        writer.value(structForm.columns);
+        writer.key("fields");
+        writer.beginObject();
+        for (const auto &[key, form] : *structForm)
+        {
+            writer.key(key);
+            operator()(form);
+        }
+        writer.endObject();
+        writer.endObject();
+    }
+
+    void operator()(const EnableForm &enableForm)
+    {
+        writer.beginObject();
+        writer.key("enable");
+        writer.beginObject();
+        for (const auto &[key, pair] : *enableForm)
+        {
+            writer.key(key);
+            writer.beginArray();
+            writer.value(pair.first);
+            operator()(pair.second);
+            writer.endArray();
+        }
+        writer.endObject();
+        writer.endObject();
+    }
+};
+
+void writeJson(const Form &form, JsonWriter &writer)
+{
+    JsonFormWriter formWriter{writer};
+    formWriter(form);
+}
+
+class JsonFormReader
+{
+  private:
+    using Token = JsonReader::Token;
+
+    JsonReader &reader;
+
+    bool fail(const char *message)
+    {
+        reader.fail(message);
+        return false;
+    }
+
+    bool expect(Token token)
+    {
+        const Token t = reader.next();
+        return t == token || fail("Unexpected token");
+    }
+
+    // Calls f(key) for every remaining key of the current object. f must consume the value.
+    template <typename F> bool rest(F &&f)
+    {
+        while (true)
+        {
+            switch (reader.next())
+            {
+            case Token::EndObject:
+                return true;
+            case Token::Key:
+                if (!f(reader.text()))
+                {
+                    return false;
+                }
+                break;
+            default:
+                return fail("Expected key");
+            }
+        }
+    }
+
+    template <typename F> bool members(F &&f)
+    {
+        return expect(Token::BeginObject) && rest(std::forward<F>(f));
+    }
+
+    template <typename F> bool strings(F &&f)
+    {
+        if (!expect(Token::BeginArray))
+        {
+            return false;
+        }
+        while (true)
+        {
+            switch (reader.next())
+            {
+            case Token::EndArray:
+                return true;
+            case Token::String:
+                f(reader.text());
+                break;
+            default:
+                return fail("Expected string");
+            }
+        }
+    }
+
+    // Skips values of keys this version does not know about
+    bool ignore()
+    {
+        return reader.skip(reader.next()) || fail("Invalid value");
+    }
+
+    template <typename T> std::optional<T> number()
+    {
+        const Token token = reader.next();
+        if (token != Token::Number && token != Token::String)
+        {
+            fail("Expected number");
+            return std::nullopt;
+        }
+        auto t = reader.number<T>();
+        if (!t)
+        {
+            fail("Invalid number");
+        }
+        return t;
+    }
+
+    template <size_t I = 0> bool range(size_t type, Form &form)
+    {
+        if constexpr (I < std::variant_size_v<RangedValue>)
+        {
+            if (type != I)
+            {
+                return range<I + 1>(type, form);
+            }
+            using R = std::variant_alternative_t<I, RangedValue>;
+            using T = std::decay_t<decltype(*std::declval<R>())>;
+            const R defaults(T{});
+            auto [min, max] = defaults.getMinMax();
+            std::optional<T> value;
+            const bool read = rest([&](std::string_view key) {
+                std::optional<T> *target = nullptr;
+                std::optional<T> bound;
+                if (key == "value")
+                {
+                    target = &value;
+                }
+                else if (key == "min" || key == "max")
+                {
+                    target = &bound;
+                }
+                else
+                {
+                    return ignore();
+                }
+                const bool isMin = key == "min";
+                *target = number<T>();
+                if (!*target)
+                {
+                    return false;
+                }
+                if (target == &bound)
+                {
+                    (isMin ? min : max) = *bound;
+                }
+                return true;
+            });
+            if (!read)
+            {
+                return false;
+            }
+            if (!value)
+            {
+                return fail("Range without a value");
+            }
+            auto r = R::create(*value, min, max);
+            if (!r)
+            {
+                return fail("Value out of range");
+            }
+            form.emplace<RangedValue>(*r);
+            return true;
+        }
+        else
+        {
+            return fail("Unknown range type");
+        }
+    }
+
+    bool object(Form &form)
+    {
+        if (reader.next() != Token::Key)
+        {
+            return fail("Expected the type of the form as the first key");
+        }
+        const std::string_view kind = reader.text();
+        if (kind == "range")
+        {
+            if (!expect(Token::String))
+            {
+                return false;
+            }
+            const auto name = std::find(std::begin(RangeNames), std::end(RangeNames), reader.text());
+            return range(name - std::begin(RangeNames), form);
+        }
+        if (kind == "complex")
+        {
+            auto &c = form.emplace<ComplexString>();
+            if (!expect(Token::String))
+            {
+                return false;
+            }
+            c.string = reader.text();
+            return rest([&](std::string_view key) {
+                if (key != "map")
+                {
+                    return ignore();
+                }
+                return members([&](std::string_view k) {
+                    auto &set = c.map[String(k, c.map.get_allocator())];
+                    return strings([&](std::string_view s) { set.emplace(s); });
+                });
+            });
+        }
+        if (kind == "set")
+        {
+            auto &set = form.emplace<StringSet>();
+            return strings([&](std::string_view s) { set.emplace(s); }) && rest([this](std::string_view) {
+                       return ignore();
+                   });
+        }
+        if (kind == "selection")
+        {
+            auto &selection = form.emplace<StringSelection>();
+            auto index = number<int>();
+            if (!index)
+            {
+                return false;
+            }
+            selection.index = *index;
+            return rest([&](std::string_view key) {
+                // Kept so the selection can be given its provider again
+                if (key == "key")
+                {
+                    if (!expect(Token::String))
+                    {
+                        return false;
+                    }
+                    selection.key.assign(reader.text());
+                    return true;
+                }
+                if (key != "options")
+                {
+                    return ignore();
+                }
+                return strings([&](std::string_view s) { selection.set.emplace(s); });
+            });
+        }
+        if (kind == "flags")
+        {
+            auto &map = form.emplace<StringMap>();
+            return members([&](std::string_view key) {
+                       String name(key, map.get_allocator());
+                       const Token token = reader.next();
+                       if (token != Token::True && token != Token::False)
+                       {
+                           return fail("Expected boolean");
+                       }
+                       map[std::move(name)] = token == Token::True;
+                       return true;
+                   }) &&
+                   rest([this](std::string_view) { return ignore(); });
+        }
+        if (kind == "variant")
+        {
+            auto &variant = form.emplace<VariantForm>();
+            if (!expect(Token::String))
+            {
+                return false;
+            }
+            variant.selected = reader.text();
+            return rest([&](std::string_view key) {
+                if (key != "forms")
+                {
+                    return ignore();
+                }
+                return members([&](std::string_view k) { return value(variant[k]); });
+            });
+        }
+        if (kind == "struct")
+        {
+            auto &structForm = form.emplace<StructForm>();
+            auto columns = number<size_t>();
+            if (!columns)
+            {
+                return false;
+            }
+            structForm.columns = *columns;
+            return rest([&](std::string_view key) {
+                if (key != "fields")
+                {
+                    return ignore();
+                }
+                return members([&](std::string_view k) { return value(structForm[k]); });
+            });
+        }
+        if (kind == "enable")
+        {
+            auto &enableForm = form.emplace<EnableForm>();
+            return members([&](std::string_view key) {
+                       auto &pair = enableForm[key];
+                       if (!expect(Token::BeginArray))
+                       {
+                           return false;
+                       }
+                       const Token token = reader.next();
+                       if (token != Token::True && token != Token::False)
+                       {
+                           return fail("Expected boolean");
+                       }
+                       pair.first = token == Token::True;
+                       return value(pair.second) && expect(Token::EndArray);
+                   }) &&
+                   rest([this](std::string_view) { return ignore(); });
+        }
+        return fail("Unknown form type");
+    }
+
+  public:
+    JsonFormReader(JsonReader &r) noexcept : reader(r)
+    {
+    }
+
+    bool value(Form &form)
+    {
+        return value(reader.next(), form);
+    }
+
+    bool value(Token token, Form &form)
+    {
+        switch (token)
+        {
+        case Token::Null:
+            form.emplace<std::monostate>();
+            return true;
+        case Token::True:
+        case Token::False:
+            form.emplace<bool>(token == Token::True);
+            return true;
+        case Token::String:
+            form.emplace<String>(reader.text());
+            return true;
+        case Token::BeginObject:
+            return object(form);
+        default:
+            return fail("Unexpected token");
+        }
+    }
+};
+
+std::optional<Form> readJson(JsonReader &reader, const Allocator &allocator)
+{
+    Form form(allocator);
+    JsonFormReader formReader(reader);
+    if (!formReader.value(form) || reader.next() != JsonReader::Token::End)
+    {
+        return std::nullopt;
+    }
+    return form;
+}
+
+bool saveJson(const Form &form, const char *path)
+{
+    const int fd = openFile(path, true);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool ok;
+    {
+        auto writer = std::make_unique<JsonWriter>(fd);
+        writeJson(form, *writer);
+        ok = writer->flush();
+    }
+    return closeFile(fd) == 0 && ok;
+}
+
+std::optional<Form> loadJson(const char *path, const Allocator &allocator)
+{
+    const int fd = openFile(path, false);
+    if (fd < 0)
+    {
+        return std::nullopt;
+    }
+    auto reader = std::make_unique<JsonReader>(fd);
+    auto form = readJson(*reader, allocator);
+    closeFile(fd);
+    return form;
+}
+} // namespace CanForm
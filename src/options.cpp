@@ -0,0 +1,108 @@
+#include <options.hpp>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace CanForm
+{
+size_t OptionProvider::find(std::string_view prefix, size_t from) const
+{
+    for (size_t i = from; i < size(); ++i)
+    {
+        if (at(i).substr(0, prefix.size()) == prefix)
+        {
+            return i;
+        }
+    }
+    return npos;
+}
+
+void OptionProvider::fetch(size_t first, size_t count, std::pmr::vector<std::string_view> &options) const
+{
+    const size_t last = first >= size() ? first : first + std::min(count, size() - first);
+    for (size_t i = first; i < last; ++i)
+    {
+        options.push_back(at(i));
+    }
+}
+
+OptionList::OptionList(String &&lines, const allocator_type &a) : buffer(std::move(lines), a), entries(a)
+{
+    index();
+}
+
+// Splits the buffer into lines, then sorts them and drops duplicates
+void OptionList::index()
+{
+    entries.clear();
+    if (buffer.size() > UINT32_MAX)
+    {
+        return;
+    }
+    size_t start = 0;
+    while (start < buffer.size())
+    {
+        size_t end = buffer.find('\n', start);
+        if (end == String::npos)
+        {
+            end = buffer.size();
+        }
+        size_t last = end;
+        if (last > start && buffer[last - 1] == '\r')
+        {
+            --last;
+        }
+        if (last > start)
+        {
+            entries.push_back(Entry{static_cast<uint32_t>(start), static_cast<uint32_t>(last - start)});
+        }
+        start = end + 1;
+    }
+    std::sort(entries.begin(), entries.end(), [this](const Entry &a, const Entry &b) { return view(a) < view(b); });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [this](const Entry &a, const Entry &b) { return view(a) == view(b); }),
+                  entries.end());
+}
+
+std::optional<OptionList> OptionList::load(const char *path, const allocator_type &allocator)
+{
+    FILE *file = std::fopen(path, "rb");
+    if (file == nullptr)
+    {
+        return std::nullopt;
+    }
+    String lines(allocator);
+    char chunk[1 << 16];
+    size_t n = 0;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        lines.append(chunk, n);
+    }
+    const bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+    if (failed || lines.size() > UINT32_MAX)
+    {
+        return std::nullopt;
+    }
+    return OptionList(std::move(lines), allocator);
+}
+
+size_t OptionList::lowerBound(std::string_view s) const noexcept
+{
+    auto iter = std::lower_bound(entries.begin(), entries.end(), s,
+                                 [this](const Entry &e, std::string_view value) { return view(e) < value; });
+    return static_cast<size_t>(iter - entries.begin());
+}
+
+size_t OptionList::indexOf(std::string_view s) const
+{
+    const size_t i = lowerBound(s);
+    return i < entries.size() && view(entries[i]) == s ? i : npos;
+}
+
+size_t OptionList::find(std::string_view prefix, size_t from) const
+{
+    const size_t i = std::max(lowerBound(prefix), from);
+    return i < entries.size() && view(entries[i]).substr(0, prefix.size()) == prefix ? i : npos;
+}
+} // namespace CanForm
@@ -0,0 +1,617 @@
+#include <cstring>
+#include <patch.hpp>
+
+namespace CanForm
+{
+using Kind = PatchOperation::Kind;
+
+static bool sameRange(const RangedValue &a, const RangedValue &b) noexcept
+{
+    if (a.index() != b.index())
+    {
+        return false;
+    }
+    return std::visit(
+        [&b](const auto &x) {
+            const auto &y = std::get<std::decay_t<decltype(x)>>(b);
+            return *x == *y && x.getMinMax() == y.getMinMax();
+        },
+        a);
+}
+
+static bool sameStrings(const IndexedStringSet &a, const IndexedStringSet &b) noexcept
+{
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+class Differ
+{
+  private:
+    FormPatch &patch;
+    FormPath path;
+
+    PatchOperation &add(Kind kind)
+    {
+        return patch.operations.emplace_back(kind, path);
+    }
+
+    void replace(const Form &to)
+    {
+        add(Kind::Replace).value = to;
+    }
+
+    // Compares the entries of two maps of forms. get returns the form of an entry. Shared maps are equal.
+    template <typename Map, typename Get, typename OnInsert, typename OnCommon>
+    void entries(const Map &from, const Map &to, Get &&get, OnInsert &&onInsert, OnCommon &&onCommon)
+    {
+        if (&from == &to)
+        {
+            return;
+        }
+        for (const auto &[key, _] : from)
+        {
+            if (to.find(key) == to.end())
+            {
+                path.push_back(key);
+                add(Kind::Remove);
+                path.pop_back();
+            }
+        }
+        for (const auto &[key, value] : to)
+        {
+            path.push_back(key);
+            auto iter = from.find(key);
+            if (iter == from.end())
+            {
+                onInsert(add(Kind::Insert), value);
+            }
+            else
+            {
+                onCommon(iter->second, value);
+                operator()(get(iter->second), get(value));
+            }
+            path.pop_back();
+        }
+    }
+
+  public:
+    Differ(FormPatch &p) : patch(p), path(p.get_allocator())
+    {
+    }
+
+    void operator()(const Form &from, const Form &to)
+    {
+        if (from->index() != to->index())
+        {
+            replace(to);
+            return;
+        }
+        visit(
+            [this, &from, &to](const auto &a) {
+                using T = std::decay_t<decltype(a)>;
+                const T &b = to.get<T>();
+                if constexpr (std::is_same_v<T, std::monostate>)
+                {
+                }
+                else if constexpr (std::is_same_v<T, RangedValue>)
+                {
+                    if (!sameRange(a, b))
+                    {
+                        replace(to);
+                    }
+                }
+                else if constexpr (std::is_same_v<T, ComplexString>)
+                {
+                    if (a.string != b.string || a.map != b.map)
+                    {
+                        replace(to);
+                    }
+                }
+                else if constexpr (std::is_same_v<T, StringSelection>)
+                {
+                    if (!sameStrings(a.set, b.set) || a.provider != b.provider || a.key != b.key)
+                    {
+                        replace(to);
+                    }
+                    else if (a.index != b.index)
+                    {
+                        add(Kind::Select).number = b.index;
+                    }
+                }
+                else if constexpr (std::is_same_v<T, StringMap>)
+                {
+                    for (const auto &[key, _] : a)
+                    {
+                        if (b.find(key) == b.end())
+                        {
+                            add(Kind::Unflag).text = key;
+                        }
+                    }
+                    for (const auto &[key, flag] : b)
+                    {
+                        auto iter = a.find(key);
+                        if (iter == a.end() || iter->second != flag)
+                        {
+                            PatchOperation &op = add(Kind::Flag);
+                            op.text = key;
+                            op.flag = flag;
+                        }
+                    }
+                }
+                else if constexpr (std::is_same_v<T, VariantForm>)
+                {
+                    if (a.selected != b.selected)
+                    {
+                        add(Kind::Switch).text = b.selected;
+                    }
+                    entries(
+                        *a, *b, [](const Form &f) -> const Form & { return f; },
+                        [](PatchOperation &op, const Form &f) { op.value = f; }, [](const Form &, const Form &) {});
+                }
+                else if constexpr (std::is_same_v<T, StructForm>)
+                {
+                    if (a.columns != b.columns)
+                    {
+                        add(Kind::Columns).number = static_cast<int64_t>(b.columns);
+                    }
+                    entries(
+                        *a, *b, [](const Form &f) -> const Form & { return f; },
+                        [](PatchOperation &op, const Form &f) { op.value = f; }, [](const Form &, const Form &) {});
+                }
+                else if constexpr (std::is_same_v<T, EnableForm>)
+                {
+                    using Value = EnableForm::Value;
+                    entries(
+                        *a, *b, [](const Value &v) -> const Form & { return v.second; },
+                        [](PatchOperation &op, const Value &v) {
+                            op.flag = v.first;
+                            op.value = v.second;
+                        },
+                        [this](const Value &x, const Value &y) {
+                            if (x.first != y.first)
+                            {
+                                add(Kind::Enable).flag = y.first;
+                            }
+                        });
+                }
+                else
+                {
+                    if (!(a == b))
+                    {
+                        replace(to);
+                    }
+                }
+            },
+            from);
+    }
+};
+
+FormPatch diff(const Form &from, const Form &to, const Allocator &allocator)
+{
+    FormPatch patch(allocator);
+    Differ differ(patch);
+    differ(from, to);
+    return patch;
+}
+
+// Follows the first `count` keys of path. Lookups through a mutable form unshare the maps on the way.
+template <typename F> static F *resolve(F &root, const FormPath &path, size_t count)
+{
+    F *form = &root;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Atom &key = path[i];
+        form = visit(
+            [&key](auto &value) -> F * {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same_v<T, StructForm> || std::is_same_v<T, VariantForm>)
+                {
+                    auto iter = value->find(key);
+                    return iter == value->end() ? nullptr : &iter->second;
+                }
+                else if constexpr (std::is_same_v<T, EnableForm>)
+                {
+                    auto iter = value->find(key);
+                    return iter == value->end() ? nullptr : &iter->second.second;
+                }
+                else
+                {
+                    return nullptr;
+                }
+            },
+            *form);
+        if (form == nullptr)
+        {
+            return nullptr;
+        }
+    }
+    return form;
+}
+
+Form *resolve(Form &root, const FormPath &path)
+{
+    return resolve(root, path, path.size());
+}
+
+const Form *resolve(const Form &root, const FormPath &path)
+{
+    return resolve(root, path, path.size());
+}
+
+FormPath toPath(std::string_view s, const Allocator &allocator)
+{
+    FormPath path(allocator);
+    while (!s.empty())
+    {
+        const size_t slash = s.find('/');
+        path.emplace_back(s.substr(0, slash));
+        if (slash == std::string_view::npos)
+        {
+            break;
+        }
+        s.remove_prefix(slash + 1);
+    }
+    return path;
+}
+
+String toString(const FormPath &path)
+{
+    String s;
+    for (size_t i = 0; i < path.size(); ++i)
+    {
+        if (i != 0)
+        {
+            s.push_back('/');
+        }
+        s.append(path[i].view());
+    }
+    return s;
+}
+
+bool apply(Form &root, const PatchOperation &op)
+{
+    const size_t depth = op.path.size();
+    if (op.kind == Kind::Flag || op.kind == Kind::Unflag)
+    {
+        Form *form = resolve(root, op.path);
+        auto map = form == nullptr ? nullptr : form->getIf<StringMap>();
+        if (map == nullptr)
+        {
+            return false;
+        }
+        if (op.kind == Kind::Unflag)
+        {
+            auto iter = map->find(std::string_view(op.text));
+            if (iter == map->end())
+            {
+                return false;
+            }
+            map->erase(iter);
+            return true;
+        }
+        (*map)[op.text] = op.flag;
+        return true;
+    }
+    if (op.kind == Kind::Insert || op.kind == Kind::Remove || op.kind == Kind::Enable)
+    {
+        if (depth == 0)
+        {
+            return false;
+        }
+        Form *parent = resolve(root, op.path, depth - 1);
+        if (parent == nullptr)
+        {
+            return false;
+        }
+        const Atom &key = op.path.back();
+        return visit(
+            [&op, &key](auto &value) {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same_v<T, StructForm> || std::is_same_v<T, VariantForm>)
+                {
+                    switch (op.kind)
+                    {
+                    case Kind::Insert:
+                        value[key] = op.value;
+                        return true;
+                    case Kind::Remove:
+                        return value->erase(key) != 0;
+                    default:
+                        return false;
+                    }
+                }
+                else if constexpr (std::is_same_v<T, EnableForm>)
+                {
+                    switch (op.kind)
+                    {
+                    case Kind::Insert: {
+                        auto &pair = value[key];
+                        pair.first = op.flag;
+                        pair.second = op.value;
+                        return true;
+                    }
+                    case Kind::Remove:
+                        return value->erase(key) != 0;
+                    case Kind::Enable: {
+                        auto iter = value->find(key);
+                        if (iter == value->end())
+                        {
+                            return false;
+                        }
+                        iter->second.first = op.flag;
+                        return true;
+                    }
+                    default:
+                        return false;
+                    }
+                }
+                else
+                {
+                    return false;
+                }
+            },
+            *parent);
+    }
+
+    Form *form = resolve(root, op.path, depth);
+    if (form == nullptr)
+    {
+        return false;
+    }
+    switch (op.kind)
+    {
+    case Kind::Replace:
+        *form = op.value;
+        return true;
+    case Kind::Select:
+        if (auto selection = form->getIf<StringSelection>())
+        {
+            selection->index = static_cast<int>(op.number);
+            return true;
+        }
+        return false;
+    case Kind::Switch:
+        if (auto variant = form->getIf<VariantForm>())
+        {
+            variant->selected = op.text;
+            return true;
+        }
+        return false;
+    case Kind::Columns:
+        if (auto structForm = form->getIf<StructForm>())
+        {
+            structForm->columns = static_cast<size_t>(op.number);
+            return true;
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+bool apply(Form &form, const FormPatch &patch)
+{
+    for (const auto &op : patch)
+    {
+        if (!apply(form, op))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Patch encoding: "CFPT", version and operation count as uint32_t. Each operation is its kind as one byte, the path
+// as a count and length prefixed keys, then its payload. Form values are length prefixed snapshots padded so they
+// start on an 8 byte boundary.
+namespace
+{
+constexpr uint32_t PatchMagic = 0x54504643; // "CFPT"
+constexpr uint32_t PatchVersion = 2;
+
+struct PatchWriter
+{
+    Snapshot::Bytes &out;
+
+    template <typename T> void put(const T &t)
+    {
+        const size_t pos = out.size();
+        out.resize(pos + sizeof(T));
+        std::memcpy(out.data() + pos, &t, sizeof(T));
+    }
+
+    void put(std::string_view s)
+    {
+        put(static_cast<uint32_t>(s.size()));
+        out.insert(out.end(), s.begin(), s.end());
+    }
+
+    void put(const Form &form)
+    {
+        const Snapshot::Bytes bytes = encodeSnapshot(form, out.get_allocator());
+        put(static_cast<uint64_t>(bytes.size()));
+        out.resize((out.size() + 7) & ~size_t(7));
+        out.insert(out.end(), bytes.begin(), bytes.end());
+    }
+};
+
+struct PatchReader
+{
+    const char *data;
+    size_t size;
+    size_t position;
+
+    template <typename T> bool get(T &t) noexcept
+    {
+        if (size - position < sizeof(T))
+        {
+            return false;
+        }
+        std::memcpy(&t, data + position, sizeof(T));
+        position += sizeof(T);
+        return true;
+    }
+
+    bool get(std::string_view &s) noexcept
+    {
+        uint32_t n;
+        if (!get(n) || size - position < n)
+        {
+            return false;
+        }
+        s = std::string_view(data + position, n);
+        position += n;
+        return true;
+    }
+
+    bool get(Form &form)
+    {
+        uint64_t n;
+        if (!get(n))
+        {
+            return false;
+        }
+        position = (position + 7) & ~size_t(7);
+        if (position > size || size - position < n)
+        {
+            return false;
+        }
+        auto view = FormView::root(data + position, n);
+        if (!view)
+        {
+            return false;
+        }
+        form = view->materialize(form.get_allocator());
+        position += n;
+        return true;
+    }
+};
+} // namespace
+
+Snapshot::Bytes encodePatch(const FormPatch &patch, const Allocator &allocator)
+{
+    Snapshot::Bytes bytes(allocator);
+    PatchWriter writer{bytes};
+    writer.put(PatchMagic);
+    writer.put(PatchVersion);
+    writer.put(static_cast<uint32_t>(patch.size()));
+    for (const auto &op : patch)
+    {
+        writer.put(static_cast<uint8_t>(op.kind));
+        writer.put(static_cast<uint32_t>(op.path.size()));
+        for (const Atom &key : op.path)
+        {
+            writer.put(key.view());
+        }
+        switch (op.kind)
+        {
+        case Kind::Insert:
+            writer.put(static_cast<uint8_t>(op.flag));
+            [[fallthrough]];
+        case Kind::Replace:
+            writer.put(op.value);
+            break;
+        case Kind::Select:
+        case Kind::Columns:
+            writer.put(op.number);
+            break;
+        case Kind::Switch:
+        case Kind::Unflag:
+            writer.put(std::string_view(op.text));
+            break;
+        case Kind::Flag:
+            writer.put(std::string_view(op.text));
+            writer.put(static_cast<uint8_t>(op.flag));
+            break;
+        case Kind::Enable:
+            writer.put(static_cast<uint8_t>(op.flag));
+            break;
+        case Kind::Remove:
+            break;
+        }
+    }
+    return bytes;
+}
+
+static std::optional<FormPatch> decodeAligned(const char *data, size_t size, const Allocator &allocator)
+{
+    PatchReader reader{data, size, 0};
+    uint32_t magic, version, count;
+    if (!reader.get(magic) || !reader.get(version) || !reader.get(count) || magic != PatchMagic ||
+        version != PatchVersion)
+    {
+        return std::nullopt;
+    }
+    FormPatch patch(allocator);
+    FormPath path(allocator);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint8_t kind;
+        uint32_t depth;
+        if (!reader.get(kind) || kind > static_cast<uint8_t>(Kind::Unflag) || !reader.get(depth) ||
+            depth > size - reader.position)
+        {
+            return std::nullopt;
+        }
+        path.clear();
+        for (uint32_t j = 0; j < depth; ++j)
+        {
+            std::string_view key;
+            if (!reader.get(key))
+            {
+                return std::nullopt;
+            }
+            path.emplace_back(key);
+        }
+        auto &op = patch.operations.emplace_back(static_cast<Kind>(kind), path);
+        uint8_t flag = 0;
+        std::string_view text;
+        bool ok = true;
+        switch (op.kind)
+        {
+        case Kind::Insert:
+            ok = reader.get(flag) && reader.get(op.value);
+            break;
+        case Kind::Replace:
+            ok = reader.get(op.value);
+            break;
+        case Kind::Select:
+        case Kind::Columns:
+            ok = reader.get(op.number);
+            break;
+        case Kind::Switch:
+        case Kind::Unflag:
+            ok = reader.get(text);
+            op.text = text;
+            break;
+        case Kind::Flag:
+            ok = reader.get(text) && reader.get(flag);
+            op.text = text;
+            break;
+        case Kind::Enable:
+            ok = reader.get(flag);
+            break;
+        case Kind::Remove:
+            break;
+        }
+        if (!ok)
+        {
+            return std::nullopt;
+        }
+        op.flag = flag != 0;
+    }
+    return patch;
+}
+
+std::optional<FormPatch> decodePatch(const char *data, size_t size, const Allocator &allocator)
+{
+    // Snapshots inside the patch are read in place so they need the same alignment as when they were written
+    if (reinterpret_cast<uintptr_t>(data) % alignof(uint64_t) != 0)
+    {
+        std::pmr::vector<uint64_t> copy((size + 7) / 8, allocator);
+        std::memcpy(copy.data(), data, size);
+        return decodeAligned(reinterpret_cast<const char *>(copy.data()), size, allocator);
+    }
+    return decodeAligned(data, size, allocator);
+}
+} // namespace CanForm
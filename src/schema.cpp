@@ -0,0 +1,372 @@
+#include <schema.hpp>
+
+namespace CanForm
+{
+FormSchema::FormSchema(const Form &prototype, const allocator_type &allocator)
+    : nodes(allocator), children(allocator), keys(allocator), ranges(allocator), options(allocator),
+      complexOptions(allocator), bufferSize(0), stringCount(0), setCount(0)
+{
+    add(prototype, Atom());
+}
+
+uint32_t FormSchema::add(const Form &form, const Atom &key)
+{
+    const uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(Node{key, static_cast<uint32_t>(form->index()), bufferSize, 0, 0, 0, 0});
+
+    // Children are numbered depth first and listed together in the children table
+    auto addChildren = [this, index](const auto &map, auto &&get) {
+        std::pmr::vector<uint32_t> list(children.get_allocator());
+        list.reserve(map.size());
+        for (const auto &[k, value] : map)
+        {
+            list.push_back(add(get(value), k));
+        }
+        nodes[index].first = static_cast<uint32_t>(children.size());
+        nodes[index].count = static_cast<uint32_t>(list.size());
+        children.insert(children.end(), list.begin(), list.end());
+    };
+    auto self = [](const Form &f) -> const Form & { return f; };
+
+    visit(
+        [&](const auto &value) {
+            using T = std::decay_t<decltype(value)>;
+            Node &node = nodes[index];
+            if constexpr (std::is_same_v<T, bool>)
+            {
+                bufferSize += 1;
+            }
+            else if constexpr (std::is_same_v<T, RangedValue>)
+            {
+                node.value = static_cast<uint32_t>(ranges.size());
+                ranges.push_back(value);
+                bufferSize +=
+                    std::visit([](const auto &range) { return static_cast<uint32_t>(sizeof(*range)); }, value);
+            }
+            else if constexpr (std::is_same_v<T, String>)
+            {
+                node.value = stringCount++;
+            }
+            else if constexpr (std::is_same_v<T, ComplexString>)
+            {
+                node.value = stringCount++;
+                node.extra = static_cast<uint32_t>(complexOptions.size());
+                complexOptions.emplace_back(value.map);
+            }
+            else if constexpr (std::is_same_v<T, StringSet>)
+            {
+                node.value = setCount++;
+            }
+            else if constexpr (std::is_same_v<T, StringSelection>)
+            {
+                node.value = static_cast<uint32_t>(options.size());
+                options.emplace_back(value.set);
+                bufferSize += sizeof(int32_t);
+            }
+            else if constexpr (std::is_same_v<T, StringMap>)
+            {
+                node.first = static_cast<uint32_t>(keys.size());
+                node.count = static_cast<uint32_t>(value.size());
+                for (const auto &pair : value)
+                {
+                    keys.push_back(pair.first);
+                }
+                bufferSize += node.count;
+            }
+            else if constexpr (std::is_same_v<T, VariantForm>)
+            {
+                bufferSize += sizeof(uint32_t);
+                addChildren(*value, self);
+            }
+            else if constexpr (std::is_same_v<T, StructForm>)
+            {
+                node.value = static_cast<uint32_t>(value.columns);
+                addChildren(*value, self);
+            }
+            else if constexpr (std::is_same_v<T, EnableForm>)
+            {
+                bufferSize += static_cast<uint32_t>(value->size());
+                addChildren(*value, [](const EnableForm::Value &pair) -> const Form & { return pair.second; });
+            }
+        },
+        form);
+    return index;
+}
+
+std::optional<uint32_t> FormSchema::child(uint32_t node, const Atom &key) const noexcept
+{
+    const Node &n = nodes[node];
+    switch (n.alternative)
+    {
+    case Form::indexOf<VariantForm>():
+    case Form::indexOf<StructForm>():
+    case Form::indexOf<EnableForm>():
+        for (uint32_t i = n.first; i < n.first + n.count; ++i)
+        {
+            if (nodes[children[i]].key == key)
+            {
+                return children[i];
+            }
+        }
+        break;
+    default:
+        break;
+    }
+    return std::nullopt;
+}
+
+std::optional<uint32_t> FormSchema::find(std::string_view path) const
+{
+    uint32_t node = 0;
+    while (!path.empty())
+    {
+        const size_t slash = path.find('/');
+        auto next = child(node, Atom(path.substr(0, slash)));
+        if (!next)
+        {
+            return std::nullopt;
+        }
+        node = *next;
+        if (slash == std::string_view::npos)
+        {
+            break;
+        }
+        path.remove_prefix(slash + 1);
+    }
+    return node;
+}
+
+// Keys must match the schema in order
+template <typename Map, typename F>
+static bool storeEntries(const FormSchema &schema, const FormSchema::Node &node,
+                         const std::pmr::vector<uint32_t> &children, const Map &map, F &&f)
+{
+    if (map.size() != node.count)
+    {
+        return false;
+    }
+    uint32_t i = node.first;
+    for (const auto &[key, value] : map)
+    {
+        const uint32_t child = children[i++];
+        if (schema[child].key != key || !f(child, value))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FormSchema::store(uint32_t index, const Form &form, FormValues &values) const
+{
+    const Node &node = nodes[index];
+    if (form->index() != node.alternative)
+    {
+        return false;
+    }
+    return visit(
+        [&](const auto &value) {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, std::monostate>)
+            {
+                return true;
+            }
+            else if constexpr (std::is_same_v<T, bool>)
+            {
+                values.write<uint8_t>(node.offset, value ? 1 : 0);
+                return true;
+            }
+            else if constexpr (std::is_same_v<T, RangedValue>)
+            {
+                if (value.index() != ranges[node.value].index())
+                {
+                    return false;
+                }
+                std::visit([&](const auto &range) { values.write(node.offset, *range); }, value);
+                return true;
+            }
+            else if constexpr (std::is_same_v<T, String>)
+            {
+                values.strings[node.value] = value;
+                return true;
+            }
+            else if constexpr (std::is_same_v<T, ComplexString>)
+            {
+                values.strings[node.value] = value.string;
+                return true;
+            }
+            else if constexpr (std::is_same_v<T, StringSet>)
+            {
+                values.sets[node.value] = value;
+                return true;
+            }
+            else if constexpr (std::is_same_v<T, StringSelection>)
+            {
+                values.write<int32_t>(node.offset, value.index);
+                return true;
+            }
+            else if constexpr (std::is_same_v<T, StringMap>)
+            {
+                if (value.size() != node.count)
+                {
+                    return false;
+                }
+                uint32_t i = 0;
+                for (const auto &[key, flag] : value)
+                {
+                    if (keys[node.first + i] != key)
+                    {
+                        return false;
+                    }
+                    values.write<uint8_t>(node.offset + i, flag ? 1 : 0);
+                    ++i;
+                }
+                return true;
+            }
+            else if constexpr (std::is_same_v<T, VariantForm>)
+            {
+                uint32_t selected = npos;
+                const bool ok = storeEntries(*this, node, children, *value, [&](uint32_t child, const Form &f) {
+                    if (std::string_view(nodes[child].key) == value.selected)
+                    {
+                        selected = child;
+                    }
+                    return store(child, f, values);
+                });
+                values.write(node.offset, selected == npos ? npos : selected - children[node.first]);
+                return ok;
+            }
+            else if constexpr (std::is_same_v<T, StructForm>)
+            {
+                return storeEntries(*this, node, children, *value,
+                                    [&](uint32_t child, const Form &f) { return store(child, f, values); });
+            }
+            else if constexpr (std::is_same_v<T, EnableForm>)
+            {
+                uint32_t i = 0;
+                return storeEntries(*this, node, children, *value,
+                                    [&](uint32_t child, const EnableForm::Value &pair) {
+                                        values.write<uint8_t>(node.offset + i++, pair.first ? 1 : 0);
+                                        return store(child, pair.second, values);
+                                    });
+            }
+        },
+        form);
+}
+
+bool FormSchema::store(const Form &form, FormValues &values) const
+{
+    values.buffer.resize(bufferSize);
+    values.strings.resize(stringCount);
+    values.sets.resize(setCount);
+    return store(0, form, values);
+}
+
+std::optional<FormValues> FormSchema::values(const Form &form, const allocator_type &allocator) const
+{
+    FormValues values(allocator);
+    if (!store(form, values))
+    {
+        return std::nullopt;
+    }
+    return values;
+}
+
+void FormSchema::load(uint32_t index, const FormValues &values, Form &form) const
+{
+    const Node &node = nodes[index];
+    const Allocator allocator = form.get_allocator();
+    switch (node.alternative)
+    {
+    case Form::indexOf<std::monostate>():
+        form.emplace<std::monostate>();
+        break;
+    case Form::indexOf<bool>():
+        form.emplace<bool>(values.read<uint8_t>(node.offset) != 0);
+        break;
+    case Form::indexOf<RangedValue>(): {
+        RangedValue &value = form.emplace<RangedValue>(ranges[node.value]);
+        std::visit(
+            [&](auto &range) {
+                using T = std::decay_t<decltype(*range)>;
+                range = values.read<T>(node.offset);
+            },
+            value);
+        break;
+    }
+    case Form::indexOf<String>():
+        form.emplace<String>(values.strings[node.value]);
+        break;
+    case Form::indexOf<ComplexString>(): {
+        ComplexString &c = form.emplace<ComplexString>();
+        c.string = values.strings[node.value];
+        for (const auto &[key, set] : complexOptions[node.extra])
+        {
+            c.map.emplace(key, set);
+        }
+        break;
+    }
+    case Form::indexOf<StringSet>():
+        form.emplace<StringSet>(values.sets[node.value]);
+        break;
+    case Form::indexOf<StringSelection>(): {
+        StringSelection &selection = form.emplace<StringSelection>();
+        selection.set = IndexedStringSet(options[node.value], allocator);
+        selection.index = values.read<int32_t>(node.offset);
+        break;
+    }
+    case Form::indexOf<StringMap>(): {
+        StringMap &map = form.emplace<StringMap>();
+        for (uint32_t i = 0; i < node.count; ++i)
+        {
+            map.emplace(keys[node.first + i], values.read<uint8_t>(node.offset + i) != 0);
+        }
+        break;
+    }
+    case Form::indexOf<VariantForm>(): {
+        VariantForm &variant = form.emplace<VariantForm>();
+        auto &map = *variant;
+        for (uint32_t i = node.first; i < node.first + node.count; ++i)
+        {
+            load(children[i], values, map[nodes[children[i]].key]);
+        }
+        const uint32_t selected = values.read<uint32_t>(node.offset);
+        if (selected < node.count)
+        {
+            variant.selected = nodes[children[node.first + selected]].key;
+        }
+        break;
+    }
+    case Form::indexOf<StructForm>(): {
+        StructForm &structForm = form.emplace<StructForm>();
+        structForm.columns = node.value;
+        auto &map = *structForm;
+        for (uint32_t i = node.first; i < node.first + node.count; ++i)
+        {
+            load(children[i], values, map[nodes[children[i]].key]);
+        }
+        break;
+    }
+    case Form::indexOf<EnableForm>(): {
+        EnableForm &enableForm = form.emplace<EnableForm>();
+        for (uint32_t i = 0; i < node.count; ++i)
+        {
+            const uint32_t child = children[node.first + i];
+            auto &pair = enableForm[nodes[child].key];
+            pair.first = values.read<uint8_t>(node.offset + i) != 0;
+            load(child, values, pair.second);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+Form FormSchema::materialize(const FormValues &values, const allocator_type &allocator) const
+{
+    Form form(allocator);
+    load(0, values, form);
+    return form;
+}
+} // namespace CanForm
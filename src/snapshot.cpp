@@ -0,0 +1,594 @@
+#include <algorithm>
+#include <cstdio>
+#include <snapshot.hpp>
+
+#if _WIN32
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace CanForm
+{
+using namespace Snapshot;
+
+class SnapshotWriter
+{
+  private:
+    Bytes &out;
+
+    size_t reserve(size_t n)
+    {
+        const size_t pos = (out.size() + 7) & ~size_t(7);
+        out.resize(pos + n);
+        return pos;
+    }
+
+    template <typename T> void put(size_t pos, const T &t) noexcept
+    {
+        std::memcpy(out.data() + pos, &t, sizeof(T));
+    }
+
+    template <typename T> T get(size_t pos) const noexcept
+    {
+        T t;
+        std::memcpy(&t, out.data() + pos, sizeof(T));
+        return t;
+    }
+
+    uint64_t text(std::string_view s)
+    {
+        const size_t pos = out.size();
+        out.insert(out.end(), s.begin(), s.end());
+        return pos;
+    }
+
+    size_t header(size_t type, uint32_t value = 0, uint64_t count = 0)
+    {
+        const size_t pos = reserve(sizeof(Node) + count * sizeof(Entry) + ((count * sizeof(uint32_t) + 7) & ~7));
+        put(pos, Node{static_cast<uint32_t>(type), value, count, 0, 0});
+        return pos;
+    }
+
+    void setText(size_t node, std::string_view s)
+    {
+        const uint64_t o = text(s);
+        put(node + offsetof(Node, offset), o);
+        put(node + offsetof(Node, size), static_cast<uint64_t>(s.size()));
+    }
+
+    static size_t entryAt(size_t node, size_t i) noexcept
+    {
+        return node + sizeof(Node) + i * sizeof(Entry);
+    }
+
+    // Writes the key of every entry and the table of entry positions sorted by key
+    template <typename Iter> void keys(size_t node, Iter first, Iter last)
+    {
+        size_t count = 0;
+        for (auto iter = first; iter != last; ++iter, ++count)
+        {
+            const std::string_view key(iter->first);
+            Entry entry{text(key), static_cast<uint32_t>(key.size()), 0, 0};
+            put(entryAt(node, count), entry);
+        }
+        std::pmr::vector<uint32_t> order(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            order[i] = static_cast<uint32_t>(i);
+        }
+        std::sort(order.begin(), order.end(), [this, node](uint32_t a, uint32_t b) {
+            const auto x = get<Entry>(entryAt(node, a));
+            const auto y = get<Entry>(entryAt(node, b));
+            return std::string_view(out.data() + x.key, x.keySize) < std::string_view(out.data() + y.key, y.keySize);
+        });
+        if (count != 0)
+        {
+            std::memcpy(out.data() + entryAt(node, count), order.data(), count * sizeof(uint32_t));
+        }
+    }
+
+    void setEntry(size_t node, size_t i, uint32_t flag, uint64_t value)
+    {
+        const size_t pos = entryAt(node, i);
+        put(pos + offsetof(Entry, flag), flag);
+        put(pos + offsetof(Entry, value), value);
+    }
+
+    template <typename Set> uint64_t strings(size_t type, uint32_t value, const Set &set)
+    {
+        const size_t node = header(type, value, set.size());
+        struct Key
+        {
+            std::string_view first;
+        };
+        std::pmr::vector<Key> list;
+        list.reserve(set.size());
+        for (const auto &s : set)
+        {
+            list.push_back(Key{s});
+        }
+        keys(node, list.begin(), list.end());
+        return node;
+    }
+
+  public:
+    SnapshotWriter(Bytes &o) noexcept : out(o)
+    {
+    }
+
+    uint64_t operator()(const Form &form)
+    {
+        return visit(*this, form);
+    }
+
+    uint64_t operator()(std::monostate)
+    {
+        return header(Form::indexOf<std::monostate>());
+    }
+
+    uint64_t operator()(bool b)
+    {
+        return header(Form::indexOf<bool>(), b ? 1 : 0);
+    }
+
+    uint64_t operator()(const RangedValue &range)
+    {
+        const size_t node = header(Form::indexOf<RangedValue>(), static_cast<uint32_t>(range.index()));
+        const size_t values = reserve(sizeof(uint64_t) * 3);
+        std::visit(
+            [this, values](const auto &r) {
+                const auto [min, max] = r.getMinMax();
+                put(values, *r);
+                put(values + sizeof(uint64_t), min);
+                put(values + sizeof(uint64_t) * 2, max);
+            },
+            range);
+        return node;
+    }
+
+    uint64_t operator()(const String &s)
+    {
+        const size_t node = header(Form::indexOf<String>());
+        setText(node, s);
+        return node;
+    }
+
+    uint64_t operator()(const ComplexString &c)
+    {
+        const size_t node = header(Form::indexOf<ComplexString>(), 0, c.map.size());
+        setText(node, c.string);
+        keys(node, c.map.begin(), c.map.end());
+        size_t i = 0;
+        for (const auto &[_, set] : c.map)
+        {
+            const uint64_t child = strings(Form::indexOf<StringSet>(), 0, set);
+            setEntry(node, i++, 0, child);
+        }
+        return node;
+    }
+
+    uint64_t operator()(const StringSet &set)
+    {
+        return strings(Form::indexOf<StringSet>(), 0, set);
+    }
+
+    uint64_t operator()(const StringSelection &selection)
+    {
+        return strings(Form::indexOf<StringSelection>(), static_cast<uint32_t>(selection.index), selection.set);
+    }
+
+    uint64_t operator()(const StringMap &map)
+    {
+        const size_t node = header(Form::indexOf<StringMap>(), 0, map.size());
+        keys(node, map.begin(), map.end());
+        size_t i = 0;
+        for (const auto &[_, flag] : map)
+        {
+            setEntry(node, i++, flag ? 1 : 0, 0);
+        }
+        return node;
+    }
+
+    uint64_t operator()(const VariantForm &variant)
+    {
+        const size_t node = header(Form::indexOf<VariantForm>(), 0, variant->size());
+        setText(node, variant.selected);
+        keys(node, variant->begin(), variant->end());
+        size_t i = 0;
+        for (const auto &[_, form] : *variant)
+        {
+            const uint64_t child = operator()(form);
+            setEntry(node, i++, 0, child);
+        }
+        return node;
+    }
+
+    uint64_t operator()(const StructForm &structForm)
+    {
+        const size_t node = header(Form::indexOf<StructForm>(), 0, structForm->size());
+        put(node + offsetof(Node, offset), static_cast<uint64_t>(structForm.columns));
+        keys(node, structForm->begin(), structForm->end());
+        size_t i = 0;
+        for (const auto &[_, form] : *structForm)
+        {
+            const uint64_t child = operator()(form);
+            setEntry(node, i++, 0, child);
+        }
+        return node;
+    }
+
+    uint64_t operator()(const EnableForm &enableForm)
+    {
+        const size_t node = header(Form::indexOf<EnableForm>(), 0, enableForm->size());
+        keys(node, enableForm->begin(), enableForm->end());
+        size_t i = 0;
+        for (const auto &[_, pair] : *enableForm)
+        {
+            const uint64_t child = operator()(pair.second);
+            setEntry(node, i++, pair.first ? 1 : 0, child);
+        }
+        return node;
+    }
+
+    void write(const Form &form)
+    {
+        const size_t pos = reserve(sizeof(Header));
+        const uint64_t root = operator()(form);
+        out.resize((out.size() + 7) & ~size_t(7));
+        put(pos, Header{Magic, Version, ByteOrder, 0, root, out.size()});
+    }
+};
+
+Bytes encodeSnapshot(const Form &form, const Allocator &allocator)
+{
+    Bytes bytes(allocator);
+    SnapshotWriter writer(bytes);
+    writer.write(form);
+    return bytes;
+}
+
+bool saveSnapshot(const Form &form, const char *path)
+{
+    const Bytes bytes = encodeSnapshot(form);
+    FILE *file = std::fopen(path, "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    const bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return std::fclose(file) == 0 && written;
+}
+
+static bool isContainerType(size_t type) noexcept
+{
+    return type == Form::indexOf<ComplexString>() || type == Form::indexOf<StringSet>() ||
+           type == Form::indexOf<StringSelection>() || type == Form::indexOf<StringMap>() ||
+           type == Form::indexOf<VariantForm>() || type == Form::indexOf<StructForm>() ||
+           type == Form::indexOf<EnableForm>();
+}
+
+FormView::FormView(const char *b, size_t l, uint64_t o) noexcept : base(b), length(l), offset(o)
+{
+    if (base == nullptr || offset % 8 != 0 || offset + sizeof(Node) > length)
+    {
+        base = nullptr;
+        return;
+    }
+    const Node &n = node();
+    if (n.type >= std::variant_size_v<Form::Data>)
+    {
+        base = nullptr;
+        return;
+    }
+    if (isContainerType(n.type) && (n.count > length || offset + sizeof(Node) + n.count * (sizeof(Entry) + sizeof(uint32_t)) > length))
+    {
+        base = nullptr;
+    }
+    else if (n.type == Form::indexOf<RangedValue>() &&
+             (n.value >= std::variant_size_v<RangedValue> || offset + sizeof(Node) + sizeof(uint64_t) * 3 > length))
+    {
+        base = nullptr;
+    }
+}
+
+bool FormView::isContainer() const noexcept
+{
+    return valid() && isContainerType(node().type);
+}
+
+std::optional<FormView> FormView::root(const char *data, size_t size) noexcept
+{
+    if (data == nullptr || size < sizeof(Header))
+    {
+        return std::nullopt;
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    if (header.magic != Magic || header.version != Version || header.byteOrder != ByteOrder || header.size > size)
+    {
+        return std::nullopt;
+    }
+    FormView view(data, header.size, header.root);
+    if (!view.valid())
+    {
+        return std::nullopt;
+    }
+    return view;
+}
+
+template <size_t I = 0> static std::optional<RangedValue> readRange(size_t type, const char *values) noexcept
+{
+    if constexpr (I < std::variant_size_v<RangedValue>)
+    {
+        if (type != I)
+        {
+            return readRange<I + 1>(type, values);
+        }
+        using R = std::variant_alternative_t<I, RangedValue>;
+        using T = std::decay_t<decltype(*std::declval<R>())>;
+        T value, min, max;
+        std::memcpy(&value, values, sizeof(T));
+        std::memcpy(&min, values + sizeof(uint64_t), sizeof(T));
+        std::memcpy(&max, values + sizeof(uint64_t) * 2, sizeof(T));
+        auto range = R::create(value, min, max);
+        if (range)
+        {
+            return RangedValue(*range);
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<RangedValue> FormView::getRange() const noexcept
+{
+    if (!holds<RangedValue>())
+    {
+        return std::nullopt;
+    }
+    return readRange(node().value, base + offset + sizeof(Node));
+}
+
+size_t FormView::position(std::string_view k) const noexcept
+{
+    const size_t count = size();
+    const uint32_t *table = order();
+    size_t low = 0;
+    size_t high = count;
+    while (low < high)
+    {
+        const size_t mid = low + (high - low) / 2;
+        const uint32_t i = table[mid];
+        if (i >= count)
+        {
+            return count;
+        }
+        const int c = key(i).compare(k);
+        if (c == 0)
+        {
+            return i;
+        }
+        if (c < 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return count;
+}
+
+std::optional<FormView> FormView::find(std::string_view k) const noexcept
+{
+    const size_t i = position(k);
+    if (i == size())
+    {
+        return std::nullopt;
+    }
+    FormView view = child(i);
+    if (!view.valid())
+    {
+        return std::nullopt;
+    }
+    return view;
+}
+
+template <typename Set> static void readStrings(const FormView &view, Set &set)
+{
+    if constexpr (std::is_same_v<Set, IndexedStringSet>)
+    {
+        set.reserve(view.size());
+    }
+    for (size_t i = 0; i < view.size(); ++i)
+    {
+        set.emplace(view.key(i));
+    }
+}
+
+Form FormView::materialize(const Allocator &allocator) const
+{
+    Form form(allocator);
+    if (!valid())
+    {
+        form.emplace<std::monostate>();
+        return form;
+    }
+    switch (index())
+    {
+    case Form::indexOf<std::monostate>():
+        form.emplace<std::monostate>();
+        break;
+    case Form::indexOf<bool>():
+        form.emplace<bool>(getBool());
+        break;
+    case Form::indexOf<RangedValue>(): {
+        auto range = getRange();
+        if (range)
+        {
+            form.emplace<RangedValue>(*range);
+        }
+        else
+        {
+            form.emplace<std::monostate>();
+        }
+        break;
+    }
+    case Form::indexOf<String>():
+        form.emplace<String>(getString());
+        break;
+    case Form::indexOf<ComplexString>(): {
+        auto &c = form.emplace<ComplexString>();
+        c.string = getString();
+        for (size_t i = 0; i < size(); ++i)
+        {
+            const FormView set = child(i);
+            if (set.holds<StringSet>())
+            {
+                readStrings(set, c.map[String(key(i), allocator)]);
+            }
+        }
+        break;
+    }
+    case Form::indexOf<StringSet>():
+        readStrings(*this, form.emplace<StringSet>());
+        break;
+    case Form::indexOf<StringSelection>(): {
+        auto &selection = form.emplace<StringSelection>();
+        readStrings(*this, selection.set);
+        selection.index = getSelectionIndex();
+        break;
+    }
+    case Form::indexOf<StringMap>(): {
+        auto &map = form.emplace<StringMap>();
+        for (size_t i = 0; i < size(); ++i)
+        {
+            map.emplace(key(i), flag(i));
+        }
+        break;
+    }
+    case Form::indexOf<VariantForm>(): {
+        auto &variant = form.emplace<VariantForm>();
+        variant.selected = getString();
+        for (size_t i = 0; i < size(); ++i)
+        {
+            variant[key(i)] = child(i).materialize(allocator);
+        }
+        break;
+    }
+    case Form::indexOf<StructForm>(): {
+        auto &structForm = form.emplace<StructForm>();
+        structForm.columns = getColumns();
+        for (size_t i = 0; i < size(); ++i)
+        {
+            structForm[key(i)] = child(i).materialize(allocator);
+        }
+        break;
+    }
+    case Form::indexOf<EnableForm>(): {
+        auto &enableForm = form.emplace<EnableForm>();
+        for (size_t i = 0; i < size(); ++i)
+        {
+            enableForm[key(i)] = std::make_pair(flag(i), child(i).materialize(allocator));
+        }
+        break;
+    }
+    default:
+        form.emplace<std::monostate>();
+        break;
+    }
+    return form;
+}
+
+SnapshotFile::SnapshotFile(SnapshotFile &&f) noexcept : data(f.data), size(f.size), mapped(f.mapped)
+{
+    f.data = nullptr;
+    f.size = 0;
+    f.mapped = false;
+}
+
+SnapshotFile &SnapshotFile::operator=(SnapshotFile &&f) noexcept
+{
+    std::swap(data, f.data);
+    std::swap(size, f.size);
+    std::swap(mapped, f.mapped);
+    return *this;
+}
+
+SnapshotFile::~SnapshotFile()
+{
+    if (data == nullptr)
+    {
+        return;
+    }
+#if _WIN32
+    delete[] data;
+#else
+    if (mapped)
+    {
+        munmap(data, size);
+    }
+    else
+    {
+        delete[] data;
+    }
+#endif
+}
+
+std::optional<SnapshotFile> SnapshotFile::open(const char *path)
+{
+    SnapshotFile file;
+#if _WIN32
+    FILE *f = std::fopen(path, "rb");
+    if (f == nullptr)
+    {
+        return std::nullopt;
+    }
+    std::fseek(f, 0, SEEK_END);
+    const long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    if (size <= 0)
+    {
+        std::fclose(f);
+        return std::nullopt;
+    }
+    file.data = new char[size];
+    file.size = size;
+    const bool read = std::fread(file.data, 1, size, f) == static_cast<size_t>(size);
+    std::fclose(f);
+    if (!read)
+    {
+        return std::nullopt;
+    }
+#else
+    const int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return std::nullopt;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        ::close(fd);
+        return std::nullopt;
+    }
+    void *ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (ptr == MAP_FAILED)
+    {
+        return std::nullopt;
+    }
+    file.data = static_cast<char *>(ptr);
+    file.size = st.st_size;
+    file.mapped = true;
+#endif
+    if (!file.root())
+    {
+        return std::nullopt;
+    }
+    return file;
+}
+} // namespace CanForm
@@ -89,6 +89,130 @@ bool OnMenuButton(int, const EmscriptenMouseEvent *, void *)
             FormExecute::execute("Modal Form", std::move(formExecute));
             return MenuState::KeepOpen;
         });
+        menu.add("Show Changed Fields", []() {
+            FormExecute::execute("Changed Fields", executeChangeReport());
+            return MenuState::KeepOpen;
+        });
+        menu.add("Show Form Values", []() {
+            FormExecute::execute("Form Values", executeSchemaForm());
+            return MenuState::KeepOpen;
+        });
+        menu.add("Edit Bound Struct", []() {
+            FormExecute::execute("Bound Struct", executeBoundStruct());
+            return MenuState::KeepOpen;
+        });
+        menu.add("Edit Batch", []() {
+            FormExecute::execute("Batch", executeBatchForm());
+            return MenuState::KeepOpen;
+        });
+        menu.add("Edit Validated Form", []() {
+            FormExecute::execute("Validated Form", executeValidatedForm());
+            return MenuState::KeepOpen;
+        });
+        menu.add("Edit Computed Form", []() {
+            FormExecute::execute("Computed Form", executeComputedForm());
+            return MenuState::KeepOpen;
+        });
+        menu.add("Edit Lazy Variant Form", []() {
+            FormExecute::execute("Lazy Variant Form", executeLazyVariantForm());
+            return MenuState::KeepOpen;
+        });
+        menu.add("Edit Option Picker", []() {
+            FormExecute::execute("Option Picker", executeOptionPicker());
+            return MenuState::KeepOpen;
+        });
+        menu.add("Edit Journal Form", []() {
+            FormExecute::execute("Journal Form", executeJournalForm());
+            return MenuState::KeepOpen;
+        });
+        menu.add("Edit Transaction Form", []() {
+            FormExecute::execute("Transaction Form", executeTransactionForm());
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Form Arena", []() {
+            showMessageBox(MessageBoxType::Information, "Form Arena", benchmarkArena(3000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Form Maps", []() {
+            showMessageBox(MessageBoxType::Information, "Form Maps", benchmarkMaps());
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Atoms", []() {
+            showMessageBox(MessageBoxType::Information, "Atoms", benchmarkAtoms(1000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Snapshot", []() {
+            showMessageBox(MessageBoxType::Information, "Snapshot", benchmarkSnapshot(1000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark JSON", []() {
+            showMessageBox(MessageBoxType::Information, "JSON", benchmarkJson(1000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Patch", []() {
+            showMessageBox(MessageBoxType::Information, "Patch", benchmarkPatch(2000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Hash", []() {
+            showMessageBox(MessageBoxType::Information, "Hash", benchmarkHash(2000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Sharing", []() {
+            showMessageBox(MessageBoxType::Information, "Sharing", benchmarkSharing(4000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Fields", []() {
+            showMessageBox(MessageBoxType::Information, "Fields", benchmarkFields(10000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Schema", []() {
+            showMessageBox(MessageBoxType::Information, "Schema", benchmarkSchema(10000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Ranges", []() {
+            showMessageBox(MessageBoxType::Information, "Ranges", benchmarkRanges(100000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Layout", []() {
+            showMessageBox(MessageBoxType::Information, "Layout", benchmarkLayout(1000000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Validation", []() {
+            showMessageBox(MessageBoxType::Information, "Validation", benchmarkValidation(1000000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Computed Fields", []() {
+            showMessageBox(MessageBoxType::Information, "Computed Fields", benchmarkComputed(10000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Form Walker", []() {
+            showMessageBox(MessageBoxType::Information, "Form Walker", benchmarkWalker(1000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Lazy Variant", []() {
+            showMessageBox(MessageBoxType::Information, "Lazy Variant", benchmarkLazyVariant(50));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Option Provider", []() {
+            showMessageBox(MessageBoxType::Information, "Option Provider", benchmarkOptions(1000000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Numeric Entry", []() {
+            showMessageBox(MessageBoxType::Information, "Numeric Entry", benchmarkNumericEntry(1000000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Edit Journal", []() {
+            showMessageBox(MessageBoxType::Information, "Edit Journal", benchmarkJournal(10000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Transaction", []() {
+            showMessageBox(MessageBoxType::Information, "Transaction", benchmarkTransaction(10000));
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Form Memory", []() {
+            showMessageBox(MessageBoxType::Information, "Form Memory", benchmarkMemory(100000));
+            return MenuState::KeepOpen;
+        });
         menu.add("Wait for 3 seconds", []() {
             showPopupUntil("Waiting...", std::chrono::seconds(3), 500);
             return MenuState::KeepOpen;
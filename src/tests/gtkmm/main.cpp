@@ -183,6 +183,130 @@ void MainWindow::OnTool()
             FormExecute::execute("Modal Form", std::move(formExecute), this);
             return MenuState::KeepOpen;
         });
+        menu.add("Show Changed Fields", [this]() {
+            FormExecute::execute("Changed Fields", executeChangeReport(this), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Show Form Values", [this]() {
+            FormExecute::execute("Form Values", executeSchemaForm(this), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Edit Bound Struct", [this]() {
+            FormExecute::execute("Bound Struct", executeBoundStruct(this), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Edit Batch", [this]() {
+            FormExecute::execute("Batch", executeBatchForm(this), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Edit Validated Form", [this]() {
+            FormExecute::execute("Validated Form", executeValidatedForm(this), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Edit Computed Form", [this]() {
+            FormExecute::execute("Computed Form", executeComputedForm(this), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Edit Lazy Variant Form", [this]() {
+            FormExecute::execute("Lazy Variant Form", executeLazyVariantForm(this), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Edit Option Picker", [this]() {
+            FormExecute::execute("Option Picker", executeOptionPicker(this), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Edit Journal Form", [this]() {
+            FormExecute::execute("Journal Form", executeJournalForm(this), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Edit Transaction Form", [this]() {
+            FormExecute::execute("Transaction Form", executeTransactionForm(this), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Form Arena", [this]() {
+            showMessageBox(MessageBoxType::Information, "Form Arena", benchmarkArena(3000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Form Maps", [this]() {
+            showMessageBox(MessageBoxType::Information, "Form Maps", benchmarkMaps(), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Atoms", [this]() {
+            showMessageBox(MessageBoxType::Information, "Atoms", benchmarkAtoms(1000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Snapshot", [this]() {
+            showMessageBox(MessageBoxType::Information, "Snapshot", benchmarkSnapshot(1000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark JSON", [this]() {
+            showMessageBox(MessageBoxType::Information, "JSON", benchmarkJson(1000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Patch", [this]() {
+            showMessageBox(MessageBoxType::Information, "Patch", benchmarkPatch(2000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Hash", [this]() {
+            showMessageBox(MessageBoxType::Information, "Hash", benchmarkHash(2000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Sharing", [this]() {
+            showMessageBox(MessageBoxType::Information, "Sharing", benchmarkSharing(4000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Fields", [this]() {
+            showMessageBox(MessageBoxType::Information, "Fields", benchmarkFields(10000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Schema", [this]() {
+            showMessageBox(MessageBoxType::Information, "Schema", benchmarkSchema(10000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Ranges", [this]() {
+            showMessageBox(MessageBoxType::Information, "Ranges", benchmarkRanges(100000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Layout", [this]() {
+            showMessageBox(MessageBoxType::Information, "Layout", benchmarkLayout(1000000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Validation", [this]() {
+            showMessageBox(MessageBoxType::Information, "Validation", benchmarkValidation(1000000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Computed Fields", [this]() {
+            showMessageBox(MessageBoxType::Information, "Computed Fields", benchmarkComputed(10000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Form Walker", [this]() {
+            showMessageBox(MessageBoxType::Information, "Form Walker", benchmarkWalker(1000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Lazy Variant", [this]() {
+            showMessageBox(MessageBoxType::Information, "Lazy Variant", benchmarkLazyVariant(50), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Option Provider", [this]() {
+            showMessageBox(MessageBoxType::Information, "Option Provider", benchmarkOptions(1000000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Numeric Entry", [this]() {
+            showMessageBox(MessageBoxType::Information, "Numeric Entry", benchmarkNumericEntry(1000000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Edit Journal", [this]() {
+            showMessageBox(MessageBoxType::Information, "Edit Journal", benchmarkJournal(10000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Transaction", [this]() {
+            showMessageBox(MessageBoxType::Information, "Transaction", benchmarkTransaction(10000), this);
+            return MenuState::KeepOpen;
+        });
+        menu.add("Benchmark Form Memory", [this]() {
+            showMessageBox(MessageBoxType::Information, "Form Memory", benchmarkMemory(100000), this);
+            return MenuState::KeepOpen;
+        });
         menu.add("Wait for 3 seconds", [this]() {
             showPopupUntil("Waiting...", std::chrono::seconds(3), 500, this);
             return MenuState::KeepOpen;
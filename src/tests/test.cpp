@@ -1,9 +1,25 @@
+#include <accounting.hpp>
+#include <arena.hpp>
 #include <array>
+#include <batch.hpp>
+#include <binding.hpp>
+#include <computed.hpp>
+#include <field.hpp>
 #include <filesystem>
+#include <hash.hpp>
 #include <iostream>
+#include <journal.hpp>
+#include <json.hpp>
+#include <optional>
+#include <patch.hpp>
 #include <range.hpp>
+#include <schema.hpp>
+#include <snapshot.hpp>
 #include <sstream>
 #include <tests/test.hpp>
+#include <tracker.hpp>
+#include <validation.hpp>
+#include <walker.hpp>
 
 using namespace std::string_view_literals;
 
@@ -15,9 +31,10 @@ template <typename T> constexpr RangedValue makeNumber(T t) noexcept
     return RangedValue(std::move(r));
 }
 
-Form makeForm(bool makeInner)
+Form makeForm(bool makeInner, const Allocator &allocator)
 {
-    StructForm forms(3);
+    StructForm forms(allocator);
+    forms.columns = 3;
     forms["Nothing"] = std::monostate{};
     forms["Boolean"] = rand() % 2 == 0;
     forms["Signed Integer"] = makeNumber(0);
@@ -27,7 +44,7 @@ Form makeForm(bool makeInner)
     forms["String"] = "Hello";
 
     constexpr std::array<std::string_view, 5> Classes = {"Mammal", "Bird", "Reptile", "Amphibian", "Fish"};
-    StringSelection selection;
+    StringSelection selection(allocator);
     selection.index = rand() % Classes.size();
     for (auto cls : Classes)
     {
@@ -36,7 +53,7 @@ Form makeForm(bool makeInner)
     forms["Set of Strings"] = std::move(selection);
 
     constexpr std::array<std::string_view, 4> Actions = {"Climb", "Swim", "Fly", "Dig"};
-    StringMap map;
+    StringMap map(allocator);
     for (auto a : Actions)
     {
         map.emplace(a, rand() % 2 == 0);
@@ -44,13 +61,13 @@ Form makeForm(bool makeInner)
     forms["Map of String to Boolean"] = std::move(map);
 
     {
-        StringSet set({"A", "B", "C"});
+        StringSet set({"A", "B", "C"}, allocator);
         forms["Editable Set"] = std::move(set);
     }
 
-    ComplexString c;
+    ComplexString c(allocator);
     c.string = "2 + 2";
-    StringSet u;
+    StringSet u(allocator);
     u.emplace("+");
     u.emplace("-");
     u.emplace("×");
@@ -61,22 +78,25 @@ Form makeForm(bool makeInner)
     c.map.emplace("Unary Operator", std::move(u));
     forms["Expression"] = std::move(c);
 
-    VariantForm variant;
-    StringSet set({"Red", "Green", "Blue"});
-    variant.map["1st Variant"] = StructForm::create("Age", makeNumber(static_cast<uint8_t>(42)), "Favorite Color",
-                                                    StringSelection(0, std::move(set)));
-    variant.map["2nd Variant"] = StructForm::create("Active", true, "Weight", makeNumber(0.0), "Sports",
-                                                    createStringMap("Basketball", "Football", "Golf", "Polo"));
-    variant.map["3rd Variant"] = true;
+    VariantForm variant(allocator);
+    StringSet set({"Red", "Green", "Blue"}, allocator);
+    variant["1st Variant"] =
+        StructForm::create(std::allocator_arg, allocator, "Age", makeNumber(static_cast<uint8_t>(42)),
+                           "Favorite Color", StringSelection(0, std::move(set)));
+    StringMap sports(allocator);
+    variant["2nd Variant"] = StructForm::create(std::allocator_arg, allocator, "Active", true, "Weight",
+                                                makeNumber(0.0), "Sports",
+                                                createStringMap(sports, "Basketball", "Football", "Golf", "Polo"));
+    variant["3rd Variant"] = true;
     variant.selected = "1st Variant";
     forms["Variant Form"] = std::move(variant);
 
-    EnableForm enableForm;
+    EnableForm enableForm(allocator);
     auto list = {"Bob"sv, "Alice"sv, "Greg"sv};
     for (auto item : list)
     {
-        Form form;
-        auto &s = form->emplace<String>();
+        Form form(allocator);
+        auto &s = form.emplace<String>();
         randomString(s, 5, 10);
         enableForm[item] = std::make_pair(rand() % 2 == 0, std::move(form));
     }
@@ -84,11 +104,928 @@ Form makeForm(bool makeInner)
 
     if (makeInner)
     {
-        forms["Struct Form"] = makeForm(false);
+        forms["Struct Form"] = makeForm(false, allocator);
+    }
+    Form form(allocator);
+    form = std::move(forms);
+    return form;
+}
+
+template <typename F> static double measure(F &&f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// Forms reached through StructForms
+static size_t countFields(const Form &form)
+{
+    size_t count = 0;
+    FormWalker().walk(form, [&count](const FormWalker::Step &step) {
+        ++count;
+        return step.form->holds<StructForm>() ? WalkAction::Continue : WalkAction::Skip;
+    });
+    return count;
+}
+
+String benchmarkArena(size_t forms)
+{
+    const auto build = [forms](const Allocator &allocator) {
+        StructForm structForm(allocator);
+        for (size_t i = 0; i < forms; ++i)
+        {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "Form %zu", i);
+            structForm[buffer] = makeForm(true, allocator);
+        }
+        Form form(allocator);
+        form = std::move(structForm);
+        return form;
+    };
+
+    std::ostringstream os;
+    os << "Forms: " << forms << '\n';
+    {
+        std::optional<Form> form;
+        const double b = measure([&]() { form.emplace(build(Allocator())); });
+        os << "Fields: " << countFields(*form) << '\n';
+        const double d = measure([&]() { form.reset(); });
+        os << "Default resource: build " << b << " ms, destroy " << d << " ms\n";
+    }
+    {
+        FormArena arena;
+        Form *form = nullptr;
+        const double b = measure([&]() { form = &arena.create<Form>(build(arena)); });
+        const double d = measure([&]() { arena.release(); });
+        os << "Arena: build " << b << " ms, release " << d << " ms\n";
+    }
+    {
+        FormArena arena(0, true);
+        Form *form = nullptr;
+        const double b = measure([&]() { form = &arena.create<Form>(build(arena)); });
+        const double d = measure([&]() { arena.release(); });
+        os << "Arena with pool: build " << b << " ms, release " << d << " ms\n";
+    }
+    return String(os.str());
+}
+
+template <typename Map> static void benchmarkMap(std::ostream &os, const char *name, size_t fields)
+{
+    std::pmr::vector<String> keys;
+    keys.reserve(fields);
+    for (size_t i = 0; i < fields; ++i)
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "Field %zu", i);
+        keys.emplace_back(buffer);
+    }
+
+    Map map;
+    const double build = measure([&]() {
+        for (const auto &key : keys)
+        {
+            map[key] = rand() % 2 == 0;
+        }
+    });
+
+    size_t enabled = 0;
+    const double visit = measure([&]() {
+        for (const auto &[_, form] : map)
+        {
+            if (auto b = form.template getIf<bool>())
+            {
+                enabled += *b;
+            }
+        }
+    });
+
+    std::optional<Map> copy;
+    const double copied = measure([&]() { copy.emplace(map); });
+
+    size_t found = 0;
+    const double lookup = measure([&]() {
+        for (const auto &key : keys)
+        {
+            found += map.find(std::string_view(key)) != map.end();
+        }
+    });
+
+    os << name << ' ' << fields << ": build " << build << " ms, visit " << visit << " ms, copy " << copied
+       << " ms, lookup " << lookup << " ms (" << enabled << '/' << found << ")\n";
+}
+
+String benchmarkMaps()
+{
+    std::ostringstream os;
+    for (size_t fields : {1000, 10000, 100000})
+    {
+        benchmarkMap<std::pmr::map<String, Form, std::less<>>>(os, "std::map", fields);
+        benchmarkMap<OrderedMap<String, Form>>(os, "OrderedMap", fields);
+    }
+    return String(os.str());
+}
+
+String benchmarkAtoms(size_t forms)
+{
+    const AtomStats before = Atom::getStats();
+    std::pmr::vector<Form> corpus;
+    corpus.reserve(forms);
+    const double build = measure([&]() {
+        for (size_t i = 0; i < forms; ++i)
+        {
+            corpus.emplace_back(makeForm());
+        }
+    });
+    const AtomStats after = Atom::getStats();
+
+    AtomStats stats;
+    stats.atoms = after.atoms - before.atoms;
+    stats.bytes = after.bytes - before.bytes;
+    stats.requests = after.requests - before.requests;
+    stats.requestedBytes = after.requestedBytes - before.requestedBytes;
+
+    std::ostringstream os;
+    os << "Forms: " << forms << " built in " << build << " ms\n";
+    os << "Keys interned: " << stats.requests << ", new atoms: " << stats.atoms << '\n';
+    os << "Key bytes as strings: " << stats.requestedBytes << ", as atoms: " << stats.bytes << '\n';
+    os << "Saved: " << stats.saved() << " bytes\n";
+    os << "Total atoms: " << after.atoms << " using " << after.bytes << " bytes\n";
+    return String(os.str());
+}
+
+String benchmarkSnapshot(size_t forms)
+{
+    StructForm corpus;
+    for (size_t i = 0; i < forms; ++i)
+    {
+        corpus[String("Form ") + String(std::to_string(i))] = makeForm();
+    }
+    const Form form(std::in_place, std::move(corpus));
+    const auto path = (std::filesystem::temp_directory_path() / "canform.snapshot").string();
+
+    std::ostringstream os;
+    Snapshot::Bytes bytes;
+    const double encode = measure([&]() { bytes = encodeSnapshot(form); });
+    if (!saveSnapshot(form, path.c_str()))
+    {
+        os << "Failed to write " << path << '\n';
+        return String(os.str());
+    }
+
+    size_t fields = 0;
+    const double copy = measure([&]() {
+        Form copy(form);
+        fields = countFields(copy);
+    });
+
+    std::optional<SnapshotFile> file;
+    bool found = false;
+    const double open = measure([&]() {
+        file = SnapshotFile::open(path.c_str());
+        if (file)
+        {
+            auto root = file->root();
+            const auto key = String("Form ") + String(std::to_string(forms / 2));
+            found = root && root->find(key).has_value();
+        }
+    });
+
+    size_t materialized = 0;
+    const double materialize = measure([&]() {
+        if (file)
+        {
+            materialized = countFields(file->root()->materialize());
+        }
+    });
+    std::filesystem::remove(path);
+
+    os << "Forms: " << forms << " (" << fields << " fields)\n";
+    os << "Snapshot: " << bytes.size() << " bytes encoded in " << encode << " ms\n";
+    os << "Copy: " << copy << " ms\n";
+    os << "Map and look up one form: " << open << " ms" << (found ? "" : " (not found)") << '\n';
+    os << "Materialize: " << materialize << " ms (" << materialized << " fields)\n";
+    return String(os.str());
+}
+
+String benchmarkPatch(size_t forms)
+{
+    StructForm corpus;
+    for (size_t i = 0; i < forms; ++i)
+    {
+        corpus[String("Form ") + String(std::to_string(i))] = makeForm();
+    }
+    // Building pinned the maps of the corpus; a copy of it shares them with the copies below
+    const Form built(std::in_place, std::move(corpus));
+    const Form from(built);
+
+    // Change three fields
+    Form to(from);
+    auto &fields = to.get<StructForm>();
+    fields["Form 0"] = "Changed";
+    fields->erase(Atom("Form 1"));
+    fields["Added"] = true;
+    // StringMap keys travel as text and are not interned
+    auto &flags = fields["Form 2"].get<StructForm>()["Map of String to Boolean"].get<StringMap>();
+    flags.begin()->second = !flags.begin()->second;
+    flags.erase(std::prev(flags.end()));
+    flags.emplace(std::string_view("Glide"), true);
+
+    std::ostringstream os;
+    Form copy(from);
+    const double copied = measure([&]() { copy = to; });
+
+    FormPatch patch;
+    const double difference = measure([&]() { patch = diff(from, to); });
+    Snapshot::Bytes bytes;
+    const double encode = measure([&]() { bytes = encodePatch(patch); });
+
+    Form target(from);
+    bool applied = false;
+    const double decodeAndApply = measure([&]() {
+        auto decoded = decodePatch(bytes.data(), bytes.size());
+        applied = decoded && apply(target, *decoded);
+    });
+
+    String expected;
+    String actual;
+    {
+        JsonWriter writer(expected);
+        writeJson(to, writer);
+    }
+    {
+        JsonWriter writer(actual);
+        writeJson(target, writer);
+    }
+
+    os << "Forms: " << forms << " (" << countFields(from) << " fields)\n";
+    os << "Copy: " << copied << " ms\n";
+    os << "Diff: " << difference << " ms, " << patch.size() << " operations\n";
+    os << "Encode: " << encode << " ms, " << bytes.size() << " bytes\n";
+    os << "Decode and apply: " << decodeAndApply << " ms\n";
+    os << "Result: " << (applied && expected == actual ? "matches" : "differs") << '\n';
+    return String(os.str());
+}
+
+String benchmarkHash(size_t forms)
+{
+    StructForm corpus;
+    for (size_t i = 0; i < forms; ++i)
+    {
+        corpus[String("Form ") + String(std::to_string(i))] = makeForm();
+    }
+    Form a(std::in_place, std::move(corpus));
+    Form b(a);
+
+    FormHash hash = 0;
+    const double cold = measure([&]() { hash = hashForm(a); });
+    // Only a tracker can trust the cached hashes, since every write it sees is touched
+    FormTracker tracker;
+    tracker.track(a);
+    hash ^= tracker.hash();
+    const double cached = measure([&]() { hash ^= tracker.hash(); });
+
+    bool same = false;
+    const double equalTime = measure([&]() { same = equal(a, b); });
+
+    // Writing through the accessors only clears the hashes on the path to the change
+    b.get<StructForm>()["Form 0"].get<StructForm>()["String"] = "Changed";
+    bool different = false;
+    const double changed = measure([&]() { different = !equal(a, b); });
+
+    // A write through a reference taken before hashing
+    Form c(a);
+    c.unshare();
+    bool &flag = c.get<StructForm>()["Form 1"].get<StructForm>()["Boolean"].get<bool>();
+    const FormHash before = hashForm(c);
+    flag = !flag;
+    const bool seen = hashForm(c) != before && !equal(a, c);
+    flag = !flag;
+    const bool restored = hashForm(c) == before && equal(a, c);
+
+    std::ostringstream os;
+    os << "Forms: " << forms << " (" << countFields(a) << " fields)\n";
+    os << "Hash: " << cold << " ms, cached by a tracker: " << cached << " ms\n";
+    os << "Equal forms: " << equalTime << " ms (" << (same ? "equal" : "not equal") << ")\n";
+    os << "Write through a kept reference: " << (seen && restored ? "seen" : "missed") << '\n';
+    os << "After one change: " << changed << " ms (" << (different ? "not equal" : "equal") << ")\n";
+    return String(os.str());
+}
+
+String benchmarkSharing(size_t forms)
+{
+    CountingResource shared;
+    CountingResource separate;
+    const Allocator allocator(&shared);
+
+    Form original(allocator);
+    {
+        StructForm &corpus = original.emplace<StructForm>();
+        for (size_t i = 0; i < forms; ++i)
+        {
+            corpus[String("Form ") + String(std::to_string(i))] = makeForm(true, allocator);
+        }
+    }
+    const size_t fields = countFields(original);
+    // Building pins the maps, so copies of the built form are deep. Copies of an untouched copy share.
+    const Form base(original, allocator);
+    const size_t originalBytes = shared.getBytes();
+
+    // Copies with the same memory resource share their maps
+    std::optional<Form> copy;
+    const double sharedCopy = measure([&]() { copy.emplace(base, allocator); });
+    const size_t sharedBytes = shared.getBytes() - originalBytes;
+
+    const double edit = measure([&]() {
+        copy->get<StructForm>()["Form 0"].get<StructForm>()["String"] = "Changed";
+    });
+    const size_t editBytes = shared.getBytes() - originalBytes - sharedBytes;
+    const bool independent = !equal(base, *copy);
+
+    // A different memory resource forces a deep copy
+    std::optional<Form> deep;
+    const double deepCopy = measure([&]() { deep.emplace(base, Allocator(&separate)); });
+
+    // A copy taken while a dialog edits a form, through references the widgets took before it
+    Form edited(base, allocator);
+    FormTracker tracker;
+    tracker.track(edited);
+    String &name = edited.get<StructForm>()["Form 0"].get<StructForm>()["String"].get<String>();
+    const Form autosave = edited;
+    name = "bob";
+    tracker.touch(&name);
+    const Form *saved = resolve(autosave, toPath("Form 0/String"));
+    const bool kept = saved != nullptr && saved->get<String>() != "bob";
+
+    std::ostringstream os;
+    os << "Forms: " << forms << " (" << fields << " fields, " << originalBytes << " bytes)\n";
+    os << "Shared copy: " << sharedCopy << " ms, " << sharedBytes << " bytes\n";
+    os << "Edit one field: " << edit << " ms, " << editBytes << " bytes ("
+       << (independent ? "original unchanged" : "original changed") << ")\n";
+    os << "Deep copy: " << deepCopy << " ms, " << separate.getBytes() << " bytes\n";
+    os << "Copy of a tracked form: " << (kept ? "unchanged by later edits" : "changed by later edits") << '\n';
+    return String(os.str());
+}
+
+String benchmarkFields(size_t records)
+{
+    std::pmr::vector<Form> forms;
+    forms.reserve(records);
+    for (size_t i = 0; i < records; ++i)
+    {
+        forms.push_back(makeForm());
+    }
+
+    constexpr std::array<std::string_view, 5> Paths = {"Variant Form/1st Variant/Age", "Struct Form/String",
+                                                       "Enable Form/Alice", "Set of Strings",
+                                                       "Struct Form/Variant Form/2nd Variant/Weight"};
+    std::pmr::vector<FieldRef> fields;
+    FieldGather gather;
+    for (auto path : Paths)
+    {
+        auto field = FieldRef::compile(path, forms.front());
+        if (!field)
+        {
+            return String("Failed to compile ") + String(path);
+        }
+        gather.add(*field);
+        fields.push_back(std::move(*field));
+    }
+
+    // Sums what was read so the reads are not optimized away
+    size_t chainSum = 0;
+    const double chained = measure([&]() {
+        for (const Form &form : forms)
+        {
+            const auto &root = *form.get<StructForm>();
+            const auto &variant = *root.find("Variant Form")->second.get<VariantForm>();
+            const auto &first = *variant.find("1st Variant")->second.get<StructForm>();
+            chainSum += *std::get<Range<uint8_t>>(first.find("Age")->second.get<RangedValue>());
+            const auto &inner = *root.find("Struct Form")->second.get<StructForm>();
+            chainSum += inner.find("String")->second.get<String>().size();
+            const auto &enable = *root.find("Enable Form")->second.get<EnableForm>();
+            chainSum += enable.find("Alice")->second.second.get<String>().size();
+            chainSum += root.find("Set of Strings")->second.get<StringSelection>().index;
+            const auto &innerVariant = *inner.find("Variant Form")->second.get<VariantForm>();
+            const auto &second = *innerVariant.find("2nd Variant")->second.get<StructForm>();
+            const auto &weight = second.find("Weight")->second.get<RangedValue>();
+            chainSum += static_cast<size_t>(*std::get<Range<double>>(weight));
+        }
+    });
+
+    size_t refSum = 0;
+    const double resolved = measure([&]() {
+        for (const Form &form : forms)
+        {
+            refSum += **fields[0].getRange<uint8_t>(form);
+            refSum += fields[1].get<String>(form)->size();
+            refSum += fields[2].get<String>(form)->size();
+            refSum += fields[3].get<StringSelection>(form)->index;
+            refSum += static_cast<size_t>(**fields[4].getRange<double>(form));
+        }
+    });
+
+    size_t gatherSum = 0;
+    std::pmr::vector<const Form *> values;
+    const double gathered = measure([&]() {
+        for (const Form &form : forms)
+        {
+            gather.gather(form, values);
+            gatherSum += *std::get<Range<uint8_t>>(values[0]->get<RangedValue>());
+            gatherSum += values[1]->get<String>().size();
+            gatherSum += values[2]->get<String>().size();
+            gatherSum += values[3]->get<StringSelection>().index;
+            gatherSum += static_cast<size_t>(*std::get<Range<double>>(values[4]->get<RangedValue>()));
+        }
+    });
+
+    std::ostringstream os;
+    os << "Records: " << records << ", fields per record: " << fields.size() << "\n";
+    os << "Chained lookups: " << chained << " ms\n";
+    os << "FieldRef: " << resolved << " ms\n";
+    os << "FieldGather: " << gathered << " ms\n";
+    os << "Results: " << (chainSum == refSum && refSum == gatherSum ? "match" : "differ") << '\n';
+    return String(os.str());
+}
+
+String benchmarkSchema(size_t records)
+{
+    CountingResource formResource;
+    CountingResource valueResource;
+    CountingResource schemaResource;
+
+    std::pmr::vector<Form> forms(&formResource);
+    forms.reserve(records);
+    for (size_t i = 0; i < records; ++i)
+    {
+        forms.push_back(makeForm(true, &formResource));
+    }
+
+    std::optional<FormSchema> schema;
+    const double compile = measure([&]() { schema.emplace(forms.front(), &schemaResource); });
+
+    std::pmr::vector<FormValues> values(&valueResource);
+    values.reserve(records);
+    bool stored = true;
+    const double store = measure([&]() {
+        for (const Form &form : forms)
+        {
+            auto v = schema->values(form, &valueResource);
+            stored = stored && v.has_value();
+            if (v)
+            {
+                values.push_back(std::move(*v));
+            }
+        }
+    });
+
+    bool matches = stored;
+    const double materialize = measure([&]() {
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            matches = equal(schema->materialize(values[i]), forms[i]) && matches;
+        }
+    });
+
+    std::ostringstream os;
+    os << "Records: " << records << " (" << countFields(forms.front()) << " fields each)\n";
+    os << "Form: " << formResource.getBytes() / records << " bytes per record\n";
+    os << "FormValues: " << valueResource.getBytes() / records << " bytes per record (" << schema->recordSize()
+       << " packed)\n";
+    os << "Schema: " << schemaResource.getBytes() << " bytes, " << schema->size() << " nodes, compiled in "
+       << compile << " ms\n";
+    os << "Store: " << store << " ms, materialize and compare: " << materialize << " ms ("
+       << (matches ? "match" : "differ") << ")\n";
+    return String(os.str());
+}
+
+// Visits every field and adds up what it holds so the visits are not optimized away
+struct LayoutVisitor
+{
+    size_t sum = 0;
+
+    void operator()(std::monostate) noexcept
+    {
+    }
+    void operator()(bool b) noexcept
+    {
+        sum += b;
+    }
+    void operator()(const RangedValue &value) noexcept
+    {
+        sum += value.index();
+    }
+    void operator()(const String &s) noexcept
+    {
+        sum += s.size();
+    }
+    template <typename T> void operator()(const T &t) noexcept
+    {
+        if constexpr (std::is_same_v<T, ComplexString>)
+        {
+            sum += t.string.size();
+        }
+        else if constexpr (std::is_same_v<T, StringSelection>)
+        {
+            sum += t.index;
+        }
+        else if constexpr (std::is_same_v<T, VariantForm>)
+        {
+            for (const auto &[_, child] : *t)
+            {
+                visit(*this, child);
+            }
+        }
+        else
+        {
+            sum += t.size();
+        }
+    }
+    void operator()(const StructForm &structForm)
+    {
+        for (const auto &[_, child] : *structForm)
+        {
+            visit(*this, child);
+        }
+    }
+    void operator()(const EnableForm &enableForm)
+    {
+        for (const auto &[_, pair] : *enableForm)
+        {
+            visit(*this, pair.second);
+        }
+    }
+};
+
+// Groups of every kind of leaf field
+static Form makeWideForm(size_t fields)
+{
+    // Groups keep each map small enough to build quickly
+    constexpr size_t GroupSize = 1000;
+    Form built;
+    {
+        StructForm &root = built.emplace<StructForm>();
+        for (size_t group = 0; group * GroupSize < fields; ++group)
+        {
+            StructForm &structForm = root[String("Group ") + String(std::to_string(group))].emplace<StructForm>();
+            for (size_t i = 0; i < GroupSize && group * GroupSize + i < fields; ++i)
+            {
+                String key("Field ");
+                key += std::to_string(i);
+                switch (i % 6)
+                {
+                case 0:
+                    addForm(structForm, std::move(key), int8_t());
+                    break;
+                case 1:
+                    addForm(structForm, std::move(key), double());
+                    break;
+                case 2:
+                    addForm(structForm, std::move(key), bool());
+                    break;
+                case 3:
+                    addForm(structForm, std::move(key), String());
+                    break;
+                case 4:
+                    addForm(structForm, std::move(key), StringSelection());
+                    break;
+                default:
+                    addForm(structForm, std::move(key), StringMap());
+                    break;
+                }
+            }
+        }
+    }
+    return built;
+}
+
+String benchmarkLayout(size_t fields)
+{
+    const Form built = makeWideForm(fields);
+
+    // Copying into a counting resource measures the whole form
+    CountingResource resource;
+    const Form form(built, Allocator(&resource));
+    const size_t nodes = countFields(form);
+
+    constexpr size_t Passes = 5;
+    LayoutVisitor visitor;
+    const double visitTime = measure([&]() {
+        for (size_t pass = 0; pass < Passes; ++pass)
+        {
+            visit(visitor, form);
+        }
+    });
+
+    std::ostringstream os;
+    os << "Fields: " << nodes << '\n';
+    os << "sizeof(Form): " << sizeof(Form) << " bytes (StringSelection " << sizeof(StringSelection)
+       << ", VariantForm " << sizeof(VariantForm) << ", String " << sizeof(String) << ")\n";
+    os << "Memory: " << resource.getBytes() << " bytes, " << resource.getBytes() / nodes << " per field\n";
+    os << "Visit: " << visitTime / Passes << " ms per pass, "
+       << static_cast<double>(nodes * Passes) / visitTime / 1000.0 << " M fields/s (" << visitor.sum << ")\n";
+
+    // Assigning a field to the form that holds it
+    const String text(100, 'x');
+    Form outer;
+    outer.emplace<StructForm>()["Inner"].emplace<StructForm>()["Text"] = text;
+    outer = outer.get<StructForm>()["Inner"];
+    bool kept = outer.holds<StructForm>() && outer.get<StructForm>()["Text"].get<String>() == text;
+    outer = std::move(outer.get<StructForm>()["Text"]);
+    kept = kept && outer.holds<String>() && outer.get<String>() == text;
+    os << "Assign a field to its parent: " << (kept ? "kept" : "lost") << '\n';
+    return String(os.str());
+}
+
+String benchmarkValidation(size_t fields)
+{
+    const Form form = makeWideForm(fields);
+    const auto addChecks = [](ValidationEngine &engine) {
+        engine.addType<String>(ValidationEngine::matches("[A-Za-z ]*", "Letters only"));
+        engine.addType<RangedValue>(ValidationEngine::between(-100, 100, "Out of bounds"));
+        engine.addType<StringSelection>([](const StringSelection &s) -> std::optional<String> {
+            if (s.set.empty())
+            {
+                return String("No options");
+            }
+            return std::nullopt;
+        });
+    };
+
+    std::ostringstream os;
+    os << "Fields: " << countFields(form) << '\n';
+    double serial = 0;
+    size_t serialErrors = 0;
+    for (size_t threads : {size_t(1), size_t(0)})
+    {
+        ValidationEngine engine(threads);
+        addChecks(engine);
+        ValidationErrors errors;
+        const double time = measure([&]() { errors = engine.validate(form); });
+        if (threads == 1)
+        {
+            serial = time;
+            serialErrors = errors.size();
+        }
+        os << engine.getThreads() << " thread(s): " << time << " ms, " << errors.size() << " errors";
+        if (threads != 1)
+        {
+            os << " (" << serial / time << "x, " << (errors.size() == serialErrors ? "same" : "different")
+               << " errors)";
+        }
+        os << '\n';
+    }
+
+    // The pool is kept between validations, and tasks and errors come from the allocator of the engine
+    constexpr size_t Repeats = 1000;
+    const Form small = makeWideForm(100);
+    CountingResource resource;
+    ValidationEngine engine(0, resource.allocator());
+    addChecks(engine);
+    const size_t expected = engine.validate(small).size();
+    bool same = true;
+    const double repeated = measure([&]() {
+        for (size_t i = 0; i < Repeats; ++i)
+        {
+            same = engine.validate(small).size() == expected && same;
+        }
+    });
+    const ResourceCounters counters = resource.getCounters();
+    os << Repeats << " validations of " << countFields(small) << " fields: " << repeated << " ms ("
+       << (same ? "same" : "different") << " errors, " << counters.allocations << " allocations from the engine, "
+       << counters.bytes << " bytes held)\n";
+    return String(os.str());
+}
+
+String benchmarkComputed(size_t fields)
+{
+    // Each input feeds a chain of computed fields
+    constexpr size_t ChainLength = 4;
+    Form form;
+    StructForm &root = form.emplace<StructForm>();
+    ComputedFields computed;
+    for (size_t i = 0; i < fields; ++i)
+    {
+        String input("Input ");
+        input += std::to_string(i);
+        root[input] = makeNumber(static_cast<double>(i));
+        String previous = input;
+        for (size_t step = 0; step < ChainLength; ++step)
+        {
+            String target("Step ");
+            target += std::to_string(step);
+            target += ' ';
+            target += std::to_string(i);
+            root[target] = makeNumber(0.0);
+            computed.add(target, {previous}, [](const ComputedFields::Inputs &inputs, Form &form) {
+                ComputedFields::setNumber(form, ComputedFields::number(inputs[0]).value_or(0) + 1);
+            });
+            previous = std::move(target);
+        }
+    }
+    computed.update(form);
+
+    constexpr size_t Edits = 100;
+    size_t incrementalChanges = 0;
+    const double incremental = measure([&]() {
+        for (size_t edit = 0; edit < Edits; ++edit)
+        {
+            FormPath path;
+            path.emplace_back(String("Input ") + String(std::to_string(edit % fields)));
+            ComputedFields::setNumber(*resolve(form, path), static_cast<double>(edit * 7));
+            incrementalChanges += computed.changed(path, form);
+        }
+    });
+    size_t fullChanges = 0;
+    const double full = measure([&]() {
+        for (size_t edit = 0; edit < Edits; ++edit)
+        {
+            FormPath path;
+            path.emplace_back(String("Input ") + String(std::to_string(edit % fields)));
+            ComputedFields::setNumber(*resolve(form, path), static_cast<double>(edit * 11));
+            computed.invalidate();
+            fullChanges += computed.update(form);
+        }
+    });
+
+    std::ostringstream os;
+    os << "Computed fields: " << computed.size() << '\n';
+    os << "Dependents only: " << incremental / Edits << " ms per edit, " << incrementalChanges << " targets changed\n";
+    os << "Everything: " << full / Edits << " ms per edit, " << fullChanges << " targets changed\n";
+    return String(os.str());
+}
+
+// Layout of Range<T> when it implemented an interface with a virtual setter
+struct VirtualSetter
+{
+    virtual double setFromDouble(double) = 0;
+};
+
+template <typename T> struct VirtualRange : public VirtualSetter
+{
+    Range<T> range;
+
+    VirtualRange(T v, T mi, T ma) noexcept : range(*Range<T>::create(v, mi, ma))
+    {
+    }
+
+    virtual double setFromDouble(double d) override
+    {
+        return range.setFromDouble(d);
+    }
+};
+
+using VirtualRangedValue =
+    std::variant<VirtualRange<int8_t>, VirtualRange<int16_t>, VirtualRange<int32_t>, VirtualRange<int64_t>,
+                 VirtualRange<uint8_t>, VirtualRange<uint16_t>, VirtualRange<uint32_t>, VirtualRange<uint64_t>,
+                 VirtualRange<float>, VirtualRange<double>>;
+
+template <typename T> static void reportRangeSize(std::ostream &os, const char *name)
+{
+    os << "Range<" << name << ">: " << sizeof(VirtualRange<T>) << " -> " << sizeof(Range<T>) << " bytes\n";
+}
+
+String benchmarkRanges(size_t count)
+{
+    std::pmr::vector<RangedValue> ranges;
+    std::pmr::vector<VirtualRangedValue> virtualRanges;
+    ranges.reserve(count);
+    virtualRanges.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        switch (i % 3)
+        {
+        case 0:
+            ranges.emplace_back(*Range<int8_t>::create(0, -100, 100));
+            virtualRanges.emplace_back(VirtualRange<int8_t>(0, -100, 100));
+            break;
+        case 1:
+            ranges.emplace_back(*Range<int32_t>::create(0, -100000, 100000));
+            virtualRanges.emplace_back(VirtualRange<int32_t>(0, -100000, 100000));
+            break;
+        default:
+            ranges.emplace_back(*Range<double>::create(0.0, -1.0, 1.0));
+            virtualRanges.emplace_back(VirtualRange<double>(0.0, -1.0, 1.0));
+            break;
+        }
+    }
+
+    constexpr size_t Passes = 20;
+    double virtualSum = 0;
+    const double virtualTime = measure([&]() {
+        for (size_t pass = 0; pass < Passes; ++pass)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                VirtualSetter &setter =
+                    std::visit([](auto &range) -> VirtualSetter & { return range; }, virtualRanges[i]);
+                virtualSum += setter.setFromDouble(static_cast<double>(i % 256) - 128.0);
+            }
+        }
+    });
+    double sum = 0;
+    const double time = measure([&]() {
+        for (size_t pass = 0; pass < Passes; ++pass)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                const double d = static_cast<double>(i % 256) - 128.0;
+                sum += std::visit([d](auto &range) { return range.setFromDouble(d); }, ranges[i]);
+            }
+        }
+    });
+
+    std::ostringstream os;
+    os << "Sizes (virtual -> packed)\n";
+    reportRangeSize<int8_t>(os, "int8_t");
+    reportRangeSize<int16_t>(os, "int16_t");
+    reportRangeSize<int32_t>(os, "int32_t");
+    reportRangeSize<int64_t>(os, "int64_t");
+    reportRangeSize<double>(os, "double");
+    os << "RangedValue: " << sizeof(VirtualRangedValue) << " -> " << sizeof(RangedValue) << " bytes\n";
+    os << "Form: " << sizeof(Form) << " bytes (the largest alternative is not RangedValue)\n";
+    os << "Updates: " << count * Passes << '\n';
+    os << "Virtual setter: " << virtualTime << " ms, " << count * sizeof(VirtualRangedValue) << " bytes\n";
+    os << "Visit RangedValue: " << time << " ms, " << count * sizeof(RangedValue) << " bytes ("
+       << (sum == virtualSum ? "match" : "differ") << ")\n";
+    return String(os.str());
+}
+
+// Recursion that keeps the same path as FormWalker
+static size_t countRecursive(const Form &form, FormPath &path, size_t &deepest)
+{
+    deepest = std::max(deepest, path.size());
+    size_t count = 1;
+    if (auto structForm = form.getIf<StructForm>())
+    {
+        for (const auto &[key, child] : **structForm)
+        {
+            path.push_back(key);
+            count += countRecursive(child, path, deepest);
+            path.pop_back();
+        }
+    }
+    return count;
+}
+
+String benchmarkWalker(size_t depth)
+{
+    // A chain of StructForms with a few leaves on each level
+    constexpr size_t Leaves = 8;
+    Form form;
+    Form *level = &form;
+    for (size_t i = 0; i < depth; ++i)
+    {
+        StructForm &structForm = level->emplace<StructForm>();
+        for (size_t j = 0; j < Leaves; ++j)
+        {
+            structForm[String("Leaf ") + String(std::to_string(j))] = makeNumber(static_cast<double>(j));
+        }
+        level = &structForm["Next"];
     }
-    return Form(std::in_place, std::move(forms));
+
+    constexpr size_t Walks = 100;
+    size_t recursiveCount = 0;
+    size_t deepest = 0;
+    FormPath path;
+    const double recursive = measure([&]() {
+        for (size_t i = 0; i < Walks; ++i)
+        {
+            recursiveCount += countRecursive(form, path, deepest);
+        }
+    });
+    size_t walkerCount = 0;
+    FormWalker walker;
+    const double walked = measure([&]() {
+        for (size_t i = 0; i < Walks; ++i)
+        {
+            walker.walk(form, [&](const FormWalker::Step &) {
+                ++walkerCount;
+                deepest = std::max(deepest, walker.depth());
+            });
+        }
+    });
+
+    // Tracking unshares and collects the whole chain, and a change at the bottom is found again
+    FormTracker tracker;
+    const double tracking = measure([&]() { tracker.track(form); });
+    const Revision before = tracker.current();
+    tracker.touch(level);
+    size_t changedDepth = 0;
+    tracker.changedSince(before, [&](const FormPath &path, const Form &) { changedDepth = path.size(); });
+
+    std::ostringstream os;
+    os << "Depth: " << deepest << ", forms: " << walkerCount / Walks << '\n';
+    os << "Recursion: " << recursive / Walks << " ms per walk" << '\n';
+    os << "FormWalker: " << walked / Walks << " ms per walk ("
+       << (recursiveCount == walkerCount ? "match" : "differ") << ")\n";
+    os << "Track: " << tracking << " ms, deepest change found at depth " << changedDepth << " ("
+       << (changedDepth == depth ? "match" : "differ") << ")\n";
+    return String(os.str());
 }
 
+// Prints the selected alternatives and enabled fields with one tab per level
 struct Printer
 {
     std::ostream &os;
@@ -98,6 +1035,31 @@ struct Printer
     {
     }
 
+    void print(const Form &form)
+    {
+        FormWalker walker(true);
+        walker.walk(
+            form,
+            [this, &walker](const FormWalker::Step &step) {
+                tabs = walker.depth();
+                // Fields of a VariantForm are announced by the VariantForm
+                if (step.parent != nullptr && !step.parent->holds<VariantForm>())
+                {
+                    tabs = walker.depth() - 1;
+                    addTabs();
+                    os << step.key << std::endl;
+                    tabs = walker.depth();
+                }
+                visit(*this, *step.form);
+            },
+            [this](const FormWalker::Step &step) {
+                if (step.parent != nullptr)
+                {
+                    os << std::endl;
+                }
+            });
+    }
+
     void addTabs()
     {
         for (size_t i = 0; i < tabs; ++i)
@@ -167,46 +1129,17 @@ struct Printer
     {
         addTabs();
         os << "Variant Selected " << variant.selected << std::endl;
-        auto iter = variant.map.find(variant.selected);
-        if (iter != variant.map.end())
-        {
-            const auto &form = iter->second;
-            ++tabs;
-            std::visit(*this, *form);
-            --tabs;
-            os << std::endl;
-        }
         return os;
     }
 
-    std::ostream &operator()(const StructForm &structForm)
+    // The walk prints the fields
+    std::ostream &operator()(const StructForm &)
     {
-        for (auto &[name, form] : *structForm)
-        {
-            addTabs();
-            os << name << std::endl;
-            ++tabs;
-            std::visit(*this, *form);
-            --tabs;
-            os << std::endl;
-        }
         return os;
     }
 
-    std::ostream &operator()(const EnableForm &enableForm)
+    std::ostream &operator()(const EnableForm &)
     {
-        for (auto &[name, pair] : *enableForm)
-        {
-            addTabs();
-            if (pair.first)
-            {
-                os << name << std::endl;
-                ++tabs;
-                std::visit(*this, *pair.second);
-                --tabs;
-                os << std::endl;
-            }
-        }
         return os;
     }
 
@@ -234,9 +1167,696 @@ struct Printer
 void printForm(const Form &form, void *parent)
 {
     std::ostringstream os;
-    std::visit(Printer(os), *form);
+    Printer(os).print(form);
     auto s = os.str();
     showMessageBox(MessageBoxType::Information, "Form Data", s, parent);
 }
 
+class ChangeReport : public FormExecute
+{
+  private:
+    void *parent;
+
+  public:
+    ChangeReport(void *p) : FormExecute(std::in_place, makeForm()), parent(p)
+    {
+    }
+    virtual ~ChangeReport()
+    {
+    }
+
+    virtual void ok() override
+    {
+        std::ostringstream os;
+        size_t count = 0;
+        if (auto tracker = getTracker())
+        {
+            tracker->changedSince(0, [&os, &count](const FormPath &path, const Form &) {
+                for (size_t i = 0; i < path.size(); ++i)
+                {
+                    os << (i == 0 ? "" : " / ") << path[i];
+                }
+                os << '\n';
+                ++count;
+            });
+        }
+        if (count == 0)
+        {
+            os << "Nothing changed\n";
+        }
+        showMessageBox(MessageBoxType::Information, "Changed Fields", os.str(), parent);
+    }
+};
+
+std::shared_ptr<FormExecute> executeChangeReport(void *parent)
+{
+    return std::make_shared<ChangeReport>(parent);
+}
+
+std::shared_ptr<FormExecute> executeSchemaForm(void *parent)
+{
+    static const auto schema = std::make_shared<const FormSchema>(makeForm());
+    auto lambda = executeValues(
+        [parent](const FormSchema &s, FormValues &values) {
+            std::ostringstream os;
+            os << "Stored " << s.recordSize() << " packed bytes\n";
+            if (auto age = s.find("Variant Form/1st Variant/Age"))
+            {
+                os << "Age: " << static_cast<int>(values.read<uint8_t>(s[*age].offset)) << '\n';
+            }
+            if (auto text = s.find("String"))
+            {
+                os << "String: " << values.string(s[*text].value) << '\n';
+            }
+            showMessageBox(MessageBoxType::Information, "Form Values", os.str(), parent);
+        },
+        schema, *schema->values(makeForm()));
+    return std::make_shared<decltype(lambda)>(std::move(lambda));
+}
+
+struct Address
+{
+    std::string street;
+    std::string city;
+    Range<uint32_t> zip = *Range<uint32_t>::create(10000, 0, 99999);
+    BIND(Address, street, city, zip)
+};
+
+struct Person
+{
+    std::string name = "Alice";
+    int age = 30;
+    bool active = true;
+    double weight = 60.5;
+    std::set<std::string> tags = {"Admin", "Tester"};
+    Address address;
+    BIND(Person, name, age, active, weight, tags, address)
+};
+
+std::shared_ptr<FormExecute> executeBoundStruct(void *parent)
+{
+    static Person person;
+    auto execute = executeBound(person, [parent](const Person &p) {
+        std::ostringstream os;
+        os << p.name << ", " << p.age << (p.active ? " (active)" : "") << ", " << p.weight << "\n";
+        for (const auto &tag : p.tags)
+        {
+            os << tag << '\n';
+        }
+        os << p.address.street << ", " << p.address.city << ' ' << *p.address.zip << '\n';
+        showMessageBox(MessageBoxType::Information, "Person", os.str(), parent);
+    });
+    return std::make_shared<decltype(execute)>(std::move(execute));
+}
+
+std::shared_ptr<FormExecute> executeBatchForm(void *parent)
+{
+    StringSet roles({"Admin", "Tester", "Guest"});
+    const Form prototype(std::in_place,
+                         StructForm::create("Name", String(), "Age", *Range<uint8_t>::create(30, 0, 120), "Active",
+                                            true, "Role", StringSelection(0, std::move(roles)), "Address",
+                                            StructForm::create("City", String())));
+    auto batch = FormBatch::create(prototype);
+    batch->resize(1000);
+    const size_t name = *batch->find("Name");
+    const size_t age = *batch->find("Age");
+    for (size_t i = 0; i < batch->size(); ++i)
+    {
+        batch->setString(name, i, "Person " + std::to_string(i + 1));
+        batch->values<uint8_t>(age)[i] = static_cast<uint8_t>(rand() % 200);
+    }
+
+    auto execute = executeBatch(
+        [parent](const FormBatch &b) {
+            const uint8_t *ages = b.values<uint8_t>(*b.find("Age"));
+            const uint8_t *active = b.values<uint8_t>(*b.find("Active"));
+            size_t total = 0;
+            size_t count = 0;
+            for (size_t i = 0; i < b.size(); ++i)
+            {
+                total += ages[i];
+                count += active[i];
+            }
+            std::ostringstream os;
+            os << b.size() << " records, " << count << " active, average age "
+               << (b.size() == 0 ? 0.0 : static_cast<double>(total) / b.size());
+            showMessageBox(MessageBoxType::Information, "Batch", os.str(), parent);
+        },
+        std::move(*batch));
+    return std::make_shared<decltype(execute)>(std::move(execute));
+}
+
+std::shared_ptr<FormExecute> executeValidatedForm(void *parent)
+{
+    auto engine = std::make_shared<ValidationEngine>();
+    engine->add("String", ValidationEngine::matches("[A-Z][a-z]*", "Must be one capitalized word"));
+    engine->add("1-10", ValidationEngine::between(2, 8, "Must be from 2 to 8"));
+    engine->addType<StringSet>(ValidationEngine::notEmpty("Must not be empty"));
+    engine->add<StructForm>("", [](const StructForm &s) -> std::optional<String> {
+        auto signedInteger = s->find("Signed Integer");
+        auto unsignedInteger = s->find("Unsigned Integer");
+        if (signedInteger == s->end() || unsignedInteger == s->end())
+        {
+            return std::nullopt;
+        }
+        const auto number = [](const Form &f) {
+            return std::visit([](const auto &range) { return static_cast<double>(*range); },
+                              f.get<RangedValue>());
+        };
+        if (number(signedInteger->second) <= number(unsignedInteger->second))
+        {
+            return std::nullopt;
+        }
+        return String("Signed Integer must not be more than Unsigned Integer");
+    });
+
+    auto lambda = executeForm([parent](const Form &form) { printForm(form, parent); }, makeForm());
+    lambda.setValidation(std::move(engine));
+    return std::make_shared<decltype(lambda)>(std::move(lambda));
+}
+
+std::shared_ptr<FormExecute> executeComputedForm(void *parent)
+{
+    EnableForm shipping;
+    shipping["Free Shipping"] = std::make_pair(false, Form(std::in_place, String("Over 100 in total")));
+    const Form form(std::in_place,
+                    StructForm::create("Price", *Range<double>::create(25, 0, 1000), "Quantity",
+                                       *Range<int32_t>::create(1, 0, 100), "Total", makeNumber(0.0), "Tax",
+                                       makeNumber(0.0), "Shipping", std::move(shipping), "Weight (kg)",
+                                       *Range<double>::create(1, 0, 1000), "Weight (lb)", makeNumber(0.0)));
+
+    auto computed = std::make_shared<ComputedFields>();
+    using Inputs = ComputedFields::Inputs;
+    computed->add("Total", {"Price", "Quantity"}, [](const Inputs &inputs, Form &target) {
+        ComputedFields::setNumber(target, ComputedFields::number(inputs[0]).value_or(0) *
+                                              ComputedFields::number(inputs[1]).value_or(0));
+    });
+    computed->add("Tax", {"Total"}, [](const Inputs &inputs, Form &target) {
+        ComputedFields::setNumber(target, ComputedFields::number(inputs[0]).value_or(0) * 0.08);
+    });
+    computed->add("Shipping", {"Total"}, [](const Inputs &inputs, Form &target) {
+        if (auto shipping = target.getIf<EnableForm>())
+        {
+            (*shipping)["Free Shipping"].first = ComputedFields::number(inputs[0]).value_or(0) > 100;
+        }
+    });
+    computed->add("Weight (lb)", {"Weight (kg)"}, [](const Inputs &inputs, Form &target) {
+        ComputedFields::setNumber(target, ComputedFields::number(inputs[0]).value_or(0) * 2.20462);
+    });
+
+    auto lambda = executeForm([parent](const Form &form) { printForm(form, parent); }, form);
+    lambda.setComputed(std::move(computed));
+    return std::make_shared<decltype(lambda)>(std::move(lambda));
+}
+
+std::shared_ptr<FormExecute> executeJournalForm(void *parent)
+{
+    auto lambda = executeForm([parent](const Form &form) { printForm(form, parent); }, makeForm());
+    lambda.setJournal(std::make_shared<EditJournal>(100));
+    return std::make_shared<decltype(lambda)>(std::move(lambda));
+}
+
+std::shared_ptr<FormExecute> executeTransactionForm(void *parent)
+{
+    // The same form is shown every time so the edits of a canceled dialog can be seen to be gone
+    static std::shared_ptr<FormExecute> shown;
+    if (shown == nullptr)
+    {
+        auto lambda = executeForm([parent](const Form &form) { printForm(form, parent); }, makeForm());
+        lambda.setTransactional(true);
+        shown = std::make_shared<decltype(lambda)>(std::move(lambda));
+    }
+    return shown;
+}
+
+std::shared_ptr<FormExecute> executeLazyVariantForm(void *parent)
+{
+    VariantForm variant;
+    for (size_t i = 0; i < 40; ++i)
+    {
+        variant.addLazy(String("Catalog ") + String(std::to_string(i)), []() { return makeWideForm(100); });
+    }
+    variant.dropUnselected = true;
+    variant.select("Catalog 0");
+    const Form form(std::in_place, StructForm::create("Catalog", std::move(variant)));
+    auto lambda = executeForm([parent](const Form &form) { printForm(form, parent); }, form);
+    return std::make_shared<decltype(lambda)>(std::move(lambda));
+}
+
+String benchmarkLazyVariant(size_t alternatives)
+{
+    constexpr size_t Fields = 1000;
+    auto count = [](const VariantForm &variant) {
+        size_t n = 0;
+        for (const auto &[_, form] : *variant)
+        {
+            n += countFields(form);
+        }
+        return n;
+    };
+
+    VariantForm eager;
+    const double built = measure([&]() {
+        for (size_t i = 0; i < alternatives; ++i)
+        {
+            eager[String("Alternative ") + String(std::to_string(i))] = makeWideForm(Fields);
+        }
+        eager.selected = "Alternative 0";
+    });
+    VariantForm lazy;
+    const double registered = measure([&]() {
+        for (size_t i = 0; i < alternatives; ++i)
+        {
+            lazy.addLazy(String("Alternative ") + String(std::to_string(i)), []() { return makeWideForm(Fields); });
+        }
+        lazy.dropUnselected = true;
+        lazy.select("Alternative 0");
+    });
+    const double switched = measure([&]() { lazy.select("Alternative 1"); });
+
+    // Tracked next to a large field, switching walks only the alternatives that are built or dropped
+    Form tracked(std::in_place,
+                 StructForm::create("Other", makeWideForm(Fields * alternatives), "Choice", VariantForm(lazy)));
+    FormTracker tracker;
+    tracker.track(tracked);
+    VariantForm &choice = tracked.get<StructForm>()["Choice"].get<VariantForm>();
+    Form *shown = nullptr;
+    const double trackedSwitch = measure([&]() { shown = selectAlternative(&tracker, choice, Atom("Alternative 2")); });
+    const double retracked = measure([&]() { tracker.retrack(); });
+    bool found = false;
+    if (shown != nullptr)
+    {
+        const Form &group = std::as_const(*shown).get<StructForm>()->find(Atom("Group 0"))->second;
+        const Form &field = group.get<StructForm>()->find(Atom("Field 1"))->second;
+        found = tracker.touch(&field) && toString(tracker.pathOf(field)) == "Choice/Alternative 2/Group 0/Field 1";
+    }
+
+    std::ostringstream os;
+    os << "Alternatives: " << alternatives << " of " << Fields << " fields\n";
+    os << "Eager: " << built << " ms, " << count(eager) << " forms\n";
+    os << "Lazy: " << registered << " ms, " << count(lazy) << " forms\n";
+    os << "Switch and drop: " << switched << " ms, " << count(lazy) << " forms\n";
+    os << "Tracked switch: " << trackedSwitch << " ms, retrack: " << retracked << " ms, field in built alternative "
+       << (found ? "found" : "missing") << '\n';
+    return String(os.str());
+}
+
+// SKU-0000000, SKU-0000001, ...
+static std::shared_ptr<OptionList> makeSkus(size_t count)
+{
+    String lines;
+    char buffer[32];
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::snprintf(buffer, sizeof(buffer), "SKU-%07zu\n", i);
+        lines += buffer;
+    }
+    return std::make_shared<OptionList>(std::move(lines));
+}
+
+std::shared_ptr<FormExecute> executeOptionPicker(void *parent)
+{
+    const Form form(std::in_place, StructForm::create("Product", StringSelection(makeSkus(1000000), "SKU-0500000"),
+                                                      "Quantity", *Range<int32_t>::create(1, 0, 100)));
+    auto lambda = executeForm([parent](const Form &form) { printForm(form, parent); }, form);
+    return std::make_shared<decltype(lambda)>(std::move(lambda));
+}
+
+String benchmarkOptions(size_t count)
+{
+    std::shared_ptr<OptionList> list;
+    const double built = measure([&]() { list = makeSkus(count); });
+    IndexedStringSet set;
+    const double setBuilt = measure([&]() {
+        for (size_t i = 0; i < list->size(); ++i)
+        {
+            set.emplace(list->at(i));
+        }
+    });
+
+    constexpr size_t Searches = 10000;
+    size_t found = 0;
+    const double searched = measure([&]() {
+        char prefix[32];
+        for (size_t i = 0; i < Searches; ++i)
+        {
+            std::snprintf(prefix, sizeof(prefix), "SKU-%05zu", (i * 7919) % (count / 100 + 1));
+            found += list->find(prefix) != OptionProvider::npos;
+        }
+    });
+    StringSelection selection(list);
+    std::pmr::vector<std::string_view> window;
+    const double paged = measure([&]() {
+        for (size_t i = 0; i < Searches; ++i)
+        {
+            window.clear();
+            list->fetch((i * 7919) % count, 10, window);
+            selection.select((i * 7919) % count);
+        }
+    });
+
+    std::ostringstream os;
+    os << "Options: " << list->size() << '\n';
+    os << "OptionList: " << built << " ms to build\n";
+    os << "IndexedStringSet: " << setBuilt << " ms to build\n";
+    os << "Prefix search: " << searched / Searches * 1000 << " us (" << found << " of " << Searches << " found)\n";
+    os << "Window of 10 and select: " << paged / Searches * 1000 << " us, selected " << selection.key << '\n';
+    return String(os.str());
+}
+
+String benchmarkJournal(size_t fields)
+{
+    Form form = makeWideForm(fields);
+    FormTracker tracker;
+    tracker.track(form);
+    std::pmr::vector<Form *> texts;
+    std::pmr::vector<Form *> flags;
+    MutableFormWalker().walk(form, [&](const MutableFormWalker::Step &step) {
+        if (step.form->holds<String>())
+        {
+            texts.push_back(step.form);
+        }
+        else if (step.form->holds<bool>())
+        {
+            flags.push_back(step.form);
+        }
+    });
+
+    CountingResource resource;
+    EditJournal journal(256, Allocator(&resource));
+    journal.attach(tracker);
+    // Typing ten characters into a field, then toggling a flag
+    constexpr size_t Edits = 100000;
+    const double recorded = measure([&]() {
+        for (size_t i = 0; i < Edits; ++i)
+        {
+            if (i % 11 == 10)
+            {
+                bool &b = flags[(i / 11) % flags.size()]->get<bool>();
+                tracker.prepare(&b);
+                b = !b;
+                tracker.touch(&b);
+            }
+            else
+            {
+                String &text = texts[(i / 11) % texts.size()]->get<String>();
+                tracker.prepare(&text);
+                text.push_back(static_cast<char>('a' + i % 26));
+                tracker.touch(&text);
+            }
+        }
+    });
+    const size_t entries = journal.size();
+    size_t undone = 0;
+    const double replayed = measure([&]() {
+        while (journal.undo() != nullptr)
+        {
+            ++undone;
+        }
+    });
+
+    // Keeping a copy of the whole form for each of the same number of edits
+    CountingResource copies;
+    const double copied = measure([&]() {
+        std::pmr::vector<Form> history(&copies);
+        history.reserve(entries);
+        for (size_t i = 0; i < entries; ++i)
+        {
+            history.emplace_back(form);
+            history.back().unshare();
+        }
+    });
+
+    std::ostringstream os;
+    os << "Fields: " << countFields(form) << ", edits: " << Edits << '\n';
+    os << "Journal: " << recorded << " ms to record, " << entries << " entries kept in "
+       << resource.getBytes() / 1024 << " KiB\n";
+    os << "Undo of " << undone << " entries: " << replayed << " ms\n";
+    os << "Copying the form " << entries << " times: " << copied << " ms\n";
+    return String(os.str());
+}
+
+String benchmarkTransaction(size_t fields)
+{
+    Form form = makeWideForm(fields);
+    const Form original = form;
+    FormTracker tracker;
+    tracker.track(form);
+    std::pmr::vector<Form *> texts;
+    MutableFormWalker().walk(form, [&texts](const MutableFormWalker::Step &step) {
+        if (step.form->holds<String>())
+        {
+            texts.push_back(step.form);
+        }
+    });
+
+    // What callers did before: a copy of the whole form to restore on cancel
+    constexpr size_t Passes = 10;
+    const double copied = measure([&]() {
+        for (size_t pass = 0; pass < Passes; ++pass)
+        {
+            Form copy(form);
+            copy.unshare();
+        }
+    });
+
+    // Ten edits of a hundred fields, then a rollback
+    FormTransaction transaction;
+    constexpr size_t Edited = 100;
+    size_t kept = 0;
+    size_t restored = 0;
+    const double rolledBack = measure([&]() {
+        for (size_t pass = 0; pass < Passes; ++pass)
+        {
+            transaction.begin(tracker);
+            for (size_t i = 0; i < Edited * 10; ++i)
+            {
+                String &text = texts[(i % Edited) * (texts.size() / Edited)]->get<String>();
+                tracker.prepare(&text);
+                text.push_back('x');
+                tracker.touch(&text);
+            }
+            kept = transaction.size();
+            restored += transaction.rollback();
+        }
+    });
+
+    std::ostringstream os;
+    os << "Fields: " << countFields(form) << '\n';
+    os << "Copy to restore: " << copied / Passes << " ms\n";
+    os << "Transaction of " << Edited * 10 << " edits to " << kept << " fields: " << rolledBack / Passes
+       << " ms with rollback, " << restored / Passes << " values restored ("
+       << (equal(form, original) ? "form restored" : "form differs") << ")\n";
+    return String(os.str());
+}
+
+String benchmarkMemory(size_t fields)
+{
+    // Built with the default allocator, as callers do, and counted by the scope
+    CountingScope scope;
+    const Form built = makeWideForm(fields);
+    const ResourceCounters building = scope.getResource().getCounters();
+
+    // A copy with its own resource, so the report can compare its estimates with what was allocated
+    CountingResource resource(scope.getResource().getUpstream());
+    const Form form(built, Allocator(&resource));
+    const ResourceCounters copying = resource.getCounters();
+
+    constexpr size_t Passes = 10;
+    FormMemoryStats stats;
+    const double reportTime = measure([&]() {
+        for (size_t pass = 0; pass < Passes; ++pass)
+        {
+            stats = report(form);
+        }
+    });
+    // Copies share their maps until written, so both are counted once
+    Form copies(resource.allocator());
+    {
+        StructForm &structForm = copies.emplace<StructForm>();
+        structForm["Original"] = form;
+        structForm["Copy"] = form;
+    }
+    const FormMemoryStats sharing = report(copies);
+
+    String json;
+    {
+        JsonWriter writer(json);
+        writeJson(stats, writer);
+    }
+
+    // Worker threads of a validation allocate through the scope too, and every allocation is matched
+    constexpr size_t ValidationThreads = 4;
+    const ResourceCounters before = scope.getResource().getCounters();
+    {
+        ValidationEngine engine(ValidationThreads);
+        engine.addType<String>(ValidationEngine::matches("[A-Za-z ]*", "Letters only"));
+        engine.addType<RangedValue>(ValidationEngine::between(-100, 100, "Out of bounds"));
+        const ValidationErrors errors = engine.validate(built);
+    }
+    const ResourceCounters after = scope.getResource().getCounters();
+    const bool balanced = after.bytes == before.bytes && after.allocations - after.deallocations ==
+                                                             before.allocations - before.deallocations;
+
+    const MemoryUsage &total = stats.total;
+    std::ostringstream os;
+    os << "Fields: " << stats.forms << '\n';
+    os << "Building: " << building.bytes << " bytes, peak " << building.peak << ", " << building.allocations
+       << " allocations\n";
+    os << "Copy: " << copying.bytes << " bytes in " << copying.allocations
+       << " allocations, reported " << total.total() << " bytes\n";
+    os << "Keys: " << total.keys << ", strings: " << total.strings << ", map nodes: " << total.mapNodes
+       << ", set nodes: " << total.setNodes << ", ranges: " << total.ranges << '\n';
+    os << "Largest group: ";
+    const FormMemoryStats::Subtree *largest = nullptr;
+    for (const auto &subtree : stats.subtrees)
+    {
+        if (!subtree.path.empty() && (largest == nullptr || subtree.usage.total() > largest->usage.total()))
+        {
+            largest = &subtree;
+        }
+    }
+    if (largest != nullptr)
+    {
+        os << toString(largest->path) << " (" << largest->usage.total() << " bytes)";
+    }
+    os << '\n';
+    os << "Report: " << reportTime / Passes << " ms, " << stats.subtrees.size() << " subtrees, " << json.size()
+       << " bytes of JSON\n";
+    os << "Two copies: " << sharing.sharedMaps << " shared map, reported " << sharing.total.total() << " bytes, "
+       << resource.getBytes() - copying.bytes << " allocated\n";
+    os << "Validation on " << ValidationThreads << " threads: " << after.allocations - before.allocations
+       << " allocations counted (" << (balanced ? "balanced" : "unbalanced") << ")\n";
+    return String(os.str());
+}
+
+String benchmarkNumericEntry(size_t count)
+{
+    // Values above 2^53 that a double cannot hold exactly
+    std::pmr::vector<std::array<char, NumberChars>> texts(count);
+    std::pmr::vector<int64_t> expected(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        expected[i] = (int64_t(1) << 62) + static_cast<int64_t>(i * 7919) * (i % 2 == 0 ? 1 : -1);
+        *formatNumber(texts[i].data(), texts[i].data() + NumberChars - 1, expected[i]) = '\0';
+    }
+
+    Range<int64_t> range(0);
+    size_t viaDouble = 0;
+    const double doubleTime = measure([&]() {
+        for (size_t i = 0; i < count; ++i)
+        {
+            range.setFromDouble(std::strtod(texts[i].data(), nullptr));
+            viaDouble += *range == expected[i];
+        }
+    });
+    size_t viaChars = 0;
+    const double charsTime = measure([&]() {
+        for (size_t i = 0; i < count; ++i)
+        {
+            range.setFromChars(texts[i].data());
+            viaChars += *range == expected[i];
+        }
+    });
+    char buffer[NumberChars];
+    size_t formatted = 0;
+    const double formatTime = measure([&]() {
+        for (size_t i = 0; i < count; ++i)
+        {
+            range = expected[i];
+            formatted += range.toChars(buffer, buffer + sizeof(buffer)) - buffer;
+        }
+    });
+
+    auto clamped = Range<uint64_t>::create(5, 5, std::numeric_limits<uint64_t>::max());
+    clamped->setFromChars("-1");
+    const uint64_t low = **clamped;
+    clamped->setFromChars("99999999999999999999");
+    const uint64_t high = **clamped;
+
+    // A double beyond the limits of the type clamps instead of overflowing
+    Range<int64_t> huge(0);
+    huge.setFromDouble(1e30);
+    const bool hugeClamped = *huge == std::numeric_limits<int64_t>::max();
+
+    // Batch cells keep the exact digits as well
+    Form prototype;
+    prototype.emplace<StructForm>()["Count"] = RangedValue(Range<int64_t>(0));
+    auto batch = FormBatch::create(prototype);
+    bool batchExact = false;
+    if (batch)
+    {
+        batch->resize(1);
+        batchExact = batch->setNumberFromChars(0, 0, texts[0].data()) && !batch->setNumberFromChars(0, 0, "-");
+        char *end = batch->numberToChars(0, 0, buffer, buffer + sizeof(buffer));
+        batchExact = batchExact && end != nullptr && std::string_view(buffer, end - buffer) == texts[0].data();
+    }
+
+    std::ostringstream os;
+    os << "Entries: " << count << " int64_t values above 2^53\n";
+    os << "strtod and setFromDouble: " << doubleTime << " ms, " << viaDouble << " exact\n";
+    os << "setFromChars: " << charsTime << " ms, " << viaChars << " exact\n";
+    os << "toChars: " << formatTime << " ms, " << formatted << " characters\n";
+    os << "uint64_t in [5, max]: -1 -> " << low << ", 99999999999999999999 -> " << high << '\n';
+    os << "int64_t from 1e30: " << (hugeClamped ? "clamped" : "overflowed") << '\n';
+    os << "Batch cell: " << (batchExact ? "exact" : "rounded") << '\n';
+    return String(os.str());
+}
+
+String benchmarkJson(size_t forms)
+{
+    StructForm corpus;
+    for (size_t i = 0; i < forms; ++i)
+    {
+        corpus[String("Form ") + String(std::to_string(i))] = makeForm();
+    }
+    const Form form(std::in_place, std::move(corpus));
+    const auto path = (std::filesystem::temp_directory_path() / "canform.json").string();
+
+    std::ostringstream os;
+    size_t printed = 0;
+    const double print = measure([&]() {
+        std::ostringstream printer;
+        Printer(printer).print(form);
+        printed = printer.str().size();
+    });
+
+    bool saved = false;
+    const double save = measure([&]() { saved = saveJson(form, path.c_str()); });
+    if (!saved)
+    {
+        os << "Failed to write " << path << '\n';
+        return String(os.str());
+    }
+    const size_t bytes = std::filesystem::file_size(path);
+
+    std::optional<Form> loaded;
+    const double load = measure([&]() { loaded = loadJson(path.c_str()); });
+    std::filesystem::remove(path);
+    if (!loaded)
+    {
+        os << "Failed to read " << path << '\n';
+        return String(os.str());
+    }
+
+    String first;
+    String second;
+    {
+        JsonWriter writer(first);
+        writeJson(form, writer);
+    }
+    {
+        JsonWriter writer(second);
+        writeJson(*loaded, writer);
+    }
+
+    const double megabytes = bytes / (1024.0 * 1024.0);
+    os << "Forms: " << forms << " (" << countFields(form) << " fields)\n";
+    os << "Printer: " << printed << " bytes in " << print << " ms\n";
+    os << "JSON write: " << bytes << " bytes in " << save << " ms (" << megabytes / (save / 1000.0) << " MB/s)\n";
+    os << "JSON read: " << load << " ms (" << megabytes / (load / 1000.0) << " MB/s)\n";
+    os << "Round trip: " << (first == second ? "identical" : "different") << '\n';
+    return String(os.str());
+}
+
 } // namespace CanForm
\ No newline at end of file
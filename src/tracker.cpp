@@ -0,0 +1,330 @@
+#include <algorithm>
+#include <computed.hpp>
+#include <hash.hpp>
+#include <journal.hpp>
+#include <tracker.hpp>
+#include <walker.hpp>
+
+namespace CanForm
+{
+FormTracker::FormTracker(const Allocator &allocator)
+    : root(nullptr), nodes(allocator), owners(allocator), listeners(allocator), preparers(allocator), counter(0),
+      nextListener(1), walker(false, allocator)
+{
+}
+
+// Calls f with the address of the value of a form and of every part of it that widgets hold
+template <typename F> static void forEachPart(const Form &form, F &&f)
+{
+    visit(
+        [&f](const auto &value) {
+            using T = std::decay_t<decltype(value)>;
+            f(&value);
+            if constexpr (std::is_same_v<T, RangedValue>)
+            {
+                f(std::visit([](const auto &range) -> const void * { return &range; }, value));
+            }
+            else if constexpr (std::is_same_v<T, ComplexString>)
+            {
+                f(&value.string);
+            }
+            else if constexpr (std::is_same_v<T, StringSelection>)
+            {
+                f(&value.index);
+                f(&value.key);
+            }
+            else if constexpr (std::is_same_v<T, StringMap>)
+            {
+                for (const auto &pair : value)
+                {
+                    f(&pair.second);
+                }
+            }
+            else if constexpr (std::is_same_v<T, VariantForm>)
+            {
+                f(&value.selected);
+            }
+        },
+        form);
+}
+
+void FormTracker::add(const Form &top, const Form *parent, const Atom &key)
+{
+    walker.walk(top, [this, &top, parent, &key](const FormWalker::Step &step) {
+        const Form &form = *step.form;
+        const bool isTop = &form == &top;
+        const Node node{isTop ? parent : step.parent, isTop ? key : step.key, 0, 0};
+        auto [iter, inserted] = nodes.try_emplace(&form, node);
+        if (!inserted)
+        {
+            iter->second.parent = node.parent;
+            iter->second.key = node.key;
+        }
+        owners[&form] = &form;
+        // Writes made before tracking were not touched, so no cached hash can be trusted
+        form.invalidate();
+        if (step.enabled != nullptr)
+        {
+            owners.try_emplace(step.enabled, step.parent);
+        }
+        forEachPart(form, [this, &form](const void *address) { owners.try_emplace(address, &form); });
+    });
+}
+
+void FormTracker::track(Form &form)
+{
+    auto old = std::move(nodes);
+    nodes = decltype(nodes)(old.get_allocator());
+    owners.clear();
+    // The collected addresses must not point into maps that a copy of the form still shares
+    form.unshare();
+    root = &form;
+    add(form, nullptr, Atom());
+    // Keep the revisions of forms that are still in the tree
+    for (auto &[address, node] : nodes)
+    {
+        auto iter = old.find(address);
+        if (iter != old.end())
+        {
+            node.revision = iter->second.revision;
+            node.changed = iter->second.changed;
+        }
+    }
+}
+
+void FormTracker::retrack()
+{
+    if (root != nullptr)
+    {
+        track(*root);
+    }
+}
+
+bool FormTracker::retrack(Form &form)
+{
+    auto iter = nodes.find(&form);
+    if (iter == nodes.end())
+    {
+        return false;
+    }
+    form.unshare();
+    add(form, iter->second.parent, iter->second.key);
+    return true;
+}
+
+void FormTracker::untrack(const Form &top)
+{
+    if (nodes.find(&top) == nodes.end())
+    {
+        return;
+    }
+    walker.walk(top, [this, &top](const FormWalker::Step &step) {
+        const Form &form = *step.form;
+        forEachPart(form, [this](const void *address) { owners.erase(address); });
+        if (&form != &top)
+        {
+            owners.erase(&form);
+            nodes.erase(&form);
+            if (step.enabled != nullptr)
+            {
+                owners.erase(step.enabled);
+            }
+        }
+    });
+    owners[&top] = &top;
+}
+
+Form *selectAlternative(FormTracker *tracker, VariantForm &variant, const Atom &key)
+{
+    if (tracker == nullptr)
+    {
+        return variant.select(key);
+    }
+    const Atom previous(variant.selected);
+    const bool changed = previous != key;
+    const bool built = variant.isBuilt(key);
+    if (changed)
+    {
+        tracker->prepare(&variant);
+    }
+    // select() drops the previous alternative if it is lazy and the key is there
+    const auto &alternatives = *std::as_const(variant);
+    if (changed && variant.dropUnselected && variant.isLazy(previous) && alternatives.find(key) != alternatives.end())
+    {
+        auto iter = alternatives.find(previous);
+        if (iter != alternatives.end())
+        {
+            tracker->untrack(iter->second);
+        }
+    }
+    Form *form = variant.select(key);
+    if (!built && form != nullptr)
+    {
+        tracker->retrack(*form);
+    }
+    if (changed)
+    {
+        tracker->touch(&variant);
+    }
+    return form;
+}
+
+FormHash FormTracker::hash() const
+{
+    return root == nullptr ? 0 : hashCached(*root);
+}
+
+bool FormTracker::touch(const void *address)
+{
+    auto owner = owners.find(address);
+    if (owner == owners.end())
+    {
+        return false;
+    }
+    const Form *form = owner->second;
+    auto iter = nodes.find(form);
+    if (iter == nodes.end())
+    {
+        return false;
+    }
+    ++counter;
+    iter->second.changed = counter;
+    for (auto node = iter; node != nodes.end(); node = nodes.find(node->second.parent))
+    {
+        node->second.revision = counter;
+        node->first->invalidate();
+        if (node->second.parent == nullptr)
+        {
+            break;
+        }
+    }
+    if (!listeners.empty())
+    {
+        const FormPath path = pathOf(*form);
+        for (const auto &[_, listener] : listeners)
+        {
+            listener(path, *form);
+        }
+    }
+    return true;
+}
+
+bool FormTracker::prepare(const void *address)
+{
+    auto owner = owners.find(address);
+    if (owner == owners.end())
+    {
+        return false;
+    }
+    if (!preparers.empty())
+    {
+        const Form *form = owner->second;
+        const FormPath path = pathOf(*form);
+        for (const auto &[_, preparer] : preparers)
+        {
+            preparer(path, *form);
+        }
+    }
+    return true;
+}
+
+Revision FormTracker::revision(const Form &form) const noexcept
+{
+    auto iter = nodes.find(&form);
+    return iter == nodes.end() ? 0 : iter->second.revision;
+}
+
+FormPath FormTracker::pathOf(const Form &form) const
+{
+    FormPath path(nodes.get_allocator());
+    for (auto iter = nodes.find(&form); iter != nodes.end() && iter->second.parent != nullptr;
+         iter = nodes.find(iter->second.parent))
+    {
+        path.push_back(iter->second.key);
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+size_t FormTracker::subscribe(Listener listener)
+{
+    const size_t id = nextListener++;
+    listeners.emplace_back(id, std::move(listener));
+    return id;
+}
+
+size_t FormTracker::subscribeBefore(Listener listener)
+{
+    const size_t id = nextListener++;
+    preparers.emplace_back(id, std::move(listener));
+    return id;
+}
+
+void FormTracker::unsubscribe(size_t id)
+{
+    for (auto list : {&listeners, &preparers})
+    {
+        list->erase(std::remove_if(list->begin(), list->end(), [id](const auto &pair) { return pair.first == id; }),
+                    list->end());
+    }
+}
+
+FormTracker &FormExecute::track()
+{
+    if (tracker == nullptr)
+    {
+        tracker = std::make_shared<FormTracker>();
+    }
+    // Computed targets may change before their addresses are collected
+    if (computed != nullptr)
+    {
+        computed->update(form);
+    }
+    tracker->track(form);
+    if (transaction != nullptr)
+    {
+        transaction->begin(*tracker);
+    }
+    return *tracker;
+}
+
+void FormExecute::setTransactional(bool on)
+{
+    if (!on)
+    {
+        transaction = nullptr;
+    }
+    else if (transaction == nullptr)
+    {
+        transaction = std::make_shared<FormTransaction>();
+    }
+}
+
+void FormExecute::commit()
+{
+    if (transaction != nullptr)
+    {
+        transaction->commit();
+    }
+}
+
+void FormExecute::rollback()
+{
+    if (transaction == nullptr || !transaction->active())
+    {
+        return;
+    }
+    transaction->rollback();
+    // Computed targets were not recorded; they follow the restored values
+    if (computed != nullptr)
+    {
+        computed->invalidate();
+        computed->update(form, tracker.get());
+    }
+    // The undone edits no longer match the form
+    if (journal != nullptr)
+    {
+        journal->clear();
+    }
+}
+} // namespace CanForm
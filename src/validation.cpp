@@ -0,0 +1,448 @@
+#include <validation.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <regex>
+#include <system_error>
+#include <thread>
+
+namespace CanForm
+{
+ValidationEngine::ValidationEngine(size_t t, const allocator_type &a)
+    : paths(a), types(), threads(t == 0 ? std::max<size_t>(1, std::thread::hardware_concurrency()) : t),
+      pool(std::make_unique<Pool>(*this))
+{
+    for (auto &checks : types)
+    {
+        checks = std::pmr::vector<Check>(a);
+    }
+}
+
+void ValidationEngine::add(std::string_view path, Check check)
+{
+    add(toPath(path), std::move(check));
+}
+
+void ValidationEngine::add(const FormPath &path, Check check)
+{
+    size_t hash = 0;
+    for (const Atom &key : path)
+    {
+        hash = pathHash(hash, key);
+    }
+    paths.emplace(hash, PathCheck{path, std::move(check)});
+}
+
+bool ValidationEngine::empty() const noexcept
+{
+    return paths.empty() && std::all_of(types.begin(), types.end(), [](const auto &v) { return v.empty(); });
+}
+
+struct ValidationTask
+{
+    const Form *form;
+    FormPath path;
+    size_t hash;
+};
+
+// A deque of tasks per thread. The owner takes the newest task from the back so it stays in the subtree it was
+// walking; thieves take the oldest from the front, which are the largest remaining subtrees.
+class ValidationEngine::Worker
+{
+  private:
+    const ValidationEngine &engine;
+    Pool &pool;
+    std::mutex mutex;
+    std::pmr::deque<ValidationTask> tasks;
+
+    void check(const Form &form, const FormPath &path, size_t hash)
+    {
+        auto report = [&](const Check &c) {
+            if (auto message = c(form))
+            {
+                const Allocator allocator = errors->get_allocator();
+                errors->push_back(
+                    ValidationError{FormPath(path, allocator), &form, String(std::move(*message), allocator)});
+            }
+        };
+        for (const Check &c : engine.types[form->index()])
+        {
+            report(c);
+        }
+        if (engine.paths.empty())
+        {
+            return;
+        }
+        auto [begin, end] = engine.paths.equal_range(hash);
+        for (auto iter = begin; iter != end; ++iter)
+        {
+            if (iter->second.path == path)
+            {
+                report(iter->second.check);
+            }
+        }
+    }
+
+  public:
+    // With the allocator of the validation that is running, if one is
+    std::optional<ValidationErrors> errors;
+
+    Worker(const ValidationEngine &e, Pool &p)
+        : engine(e), pool(p), mutex(), tasks(e.get_allocator()), errors()
+    {
+    }
+
+    // Checks the form and its fields. Fields that have fields of their own become new tasks.
+    void run(ValidationTask &task)
+    {
+        FormPath &path = task.path;
+        check(*task.form, path, task.hash);
+        auto child = [&](const Atom &key, const Form &form) {
+            const size_t hash = pathHash(task.hash, key);
+            path.push_back(key);
+            if (form.holds<StructForm>() || form.holds<VariantForm>() || form.holds<EnableForm>())
+            {
+                push(ValidationTask{&form, FormPath(path, engine.get_allocator()), hash});
+            }
+            else
+            {
+                check(form, path, hash);
+            }
+            path.pop_back();
+        };
+        visit(
+            [&](const auto &value) {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same_v<T, StructForm>)
+                {
+                    for (const auto &[key, form] : *value)
+                    {
+                        child(key, form);
+                    }
+                }
+                else if constexpr (std::is_same_v<T, VariantForm>)
+                {
+                    auto iter = value->find(value.selected);
+                    if (iter != value->end())
+                    {
+                        child(iter->first, iter->second);
+                    }
+                }
+                else if constexpr (std::is_same_v<T, EnableForm>)
+                {
+                    for (const auto &[key, pair] : *value)
+                    {
+                        if (pair.first)
+                        {
+                            child(key, pair.second);
+                        }
+                    }
+                }
+            },
+            *task.form);
+    }
+
+    void push(ValidationTask &&task);
+    std::optional<ValidationTask> pop();
+    std::optional<ValidationTask> steal();
+};
+
+// The workers and the threads that run them. The calling thread of a validation runs the first worker.
+class ValidationEngine::Pool
+{
+  private:
+    std::vector<std::thread> threads;
+    // Guards generation, running and stopping, and is held to wait on the condition variables
+    std::mutex mutex;
+    // Signalled when a validation starts and when the engine is destroyed
+    std::condition_variable started;
+    // Signalled when a task is pushed while workers wait, and when the last task is finished
+    std::condition_variable available;
+    // Signalled when the last thread of the pool left a validation
+    std::condition_variable finished;
+    size_t generation;
+    size_t running;
+    bool stopping;
+
+    void loop(size_t index)
+    {
+        size_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            started.wait(lock, [&]() { return stopping || generation != seen; });
+            if (stopping)
+            {
+                return;
+            }
+            seen = generation;
+            lock.unlock();
+            work(index);
+            lock.lock();
+            if (--running == 0)
+            {
+                finished.notify_one();
+            }
+        }
+    }
+
+  public:
+    std::vector<std::unique_ptr<Worker>> workers;
+    // Tasks pushed and not finished. A task is only finished after the tasks it pushed were counted, so this cannot
+    // reach zero while work remains.
+    std::atomic<size_t> pending;
+    // Tasks in the deques that no worker took yet
+    std::atomic<size_t> queued;
+    // Workers waiting for a task
+    std::atomic<size_t> idle;
+    // One validation at a time
+    std::mutex validating;
+
+    explicit Pool(const ValidationEngine &engine)
+        : threads(), mutex(), started(), available(), finished(), generation(0), running(0), stopping(false),
+          workers(), pending(0), queued(0), idle(0), validating()
+    {
+        workers.reserve(engine.threads);
+        for (size_t i = 0; i < engine.threads; ++i)
+        {
+            workers.push_back(std::make_unique<Worker>(engine, *this));
+        }
+    }
+    Pool(const Pool &) = delete;
+    ~Pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        started.notify_all();
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    Pool &operator=(const Pool &) = delete;
+
+    // Called with the first task pushed. Runs the first worker on the calling thread and returns once no thread of
+    // the pool is in the validation any more.
+    void run()
+    {
+        if (threads.empty())
+        {
+            for (size_t i = 1; i < workers.size(); ++i)
+            {
+                try
+                {
+                    threads.emplace_back(&Pool::loop, this, i);
+                }
+                catch (const std::system_error &)
+                {
+                    // Without thread support the calling thread does the work
+                    break;
+                }
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++generation;
+            running = threads.size();
+        }
+        started.notify_all();
+        work(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this]() { return running == 0; });
+    }
+
+    // Runs tasks until every worker is out of them and sleeps while there is nothing to take
+    void work(size_t index)
+    {
+        Worker &self = *workers[index];
+        while (true)
+        {
+            std::optional<ValidationTask> task = self.pop();
+            for (size_t i = 1; !task && i < workers.size(); ++i)
+            {
+                task = workers[(index + i) % workers.size()]->steal();
+            }
+            if (task)
+            {
+                self.run(*task);
+                if (pending.fetch_sub(1) == 1)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    available.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            // Counted before queued is read, and push() counts queued before reading this, so one of them sees the
+            // other and a pushed task cannot be missed
+            idle.fetch_add(1);
+            available.wait(lock, [this]() { return queued.load() != 0 || pending.load() == 0; });
+            idle.fetch_sub(1);
+            if (pending.load() == 0)
+            {
+                return;
+            }
+        }
+    }
+
+    void notify()
+    {
+        if (idle.load() != 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            available.notify_one();
+        }
+    }
+};
+
+void ValidationEngine::Worker::push(ValidationTask &&task)
+{
+    pool.pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    pool.queued.fetch_add(1);
+    pool.notify();
+}
+
+std::optional<ValidationTask> ValidationEngine::Worker::pop()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tasks.empty())
+    {
+        return std::nullopt;
+    }
+    ValidationTask task = std::move(tasks.back());
+    tasks.pop_back();
+    pool.queued.fetch_sub(1);
+    return task;
+}
+
+std::optional<ValidationTask> ValidationEngine::Worker::steal()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tasks.empty())
+    {
+        return std::nullopt;
+    }
+    ValidationTask task = std::move(tasks.front());
+    tasks.pop_front();
+    pool.queued.fetch_sub(1);
+    return task;
+}
+
+ValidationEngine::~ValidationEngine() = default;
+
+ValidationErrors ValidationEngine::validate(const Form &form) const
+{
+    return validate(form, get_allocator());
+}
+
+ValidationErrors ValidationEngine::validate(const Form &form, const Allocator &allocator) const
+{
+    ValidationErrors errors(allocator);
+    if (empty())
+    {
+        return errors;
+    }
+
+    std::lock_guard<std::mutex> lock(pool->validating);
+    for (auto &worker : pool->workers)
+    {
+        worker->errors.emplace(allocator);
+    }
+    pool->workers.front()->push(ValidationTask{&form, FormPath(get_allocator()), 0});
+    pool->run();
+
+    for (auto &worker : pool->workers)
+    {
+        std::move(worker->errors->begin(), worker->errors->end(), std::back_inserter(errors));
+        worker->errors.reset();
+    }
+    std::stable_sort(errors.begin(), errors.end(), [](const ValidationError &a, const ValidationError &b) {
+        return std::lexicographical_compare(a.path.begin(), a.path.end(), b.path.begin(), b.path.end(),
+                                            [](const Atom &x, const Atom &y) { return x.view() < y.view(); });
+    });
+    return errors;
+}
+
+ValidationEngine::Check ValidationEngine::matches(std::string_view pattern, std::string_view message)
+{
+    return [regex = std::regex(pattern.begin(), pattern.end()),
+            message = String(message)](const Form &form) -> std::optional<String> {
+        const String *s = form.getIf<String>();
+        if (auto c = form.getIf<ComplexString>())
+        {
+            s = &c->string;
+        }
+        if (s == nullptr || std::regex_match(s->begin(), s->end(), regex))
+        {
+            return std::nullopt;
+        }
+        return message;
+    };
+}
+
+ValidationEngine::Check ValidationEngine::notEmpty(std::string_view message)
+{
+    return [message = String(message)](const Form &form) -> std::optional<String> {
+        const bool empty = visit(
+            [](const auto &value) {
+                using T = std::decay_t<decltype(value)>;
+                if constexpr (std::is_same_v<T, String> || std::is_same_v<T, StringSet>)
+                {
+                    return value.empty();
+                }
+                else if constexpr (std::is_same_v<T, ComplexString>)
+                {
+                    return value.string.empty();
+                }
+                else
+                {
+                    return false;
+                }
+            },
+            form);
+        if (!empty)
+        {
+            return std::nullopt;
+        }
+        return message;
+    };
+}
+
+ValidationEngine::Check ValidationEngine::between(double min, double max, std::string_view message)
+{
+    return [min, max, message = String(message)](const Form &form) -> std::optional<String> {
+        const RangedValue *value = form.getIf<RangedValue>();
+        if (value == nullptr)
+        {
+            return std::nullopt;
+        }
+        const double d = std::visit([](const auto &range) { return static_cast<double>(*range); }, *value);
+        if (min <= d && d <= max)
+        {
+            return std::nullopt;
+        }
+        return message;
+    };
+}
+
+ValidationErrors FormExecute::validate() const
+{
+    if (validation == nullptr)
+    {
+        return ValidationErrors();
+    }
+    return validation->validate(form);
+}
+} // namespace CanForm